@@ -136,6 +136,7 @@ set(include_files_list
     langinfo.h
     libio.h
     linux/falloc.h
+    linux/io_uring.h
     limits.h
     locale.h
     math.h
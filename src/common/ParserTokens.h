@@ -110,6 +110,7 @@ PARSER_TOKEN(TOK_BOOLEAN, "BOOLEAN", false)
 PARSER_TOKEN(TOK_BOTH, "BOTH", false)
 PARSER_TOKEN(TOK_BREAK, "BREAK", true)
 PARSER_TOKEN(TOK_BTRIM, "BTRIM", false)
+PARSER_TOKEN(TOK_BUFFERS, "BUFFERS", true)
 PARSER_TOKEN(TOK_BY, "BY", false)
 PARSER_TOKEN(TOK_CALL, "CALL", false)
 PARSER_TOKEN(TOK_CALLER, "CALLER", true)
@@ -134,7 +135,9 @@ PARSER_TOKEN(TOK_COMMENT, "COMMENT", false)
 PARSER_TOKEN(TOK_COMMIT, "COMMIT", false)
 PARSER_TOKEN(TOK_COMMITTED, "COMMITTED", true)
 PARSER_TOKEN(TOK_COMMON, "COMMON", true)
+PARSER_TOKEN(TOK_COMPACT, "COMPACT", true)
 PARSER_TOKEN(TOK_COMPARE_DECFLOAT, "COMPARE_DECFLOAT", true)
+PARSER_TOKEN(TOK_COMPRESSION, "COMPRESSION", true)
 PARSER_TOKEN(TOK_COMPUTED, "COMPUTED", true)
 PARSER_TOKEN(TOK_CONDITIONAL, "CONDITIONAL", true)
 PARSER_TOKEN(TOK_CONNECT, "CONNECT", false)
@@ -354,6 +357,7 @@ PARSER_TOKEN(TOK_OF, "OF", false)
 PARSER_TOKEN(TOK_OFFSET, "OFFSET", false)
 PARSER_TOKEN(TOK_OLDEST, "OLDEST", true)
 PARSER_TOKEN(TOK_ON, "ON", false)
+PARSER_TOKEN(TOK_ONLINE, "ONLINE", true)
 PARSER_TOKEN(TOK_ONLY, "ONLY", false)
 PARSER_TOKEN(TOK_OPEN, "OPEN", false)
 PARSER_TOKEN(TOK_OPTIMIZE, "OPTIMIZE", true)
@@ -374,6 +378,7 @@ PARSER_TOKEN(TOK_PAD, "PAD", true)
 PARSER_TOKEN(TOK_PAGE, "PAGE", true)
 PARSER_TOKEN(TOK_PAGES, "PAGES", true)
 PARSER_TOKEN(TOK_PAGE_SIZE, "PAGE_SIZE", true)
+PARSER_TOKEN(TOK_PARALLEL, "PARALLEL", true)
 PARSER_TOKEN(TOK_PARAMETER, "PARAMETER", false)
 PARSER_TOKEN(TOK_PARTITION, "PARTITION", true)
 PARSER_TOKEN(TOK_PASSWORD, "PASSWORD", true)
@@ -137,6 +137,12 @@ const char*	GCPolicyCooperative	= "cooperative";
 const char*	GCPolicyBackground	= "background";
 const char*	GCPolicyCombined	= "combined";
 
+const char*	IOEngineSync		= "sync";
+const char*	IOEngineIoUring		= "io_uring";
+
+const char*	PageCachePolicyLRU	= "lru";
+const char*	PageCachePolicy2Q	= "2q";
+
 ConfigValue Config::defaults[MAX_CONFIG_KEY];
 
 /******************************************************************************
@@ -379,6 +385,28 @@ void Config::checkValues()
 		}
 	}
 
+	strVal = values[KEY_IO_ENGINE].strVal;
+	if (strVal)
+	{
+		NoCaseString ioEngine(strVal);
+		if (ioEngine != IOEngineSync && ioEngine != IOEngineIoUring)
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_IO_ENGINE] = defaults[KEY_IO_ENGINE];
+		}
+	}
+
+	strVal = values[KEY_PAGE_CACHE_POLICY].strVal;
+	if (strVal)
+	{
+		NoCaseString cachePolicy(strVal);
+		if (cachePolicy != PageCachePolicyLRU && cachePolicy != PageCachePolicy2Q)
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_PAGE_CACHE_POLICY] = defaults[KEY_PAGE_CACHE_POLICY];
+		}
+	}
+
 	strVal = values[KEY_WIRE_CRYPT].strVal;
 	if (strVal)
 	{
@@ -417,6 +445,9 @@ void Config::checkValues()
 
 	checkIntForLoBound(KEY_INLINE_SORT_THRESHOLD, 0, true);
 
+	checkIntForLoBound(KEY_SMALL_BLOB_THRESHOLD, 0, true);
+	checkIntForHiBound(KEY_SMALL_BLOB_THRESHOLD, MAX_USHORT, true);
+
 	checkIntForLoBound(KEY_MAX_STATEMENT_CACHE_SIZE, 0, true);
 
 	checkIntForLoBound(KEY_MAX_PARALLEL_WORKERS, 1, true);
@@ -424,6 +455,9 @@ void Config::checkValues()
 
 	checkIntForLoBound(KEY_PARALLEL_WORKERS, 1, true);
 	checkIntForHiBound(KEY_PARALLEL_WORKERS, values[KEY_MAX_PARALLEL_WORKERS].intVal, false);
+
+	checkIntForLoBound(KEY_GC_PARALLEL_WORKERS, 1, true);
+	checkIntForHiBound(KEY_GC_PARALLEL_WORKERS, values[KEY_MAX_PARALLEL_WORKERS].intVal, false);
 }
 
 
@@ -78,6 +78,12 @@ extern const char*	GCPolicyCooperative;
 extern const char*	GCPolicyBackground;
 extern const char*	GCPolicyCombined;
 
+extern const char*	IOEngineSync;
+extern const char*	IOEngineIoUring;
+
+extern const char*	PageCachePolicyLRU;
+extern const char*	PageCachePolicy2Q;
+
 inline constexpr int WIRE_CRYPT_DISABLED = 0;
 inline constexpr int WIRE_CRYPT_ENABLED = 1;
 inline constexpr int WIRE_CRYPT_REQUIRED = 2;
@@ -187,6 +193,10 @@ enum ConfigKey
 	KEY_MAX_PARALLEL_WORKERS,
 	KEY_OPTIMIZE_FOR_FIRST_ROWS,
 	KEY_ALLOW_UPDATE_OVERWRITE,
+	KEY_IO_ENGINE,
+	KEY_PAGE_CACHE_POLICY,
+	KEY_SMALL_BLOB_THRESHOLD,
+	KEY_GC_PARALLEL_WORKERS,
 	MAX_CONFIG_KEY		// keep it last
 };
 
@@ -300,7 +310,11 @@ inline constexpr ConfigEntry entries[MAX_CONFIG_KEY] =
 	{TYPE_INTEGER,	"ParallelWorkers",			true,	1},
 	{TYPE_INTEGER,	"MaxParallelWorkers",		true,	1},
 	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false},
-	{TYPE_BOOLEAN,	"AllowUpdateOverwrite",		false,	true}
+	{TYPE_BOOLEAN,	"AllowUpdateOverwrite",		false,	true},
+	{TYPE_STRING,	"IOEngine",					false,	"sync"},	// page I/O engine
+	{TYPE_STRING,	"PageCachePolicy",			false,	"lru"},		// page cache replacement policy
+	{TYPE_INTEGER,	"SmallBlobThreshold",		false,	0},			// bytes
+	{TYPE_INTEGER,	"GCParallelWorkers",		false,	1}
 };
 
 
@@ -623,6 +637,18 @@ public:
 	CONFIG_GET_PER_DB_BOOL(getOptimizeForFirstRows, KEY_OPTIMIZE_FOR_FIRST_ROWS);
 
 	CONFIG_GET_PER_DB_BOOL(getAllowUpdateOverwrite, KEY_ALLOW_UPDATE_OVERWRITE);
+
+	// Page I/O engine
+	CONFIG_GET_PER_DB_STR(getIOEngine, KEY_IO_ENGINE);
+
+	// Page cache replacement policy
+	CONFIG_GET_PER_DB_STR(getPageCachePolicy, KEY_PAGE_CACHE_POLICY);
+
+	// Max length of the blob stored on the data page of its record
+	CONFIG_GET_PER_DB_KEY(ULONG, getSmallBlobThreshold, KEY_SMALL_BLOB_THRESHOLD, getInt);
+
+	// Number of workers of the background garbage collector
+	CONFIG_GET_PER_DB_INT(getGCParallelWorkers, KEY_GC_PARALLEL_WORKERS);
 };
 
 // Implementation of interface to access master configuration file
@@ -112,7 +112,7 @@ public:
 
 	unsigned getCapabilities() const override
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_RELOCATABLE_STATE;
 	}
 
 	void parseArgs(thread_db* tdbb, CompilerScratch* csb, unsigned count) override;
@@ -144,7 +144,7 @@ public:
 
 	unsigned getCapabilities() const override
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_RELOCATABLE_STATE;
 	}
 
 	Firebird::string internalPrint(NodePrinter& printer) const override;
@@ -157,6 +157,12 @@ public:
 	void aggPass(thread_db* tdbb, Request* request, dsc* desc) const override;
 	dsc* aggExecute(thread_db* tdbb, Request* request) const override;
 
+	void getStateOffsets(Firebird::Array<ULONG>& offsets) const override
+	{
+		AggNode::getStateOffsets(offsets);
+		offsets.add(tempImpure);
+	}
+
 protected:
 	AggNode* dsqlCopy(DsqlCompilerScratch* dsqlScratch) /*const*/ override;
 
@@ -357,7 +363,7 @@ public:
 
 	unsigned getCapabilities() const override
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_RELOCATABLE_STATE;
 	}
 
 	Firebird::string internalPrint(NodePrinter& printer) const override;
@@ -388,7 +394,7 @@ public:
 
 	unsigned getCapabilities() const override
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_RELOCATABLE_STATE;
 	}
 
 	Firebird::string internalPrint(NodePrinter& printer) const override;
@@ -419,7 +425,7 @@ public:
 
 	unsigned getCapabilities() const override
 	{
-		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS;
+		return CAP_RESPECTS_WINDOW_FRAME | CAP_WANTS_AGG_CALLS | CAP_RELOCATABLE_STATE;
 	}
 
 	Firebird::string internalPrint(NodePrinter& printer) const override;
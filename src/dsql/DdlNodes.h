@@ -1459,6 +1459,7 @@ public:
 			TYPE_DROP_CONSTRAINT,
 			TYPE_ALTER_SQL_SECURITY,
 			TYPE_ALTER_PUBLICATION,
+			TYPE_ALTER_COMPRESSION,
 			TYPE_ADD_PACKAGED_TABLE_INDEX
 		};
 
@@ -1752,6 +1753,7 @@ public:
 	std::optional<ULONG> tempRowsFlag;	// REL_temp_tran, REL_temp_conn
 	Firebird::TriState ssDefiner;
 	Firebird::TriState replicationState;
+	Firebird::TriState compressionState;
 	ModifyIndexList indexList;
 };
 
@@ -2189,6 +2191,40 @@ protected:
 		statusVector << Firebird::Arg::Gds(isc_dsql_alter_index_failed) << indexName.toQuotedString();
 	}
 
+public:
+	QualifiedName indexName;
+	SLONG parallelWorkers = 0;	// attachment default when zero
+};
+
+
+class CompactIndexNode final : public DdlNode
+{
+public:
+	CompactIndexNode(MemoryPool& p, const QualifiedName& aName)
+		: DdlNode(p),
+		  indexName(p, aName)
+	{
+	}
+
+public:
+	Firebird::string internalPrint(NodePrinter& printer) const override;
+	void checkPermission(thread_db* tdbb) override;
+	void execute(thread_db* tdbb, DsqlCompilerScratch* dsqlScratch, jrd_tra* transaction) override;
+
+	DdlNode* dsqlPass(DsqlCompilerScratch* dsqlScratch) override
+	{
+		dsqlScratch->qualifyExistingName(indexName, obj_index);
+		dsqlScratch->ddlSchema = indexName.schema;
+
+		return DdlNode::dsqlPass(dsqlScratch);
+	}
+
+protected:
+	void putErrorPrefix(Firebird::Arg::StatusVector& statusVector) override
+	{
+		statusVector << Firebird::Arg::Gds(isc_dsql_alter_index_failed) << indexName.toQuotedString();
+	}
+
 public:
 	QualifiedName indexName;
 };
@@ -2924,6 +2960,8 @@ private:
 public:
 	bool create = false;	// Is the node created with a CREATE DATABASE command?
 	SLONG linger = -1;
+	SLONG pageBuffers = -1;
+	bool pageBuffersOnline = false;
 	unsigned clauses = 0;
 	Firebird::string differenceFile;
 	QualifiedName setDefaultCharSet;
@@ -10570,6 +10570,10 @@ ValueExprNode* RecordKeyNode::pass2(thread_db* tdbb, CompilerScratch* csb)
 {
 	ValueExprNode::pass2(tdbb, csb);
 
+	// Record version is not available without reading the record itself
+	if (blrOp != blr_dbkey)
+		csb->csb_rpt[recStream].csb_flags |= csb_record_version;
+
 	dsc desc;
 	getDesc(tdbb, csb, &desc);
 	impureOffset = csb->allocImpure<impure_value>();
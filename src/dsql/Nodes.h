@@ -1006,6 +1006,8 @@ public:
 	static constexpr unsigned CAP_WANTS_AGG_CALLS		= 0x04;
 	// wants winPass call in a window
 	static constexpr unsigned CAP_WANTS_WIN_PASS_CALL	= 0x08;
+	// state may be saved and restored between passes (used by hash aggregation)
+	static constexpr unsigned CAP_RELOCATABLE_STATE		= 0x10;
 
 protected:
 	struct AggInfo
@@ -1171,6 +1173,12 @@ public:
 	virtual void aggPass(thread_db* tdbb, Request* request, dsc* desc) const = 0;
 	virtual dsc* aggExecute(thread_db* tdbb, Request* request) const = 0;
 
+	// Impure offsets of the aggregate state, every one holds an impure_value_ex.
+	virtual void getStateOffsets(Firebird::Array<ULONG>& offsets) const
+	{
+		offsets.add(impureOffset);
+	}
+
 	AggNode* dsqlPass(DsqlCompilerScratch* dsqlScratch) override;
 
 protected:
@@ -708,6 +708,7 @@ using namespace Firebird;
 %token <metaNamePtr> BIN_OR_AGG
 %token <metaNamePtr> BIN_XOR_AGG
 %token <metaNamePtr> BTRIM
+%token <metaNamePtr> BUFFERS
 %token <metaNamePtr> CALL
 %token <metaNamePtr> CURRENT_SCHEMA
 %token <metaNamePtr> DOWNTO
@@ -721,6 +722,10 @@ using namespace Firebird;
 %token <metaNamePtr> LISTAGG
 %token <metaNamePtr> LTRIM
 %token <metaNamePtr> NAMED_ARG_ASSIGN
+%token <metaNamePtr> ONLINE
+%token <metaNamePtr> PARALLEL
+%token <metaNamePtr> COMPACT
+%token <metaNamePtr> COMPRESSION
 %token <metaNamePtr> PERCENTILE_CONT
 %token <metaNamePtr> PERCENTILE_DISC
 %token <metaNamePtr> RTRIM
@@ -2487,6 +2492,8 @@ table_attribute($relationNode)
 		{ setClause($relationNode->ssDefiner, "SQL SECURITY", $1); }
 	| publication_state
 		{ setClause($relationNode->replicationState, "PUBLICATION", $1); }
+	| compression_state
+		{ setClause($relationNode->compressionState, "COMPRESSION", $1); }
 	;
 
 %type <boolVal> sql_security_clause
@@ -2501,6 +2508,12 @@ publication_state
 	| DISABLE PUBLICATION		{ $$ = false; }
 	;
 
+%type <boolVal> compression_state
+compression_state
+	: ENABLE COMPRESSION		{ $$ = true; }
+	| DISABLE COMPRESSION		{ $$ = false; }
+	;
+
 %type <createRelationNode> gtt_table_clause
 gtt_table_clause
 	: simple_table_name
@@ -5006,6 +5019,20 @@ alter_op($relationNode)
 				newNode<RelationNode::Clause>(RelationNode::Clause::TYPE_ALTER_PUBLICATION);
 			$relationNode->clauses.add(clause);
 		}
+	| ENABLE COMPRESSION
+		{
+			setClause($relationNode->compressionState, "COMPRESSION", true);
+			RelationNode::Clause* clause =
+				newNode<RelationNode::Clause>(RelationNode::Clause::TYPE_ALTER_COMPRESSION);
+			$relationNode->clauses.add(clause);
+		}
+	| DISABLE COMPRESSION
+		{
+			setClause($relationNode->compressionState, "COMPRESSION", false);
+			RelationNode::Clause* clause =
+				newNode<RelationNode::Clause>(RelationNode::Clause::TYPE_ALTER_COMPRESSION);
+			$relationNode->clauses.add(clause);
+		}
 	;
 
 %type <metaNamePtr> alter_column_name
@@ -5190,6 +5217,10 @@ alter_index_clause
 		{
 			$$ = newNode<AlterIndexNode>(*$1, $2);
 		}
+	| symbol_index_name COMPACT
+		{
+			$$ = newNode<CompactIndexNode>(*$1);
+		}
 	;
 
 %type <boolVal> index_active
@@ -5284,6 +5315,11 @@ db_alter_clause($alterDatabaseNode)
 		{ $alterDatabaseNode->linger = $4; }
 	| DROP LINGER
 		{ $alterDatabaseNode->linger = 0; }
+	| SET PAGE BUFFERS TO long_integer page_buffers_online_opt
+		{
+			$alterDatabaseNode->pageBuffers = $5;
+			$alterDatabaseNode->pageBuffersOnline = $6;
+		}
 	| SET DEFAULT sql_security_clause
 		{ $alterDatabaseNode->ssDefiner = $3; }
 	| ENABLE PUBLICATION
@@ -5296,6 +5332,12 @@ db_alter_clause($alterDatabaseNode)
 		{ $alterDatabaseNode->clauses |= AlterDatabaseNode::CLAUSE_PUB_EXCL_TABLE; }
 	;
 
+%type <boolVal> page_buffers_online_opt
+page_buffers_online_opt
+	: /* nothing */	{ $$ = false; }
+	| ONLINE		{ $$ = true; }
+	;
+
 %type crypt_key_clause(<alterDatabaseNode>)
 crypt_key_clause($alterDatabaseNode)
 	: // nothing
@@ -6568,8 +6610,18 @@ table_list
 
 %type <ddlNode>	set_statistics
 set_statistics
-	: SET STATISTICS INDEX symbol_index_name
-		{ $$ = newNode<SetStatisticsNode>(*$4); }
+	: SET STATISTICS INDEX symbol_index_name parallel_workers_opt
+		{
+			const auto node = newNode<SetStatisticsNode>(*$4);
+			node->parallelWorkers = $5;
+			$$ = node;
+		}
+	;
+
+%type <int32Val> parallel_workers_opt
+parallel_workers_opt
+	: /* nothing */				{ $$ = 0; }
+	| PARALLEL long_integer		{ $$ = $2; }
 	;
 
 %type <ddlNode> comment
@@ -10581,13 +10633,18 @@ non_reserved_word
 	| BIN_AND_AGG
 	| BIN_OR_AGG
 	| BIN_XOR_AGG
+	| BUFFERS
+	| COMPACT
+	| COMPRESSION
 	| CONSTANT
 	| DOWNTO
 	| ERROR
 	| FINISH
 	| FORMAT
 	| GENERATE_SERIES
+	| ONLINE
 	| OWNER
+	| PARALLEL
 	| SEARCH_PATH
 	| SCHEMA
 	| UNLIST
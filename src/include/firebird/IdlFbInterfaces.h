@@ -1098,7 +1098,7 @@ namespace Firebird
 		}
 	};
 
-#define FIREBIRD_IBLOB_VERSION 4u
+#define FIREBIRD_IBLOB_VERSION 5u
 
 	class IBlob : public IReferenceCounted
 	{
@@ -1113,6 +1113,7 @@ namespace Firebird
 			int (CLOOP_CARG *seek)(IBlob* self, IStatus* status, int mode, int offset) CLOOP_NOEXCEPT;
 			void (CLOOP_CARG *cancel)(IBlob* self, IStatus* status) CLOOP_NOEXCEPT;
 			void (CLOOP_CARG *close)(IBlob* self, IStatus* status) CLOOP_NOEXCEPT;
+			int (CLOOP_CARG *getData)(IBlob* self, IStatus* status, unsigned bufferLength, void* buffer, unsigned* dataLength) CLOOP_NOEXCEPT;
 		};
 
 	protected:
@@ -1207,6 +1208,20 @@ namespace Firebird
 			static_cast<VTable*>(this->cloopVTable)->close(this, status);
 			StatusType::checkException(status);
 		}
+
+		template <typename StatusType> int getData(StatusType* status, unsigned bufferLength, void* buffer, unsigned* dataLength)
+		{
+			if (cloopVTable->version < 5)
+			{
+				StatusType::setVersionError(status, "IBlob", cloopVTable->version, 5);
+				StatusType::checkException(status);
+				return IStatus::RESULT_ERROR;
+			}
+			StatusType::clearException(status);
+			int ret = static_cast<VTable*>(this->cloopVTable)->getData(this, status, bufferLength, buffer, dataLength);
+			StatusType::checkException(status);
+			return ret;
+		}
 	};
 
 #define FIREBIRD_ITRANSACTION_VERSION 4u
@@ -9793,6 +9808,7 @@ namespace Firebird
 					this->seek = &Name::cloopseekDispatcher;
 					this->cancel = &Name::cloopcancelDispatcher;
 					this->close = &Name::cloopcloseDispatcher;
+					this->getData = &Name::cloopgetDataDispatcher;
 				}
 			} vTable;
 
@@ -9913,6 +9929,21 @@ namespace Firebird
 			}
 		}
 
+		static int CLOOP_CARG cloopgetDataDispatcher(IBlob* self, IStatus* status, unsigned bufferLength, void* buffer, unsigned* dataLength) CLOOP_NOEXCEPT
+		{
+			StatusType status2(status);
+
+			try
+			{
+				return static_cast<Name*>(self)->Name::getData(&status2, bufferLength, buffer, dataLength);
+			}
+			catch (...)
+			{
+				StatusType::catchException(&status2);
+				return static_cast<int>(0);
+			}
+		}
+
 		static void CLOOP_CARG cloopaddRefDispatcher(IReferenceCounted* self) CLOOP_NOEXCEPT
 		{
 			try
@@ -9960,6 +9991,7 @@ namespace Firebird
 		virtual int seek(StatusType* status, int mode, int offset) = 0;
 		virtual void cancel(StatusType* status) = 0;
 		virtual void close(StatusType* status) = 0;
+		virtual int getData(StatusType* status, unsigned bufferLength, void* buffer, unsigned* dataLength) = 0;
 	};
 
 	template <typename Name, typename StatusType, typename Base>
@@ -291,6 +291,7 @@ type
 	IBlob_seekPtr = function(this: IBlob; status: IStatus; mode: Integer; offset: Integer): Integer; cdecl;
 	IBlob_cancelPtr = procedure(this: IBlob; status: IStatus); cdecl;
 	IBlob_closePtr = procedure(this: IBlob; status: IStatus); cdecl;
+	IBlob_getDataPtr = function(this: IBlob; status: IStatus; bufferLength: Cardinal; buffer: Pointer; dataLength: CardinalPtr): Integer; cdecl;
 	ITransaction_getInfoPtr = procedure(this: ITransaction; status: IStatus; itemsLength: Cardinal; items: BytePtr; bufferLength: Cardinal; buffer: BytePtr); cdecl;
 	ITransaction_preparePtr = procedure(this: ITransaction; status: IStatus; msgLength: Cardinal; message: BytePtr); cdecl;
 	ITransaction_deprecatedCommitPtr = procedure(this: ITransaction; status: IStatus); cdecl;
@@ -1295,10 +1296,11 @@ type
 		seek: IBlob_seekPtr;
 		cancel: IBlob_cancelPtr;
 		close: IBlob_closePtr;
+		getData: IBlob_getDataPtr;
 	end;
 
 	IBlob = class(IReferenceCounted)
-		const VERSION = 4;
+		const VERSION = 5;
 
 		procedure getInfo(status: IStatus; itemsLength: Cardinal; items: BytePtr; bufferLength: Cardinal; buffer: BytePtr);
 		function getSegment(status: IStatus; bufferLength: Cardinal; buffer: Pointer; segmentLength: CardinalPtr): Integer;
@@ -1308,6 +1310,7 @@ type
 		function seek(status: IStatus; mode: Integer; offset: Integer): Integer;
 		procedure cancel(status: IStatus);
 		procedure close(status: IStatus);
+		function getData(status: IStatus; bufferLength: Cardinal; buffer: Pointer; dataLength: CardinalPtr): Integer;
 	end;
 
 	IBlobImpl = class(IBlob)
@@ -1323,6 +1326,7 @@ type
 		function seek(status: IStatus; mode: Integer; offset: Integer): Integer; virtual; abstract;
 		procedure cancel(status: IStatus); virtual; abstract;
 		procedure close(status: IStatus); virtual; abstract;
+		function getData(status: IStatus; bufferLength: Cardinal; buffer: Pointer; dataLength: CardinalPtr): Integer; virtual; abstract;
 	end;
 
 	TransactionVTable = class(ReferenceCountedVTable)
@@ -7041,6 +7045,18 @@ begin
 	FbException.checkException(status);
 end;
 
+function IBlob.getData(status: IStatus; bufferLength: Cardinal; buffer: Pointer; dataLength: CardinalPtr): Integer;
+begin
+	if (vTable.version < 5) then begin
+		FbException.setVersionError(status, 'IBlob', vTable.version, 5);
+		Result := IStatus.RESULT_ERROR;
+	end
+	else begin
+		Result := BlobVTable(vTable).getData(Self, status, bufferLength, buffer, dataLength);
+	end;
+	FbException.checkException(status);
+end;
+
 procedure ITransaction.getInfo(status: IStatus; itemsLength: Cardinal; items: BytePtr; bufferLength: Cardinal; buffer: BytePtr);
 begin
 	TransactionVTable(vTable).getInfo(Self, status, itemsLength, items, bufferLength, buffer);
@@ -11512,6 +11528,16 @@ begin
 	end
 end;
 
+function IBlobImpl_getDataDispatcher(this: IBlob; status: IStatus; bufferLength: Cardinal; buffer: Pointer; dataLength: CardinalPtr): Integer; cdecl;
+begin
+	Result := 0;
+	try
+		Result := IBlobImpl(this).getData(status, bufferLength, buffer, dataLength);
+	except
+		on e: Exception do FbException.catchException(status, e);
+	end
+end;
+
 var
 	IBlobImpl_vTable: BlobVTable;
 
@@ -18486,7 +18512,7 @@ initialization
 	IEventCallbackImpl_vTable.eventCallbackFunction := @IEventCallbackImpl_eventCallbackFunctionDispatcher;
 
 	IBlobImpl_vTable := BlobVTable.create;
-	IBlobImpl_vTable.version := 4;
+	IBlobImpl_vTable.version := 5;
 	IBlobImpl_vTable.addRef := @IBlobImpl_addRefDispatcher;
 	IBlobImpl_vTable.release := @IBlobImpl_releaseDispatcher;
 	IBlobImpl_vTable.getInfo := @IBlobImpl_getInfoDispatcher;
@@ -18497,6 +18523,7 @@ initialization
 	IBlobImpl_vTable.seek := @IBlobImpl_seekDispatcher;
 	IBlobImpl_vTable.cancel := @IBlobImpl_cancelDispatcher;
 	IBlobImpl_vTable.close := @IBlobImpl_closeDispatcher;
+	IBlobImpl_vTable.getData := @IBlobImpl_getDataDispatcher;
 
 	ITransactionImpl_vTable := TransactionVTable.create;
 	ITransactionImpl_vTable.version := 4;
@@ -27,9 +27,12 @@
 
 #include "../jrd/BulkInsert.h"
 #include "../jrd/sqz.h"
+#include "../jrd/sort.h"
 #include "../jrd/tra.h"
+#include "../jrd/btr_proto.h"
 #include "../jrd/cch_proto.h"
 #include "../jrd/dpm_proto.h"
+#include "../jrd/idx_proto.h"
 #include "../jrd/ods_proto.h"
 
 
@@ -51,7 +54,8 @@ constexpr unsigned RESERVE_SIZE = (ROUNDUP(RHDF_SIZE, ODS_ALIGNMENT) + sizeof(da
 
 BulkInsert::BulkInsert(MemoryPool& pool, thread_db* tdbb, jrd_rel* relation) :
 	PermanentStorage(pool),
-	m_request(tdbb->getRequest())
+	m_request(tdbb->getRequest()),
+	m_indices(pool)
 {
 	Database* dbb = tdbb->getDatabase();
 
@@ -62,14 +66,32 @@ BulkInsert::BulkInsert(MemoryPool& pool, thread_db* tdbb, jrd_rel* relation) :
 void BulkInsert::putRecord(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 {
 	m_primary->putRecord(tdbb, rpb, transaction);
+	putKeys(tdbb, rpb, transaction);
 }
 
 RecordNumber BulkInsert::putBlob(thread_db* tdbb, blb* blob, Record* record)
 {
+	// Figure out length of blob on page.  Remember that blob can either
+	// be a clump of data or a vector of page pointers.
+	USHORT length;
+	const UCHAR* q;
+	PageStack stack;
+	Array<UCHAR> buffer, packBuffer;
+
+	blob->storeToPage(&length, buffer, &q, &stack);
+
+	const bool blockPacked = m_primary->m_relation->rel_compressed &&
+		blob->packToPage(&length, packBuffer, &q);
+
+	// Small blob is stored next to its record, as DPM_store_blob does
+
+	if (blb::isSmall(blob->getLevel(), length, tdbb->getDatabase()->dbb_config->getSmallBlobThreshold()))
+		return m_primary->putBlob(tdbb, blob, length, q, stack, blockPacked, record);
+
 	if (!m_other)
 		m_other = FB_NEW_POOL(getPool()) Buffer(getPool(), m_primary->m_pageSize, 0, false, m_primary->m_relation);
 
-	return m_other->putBlob(tdbb, blob, record);
+	return m_other->putBlob(tdbb, blob, length, q, stack, blockPacked, record);
 }
 
 void BulkInsert::flush(thread_db* tdbb)
@@ -77,6 +99,153 @@ void BulkInsert::flush(thread_db* tdbb)
 	if (m_other)
 		m_other->flush(tdbb);
 	m_primary->flush(tdbb);
+
+	// Index keys could be inserted only when all the records are at the data pages,
+	// as uniqueness and foreign key checks may need to fetch them.
+
+	flushKeys(tdbb);
+}
+
+void BulkInsert::putKeys(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
+{
+	// Index keys are not inserted at once, but buffered in the per index sorts.
+	// At flush they are inserted in the key order, thus every index leaf page is
+	// visited once per batch of adjacent keys instead of once per record.
+
+	jrd_rel* const relation = getRelation();
+
+	if (!m_transaction)
+	{
+		m_transaction = transaction;
+
+		RelationPages* relPages = relation->getPages(tdbb);
+		WIN window(relPages->rel_pg_space_id, -1);
+
+		index_desc idx;
+		idx.idx_id = idx_invalid;
+
+		while (BTR_next_index(tdbb, relation->getPermanent(), transaction, &idx, &window))
+			m_indices.add().m_index = idx;
+
+		Database* dbb = tdbb->getDatabase();
+
+		for (auto& index : m_indices)
+		{
+			index.m_keyLength = ROUNDUP(BTR_key_length(tdbb, relation, &index.m_index), sizeof(SINT64));
+
+			sort_key_def keyDesc[2];
+			// Key sort description
+			keyDesc[0].setSkdLength(SKD_bytes, index.m_keyLength);
+			keyDesc[0].skd_flags = SKD_ascending;
+			keyDesc[0].setSkdOffset();
+			keyDesc[0].skd_vary_offset = 0;
+			// RecordNumber sort description
+			keyDesc[1].setSkdLength(SKD_int64, sizeof(RecordNumber));
+			keyDesc[1].skd_flags = SKD_ascending;
+			keyDesc[1].setSkdOffset(keyDesc);
+			keyDesc[1].skd_vary_offset = 0;
+
+			index.m_sort = FB_NEW_POOL(transaction->tra_sorts.getPool())
+				Sort(dbb, &transaction->tra_sorts, index.m_keyLength + sizeof(index_sort_record),
+					 2, 1, keyDesc, nullptr, nullptr);
+		}
+	}
+
+	Record* const record = rpb->rpb_record;
+
+	for (auto& index : m_indices)
+	{
+		index_desc* const idx = &index.m_index;
+		IndexErrorContext context(relation, idx);
+		idx_e errorCode = idx_e_ok;
+
+		{
+			IndexCondition condition(tdbb, idx);
+			const auto checkResult = condition.check(record, &errorCode);
+
+			if (errorCode)
+				context.raise(tdbb, errorCode, record);
+
+			fb_assert(checkResult.isAssigned());
+			if (!checkResult.asBool())
+				continue;
+		}
+
+		AutoIndexExpression expression;
+		IndexKey key(tdbb, relation, idx, expression);
+
+		if ( (errorCode = key.compose(record, true)) )
+		{
+			if (errorCode == idx_e_skip)
+				continue;
+
+			context.raise(tdbb, errorCode, record);
+		}
+
+		if (key->key_length > index.m_keyLength)
+			context.raise(tdbb, idx_e_keytoobig, record);
+
+		// Exact order of the keys doesn't matter for the correctness, thus the key is
+		// simply padded by zeroes, there is no need to distinguish NULLs from the
+		// empty values here.
+
+		UCHAR* p;
+		index.m_sort->put(tdbb, reinterpret_cast<ULONG**>(&p));
+
+		memcpy(p, key->key_data, key->key_length);
+		memset(p + key->key_length, 0, index.m_keyLength - key->key_length);
+
+		index_sort_record* isr = (index_sort_record*) (p + index.m_keyLength);
+		isr->isr_record_number = rpb->rpb_number.getValue();
+		isr->isr_key_length = key->key_length;
+		isr->isr_flags = packKeyNulls(key->key_nulls, idx->idx_count) |
+			((key->key_flags & key_empty) ? ISR_empty : 0);
+	}
+}
+
+void BulkInsert::flushKeys(thread_db* tdbb)
+{
+	jrd_rel* const relation = getRelation();
+
+	for (auto& index : m_indices)
+	{
+		if (!index.m_sort)
+			continue;
+
+		// Sort is detached before inserting the keys, so they are never applied twice
+		AutoPtr<Sort> sort(index.m_sort.release());
+
+		sort->sort(tdbb);
+
+		temporary_key key;
+
+		while (true)
+		{
+			UCHAR* p;
+			sort->get(tdbb, reinterpret_cast<ULONG**>(&p));
+
+			if (!p)
+				break;
+
+			const index_sort_record* isr = (index_sort_record*) (p + index.m_keyLength);
+
+			key.key_length = isr->isr_key_length;
+			memcpy(key.key_data, p, key.key_length);
+			key.key_flags = (isr->isr_flags & ISR_empty) ? key_empty : 0;
+			// Unique and foreign key checks need to know whether the key has no NULLs
+			// or NULLs only, particular NULL segments are not used by the key insertion
+			key.key_nulls = unpackKeyNulls(isr->isr_flags, index.m_index.idx_count);
+
+			RecordNumber number;
+			number.setValue(isr->isr_record_number);
+
+			IDX_store_key(tdbb, relation, m_transaction, &index.m_index, &key, number);
+
+			JRD_reschedule(tdbb);
+		}
+	}
+
+	m_indices.clear();
 }
 
 
@@ -100,6 +269,7 @@ void BulkInsert::Buffer::putRecord(thread_db* tdbb, record_param* rpb, jrd_tra*
 	rpb->rpb_flags = 0;
 	rpb->rpb_transaction_nr = transaction->tra_number;
 
+	const BlockPackedRecord blockPacked(tdbb, rpb);
 	Compressor dcc(getPool(), true, true, rpb->rpb_length, rpb->rpb_address);
 	const ULONG packed = dcc.getPackedLength();
 
@@ -147,21 +317,11 @@ void BulkInsert::Buffer::putRecord(thread_db* tdbb, record_param* rpb, jrd_tra*
 		memset(data + packed, 0, fill);
 }
 
-RecordNumber BulkInsert::Buffer::putBlob(thread_db* tdbb, blb* blob, Record* record)
+RecordNumber BulkInsert::Buffer::putBlob(thread_db* tdbb, blb* blob, USHORT length, const UCHAR* data,
+	PageStack& stack, bool blockPacked, Record* record)
 {
 	//fb_assert(blob->blb_relation == m_relation);
 
-	Database* dbb = tdbb->getDatabase();
-
-	// Figure out length of blob on page.  Remember that blob can either
-	// be a clump of data or a vector of page pointers.
-	USHORT length;
-	const UCHAR* q;
-	PageStack stack;
-	Array<UCHAR> buffer;
-
-	blob->storeToPage(&length, buffer, &q, &stack);
-
 	// Locate space to store blob
 
 	record_param rpb;
@@ -187,10 +347,13 @@ RecordNumber BulkInsert::Buffer::putBlob(thread_db* tdbb, blb* blob, Record* rec
 		markLarge();
 	}
 
+	if (blockPacked)
+		header->blh_flags |= rhd_block_packed;
+
 	blob->toPageHeader(header);
 
 	if (length)
-		memcpy(header->blh_page, q, length);
+		memcpy(header->blh_page, data, length);
 
 	if (record)
 	{
@@ -32,9 +32,11 @@
 #include "../common/classes/alloc.h"
 #include "../common/classes/array.h"
 #include "../jrd/jrd.h"
+#include "../jrd/btr.h"
 #include "../jrd/ods.h"
 #include "../jrd/pag.h"
 #include "../jrd/RecordNumber.h"
+#include "../jrd/sort.h"
 
 
 namespace Jrd
@@ -66,6 +68,26 @@ public:
 		return m_primary->m_relation;
 	}
 
+	// Index key is kept in the sort record with the NULL state that matters for
+	// its insertion only: there are no NULLs, some NULL segments or NULLs only.
+	static USHORT packKeyNulls(USHORT keyNulls, USHORT segments)
+	{
+		const USHORT allNulls = (1 << segments) - 1;
+
+		if (!keyNulls)
+			return 0;
+
+		return (keyNulls == allNulls) ? (ISR_null | ISR_null_segment) : ISR_null_segment;
+	}
+
+	static USHORT unpackKeyNulls(USHORT isrFlags, USHORT segments)
+	{
+		if (isrFlags & ISR_null)
+			return (1 << segments) - 1;
+
+		return (isrFlags & ISR_null_segment) ? 1 : 0;
+	}
+
 private:
 	struct Buffer : public Firebird::PermanentStorage
 	{
@@ -73,7 +95,8 @@ private:
 			jrd_rel* relation);
 
 		void putRecord(thread_db* tdbb, record_param* rpb, jrd_tra* transaction);
-		RecordNumber putBlob(thread_db* tdbb, blb* blob, Record* record);
+		RecordNumber putBlob(thread_db* tdbb, blb* blob, USHORT length, const UCHAR* data,
+			PageStack& stack, bool blockPacked, Record* record);
 		void flush(thread_db* tdbb);
 
 		// allocate and reserve data pages
@@ -96,10 +119,26 @@ private:
 		USHORT m_reserved = 0;							// count of reserved pages
 	};
 
+	// Keys of the single index, buffered to be inserted in the key order
+	struct IndexBuffer
+	{
+		explicit IndexBuffer(Firebird::MemoryPool&)
+		{}
+
+		index_desc m_index;
+		Firebird::AutoPtr<Sort> m_sort;
+		USHORT m_keyLength = 0;				// length of the (padded) key part of the sort record
+	};
+
+	void putKeys(thread_db* tdbb, record_param* rpb, jrd_tra* transaction);
+	void flushKeys(thread_db* tdbb);
+
 	Request* const m_request;		// "owner" request that will destroy this object on unwind
 
 	Firebird::AutoPtr<Buffer> m_primary;
 	Firebird::AutoPtr<Buffer> m_other;
+	Firebird::ObjectsArray<IndexBuffer> m_indices;
+	jrd_tra* m_transaction = nullptr;	// set when the list of indices is loaded
 };
 
 };	// namespace Jrd
@@ -403,6 +403,8 @@ public:
 	USHORT dbb_prefetch_sequence;		// sequence to pace frequency of prefetch requests
 	USHORT dbb_prefetch_pages;			// prefetch pages per request
 #endif
+	USHORT dbb_read_ahead_sequence;		// sequence to pace frequency of read-ahead requests
+	USHORT dbb_read_ahead_pages;		// read-ahead pages per request
 
 	Firebird::PathName dbb_filename;	// filename string
 	Firebird::PathName dbb_database_name;	// database visible name (file name or alias)
@@ -65,6 +65,8 @@ public:
 	int seek(Firebird::CheckStatusWrapper* status, int mode, int offset) override;			// returns position
 	void deprecatedCancel(Firebird::CheckStatusWrapper* status) override;
 	void deprecatedClose(Firebird::CheckStatusWrapper* status) override;
+	int getData(Firebird::CheckStatusWrapper* status, unsigned int length, void* buffer,
+		unsigned int* dataLength) override;
 
 public:
 	JBlob(blb* handle, StableAttachmentPart* sa);
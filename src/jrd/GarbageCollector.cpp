@@ -23,6 +23,7 @@
 #include "../common/classes/alloc.h"
 #include "../jrd/GarbageCollector.h"
 #include "../jrd/tra.h"
+#include <algorithm>
 
 using namespace Jrd;
 using namespace Firebird;
@@ -33,6 +34,7 @@ namespace Jrd {
 void GarbageCollector::RelationData::clear()
 {
 	m_pages.clear();
+	m_count = 0;
 }
 
 
@@ -58,6 +60,7 @@ TraNumber GarbageCollector::RelationData::addPage(const ULONG pageno, const TraN
 		return findTran;
 
 	m_pages.add(PageTran(pageno, tranid));
+	m_count++;
 	return tranid;
 }
 
@@ -76,6 +79,7 @@ void GarbageCollector::RelationData::swept(const TraNumber oldest_snapshot, Page
 				PBM_SET(&m_pool, bm, pages.current().pageno);
 			}
 			next = pages.fastRemove();
+			m_count--;
 		}
 		else
 			next = pages.getNext();
@@ -103,11 +107,15 @@ GarbageCollector::~GarbageCollector()
 }
 
 
-TraNumber GarbageCollector::addPage(const USHORT relID, const ULONG pageno, const TraNumber tranid)
+TraNumber GarbageCollector::addPage(const USHORT relID, const ULONG pageno, const TraNumber tranid,
+	const bool read)
 {
 	Sync syncGC(&m_sync, "GarbageCollector::addPage");
 	RelationData* relData = getRelData(syncGC, relID, true);
 
+	if (read)
+		relData->m_reads++;
+
 	SyncLockGuard syncData(&relData->m_sync, SYNC_SHARED, "GarbageCollector::addPage");
 	TraNumber minTraID = relData->findPage(pageno, tranid);
 	if (minTraID != MAX_TRA_NUMBER)
@@ -131,20 +139,59 @@ PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &
 		return NULL;
 	}
 
-	FB_SIZE_T pos;
-	if (!m_relations.find(m_nextRelID, pos) && (pos == m_relations.getCount()))
-		pos = 0;
+	// Relations are visited in the order of their priority. Relations of
+	// the same priority are visited round-robin, starting from m_nextRelID.
 
-	for (; pos < m_relations.getCount(); pos++)
+	struct Candidate
+	{
+		ULONG priority;
+		FB_SIZE_T order;
+		RelationData* relData;
+	};
+
+	HalfStaticArray<Candidate, 16> candidates;
+
+	const FB_SIZE_T count = m_relations.getCount();
+	FB_SIZE_T start;
+	if (!m_relations.find(m_nextRelID, start) && (start == count))
+		start = 0;
+
+	for (FB_SIZE_T pos = 0; pos < count; pos++)
 	{
 		RelationData* relData = m_relations[pos];
+
+		if (relData->m_count && !relData->m_busy)
+		{
+			Candidate& candidate = candidates.add();
+			candidate.priority = relData->getPriority();
+			candidate.order = (pos + count - start) % count;
+			candidate.relData = relData;
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(),
+		[](const Candidate& c1, const Candidate& c2)
+		{
+			return (c1.priority != c2.priority) ? c1.priority > c2.priority : c1.order < c2.order;
+		});
+
+	for (const auto& candidate : candidates)
+	{
+		RelationData* relData = candidate.relData;
 		SyncLockGuard syncData(&relData->m_sync, SYNC_EXCLUSIVE, "GarbageCollector::getPages");
 
+		// Another worker could take the relation meanwhile
+		if (relData->m_busy)
+			continue;
+
 		PageBitmap* bm = NULL;
 		relData->swept(oldest_snapshot, &bm);
 
 		if (bm)
 		{
+			relData->m_busy = true;
+			relData->m_reads = 0;
+
 			relID = relData->getRelID();
 			m_nextRelID = relID + 1;
 			return bm;
@@ -156,6 +203,21 @@ PageBitmap* GarbageCollector::getPages(const TraNumber oldest_snapshot, USHORT &
 }
 
 
+void GarbageCollector::releasePages(const USHORT relID, const ULONG count)
+{
+	m_processed += count;
+
+	Sync syncGC(&m_sync, "GarbageCollector::releasePages");
+
+	RelationData* relData = getRelData(syncGC, relID, false);
+	if (relData)
+	{
+		SyncLockGuard syncData(&relData->m_sync, SYNC_EXCLUSIVE, "GarbageCollector::releasePages");
+		relData->m_busy = false;
+	}
+}
+
+
 void GarbageCollector::removeRelation(const USHORT relID)
 {
 	Sync syncGC(&m_sync, "GarbageCollector::removeRelation");
@@ -192,6 +254,19 @@ void GarbageCollector::sweptRelation(const TraNumber oldest_snapshot, const USHO
 }
 
 
+FB_UINT64 GarbageCollector::getPendingPages()
+{
+	SyncLockGuard shGuard(&m_sync, SYNC_SHARED, "GarbageCollector::getPendingPages");
+
+	FB_UINT64 count = 0;
+
+	for (const auto relData : m_relations)
+		count += relData->m_count;
+
+	return count;
+}
+
+
 GarbageCollector::RelationData* GarbageCollector::getRelData(Sync &sync, const USHORT relID,
 	bool allowCreate)
 {
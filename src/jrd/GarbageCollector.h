@@ -28,6 +28,7 @@
 #include "../common/classes/GenericMap.h"
 #include "../common/classes/SyncObject.h"
 #include "../jrd/sbm.h"
+#include <atomic>
 
 
 namespace Jrd {
@@ -39,16 +40,25 @@ class GarbageCollector
 {
 public:
 	GarbageCollector(MemoryPool& p, Database* dbb)
-	  : m_pool(p), m_relations(m_pool), m_nextRelID(0)
+	  : m_pool(p), m_relations(m_pool), m_nextRelID(0), m_processed(0)
 	{}
 
 	~GarbageCollector();
 
-	TraNumber addPage(const USHORT relID, const ULONG pageno, const TraNumber tranid);
+	TraNumber addPage(const USHORT relID, const ULONG pageno, const TraNumber tranid,
+		const bool read = false);
 	PageBitmap* getPages(const TraNumber oldest_snapshot, USHORT &relID);
+	void releasePages(const USHORT relID, const ULONG count);
 	void removeRelation(const USHORT relID);
 	void sweptRelation(const TraNumber oldest_snapshot, const USHORT relID);
 
+	FB_UINT64 getPendingPages();
+
+	FB_UINT64 getProcessedPages() const
+	{
+		return m_processed;
+	}
+
 private:
 	struct PageTran
 	{
@@ -77,7 +87,7 @@ private:
 	{
 	public:
 		explicit RelationData(MemoryPool& p, USHORT relID)
-			: m_pool(p), m_pages(p), m_relID(relID)
+			: m_pool(p), m_pages(p), m_relID(relID), m_count(0), m_reads(0), m_busy(false)
 		{}
 
 		~RelationData()
@@ -99,12 +109,22 @@ private:
 			return item->m_relID;
 		}
 
+		// Relations with more pages to clean up and with the garbage
+		// met more often by readers are garbage collected first
+		ULONG getPriority() const
+		{
+			return m_count + m_reads;
+		}
+
 		void clear();
 
 		Firebird::MemoryPool& m_pool;
 		Firebird::SyncObject m_sync;
 		PageTranMap m_pages;
 		USHORT m_relID;
+		ULONG m_count;						// number of pages in m_pages
+		std::atomic<ULONG> m_reads;			// readers notifications since the last pass
+		bool m_busy;						// pages are garbage collected by some worker
 	};
 
 	typedef	Firebird::SortedArray<
@@ -119,6 +139,7 @@ private:
 	Firebird::SyncObject m_sync;
 	RelGarbageArray m_relations;
 	USHORT m_nextRelID;
+	std::atomic<FB_UINT64> m_processed;		// number of garbage collected pages
 };
 
 } // namespace Jrd
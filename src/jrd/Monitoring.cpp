@@ -42,6 +42,7 @@
 #include "../jrd/pag_proto.h"
 #include "../jrd/cvt_proto.h"
 #include "../jrd/CryptoManager.h"
+#include "../jrd/GarbageCollector.h"
 #include "../jrd/Relation.h"
 #include "../jrd/RecordBuffer.h"
 #include "../jrd/Monitoring.h"
@@ -1031,6 +1032,13 @@ void Monitoring::putDatabase(thread_db* tdbb, SnapshotData::DumpRecord& record)
 
 	record.storeInteger(f_mon_db_repl_mode, dbb->dbb_replica_mode);
 
+	// background garbage collection backlog and progress
+	if (const auto gc = dbb->dbb_garbage_collector)
+	{
+		record.storeInteger(f_mon_db_gc_pending, gc->getPendingPages());
+		record.storeInteger(f_mon_db_gc_processed, gc->getProcessedPages());
+	}
+
 	// statistics
 	const int stat_id = fb_utils::genUniqueId();
 	record.storeGlobalId(f_mon_db_stat_id, getGlobalId(stat_id));
@@ -1518,6 +1526,8 @@ void Monitoring::putStatistics(thread_db* tdbb, SnapshotData::DumpRecord& record
 	record.storeInteger(f_mon_io_page_writes, statistics[PageStatType::WRITES]);
 	record.storeInteger(f_mon_io_page_fetches, statistics[PageStatType::FETCHES]);
 	record.storeInteger(f_mon_io_page_marks, statistics[PageStatType::MARKS]);
+	record.storeInteger(f_mon_io_cache_hits, statistics[PageStatType::CACHE_HITS]);
+	record.storeInteger(f_mon_io_cache_misses, statistics[PageStatType::CACHE_MISSES]);
 	record.write();
 
 	// logical I/O statistics (global)
@@ -2158,13 +2158,21 @@ RecordSource* AggregateSourceNode::compile(thread_db* tdbb, Optimizer* opt, bool
 		rse->firstRows = true;
 	}
 
-	RecordSource* const nextRsb = opt->compile(rse, &deliverStack);
+	// Unless the parent relies on the output order, ask the optimizer for the sort
+	// generated for the group: it may be replaced with a hash table
+	SortedStream* groupSort = nullptr;
+
+	RecordSource* const nextRsb = opt->compile(rse, &deliverStack,
+		(group && !sortedOutput) ? &groupSort : nullptr);
 
 	// allocate and optimize the record source block
 
 	AggregatedStream* const rsb = FB_NEW_POOL(*tdbb->getDefaultPool()) AggregatedStream(tdbb, csb,
 		stream, (group ? &group->expressions : NULL), map, nextRsb);
 
+	if (groupSort)
+		rsb->setupHashing(tdbb, csb, groupSort);
+
 	if (rse->rse_aggregate)
 	{
 		// The rse_aggregate is still set. That means the optimizer
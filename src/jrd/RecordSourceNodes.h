@@ -529,7 +529,8 @@ public:
 		  group(NULL),
 		  map(NULL),
 		  rse(NULL),
-		  dsqlWindow(false)
+		  dsqlWindow(false),
+		  sortedOutput(false)
 	{
 	}
 
@@ -579,6 +580,7 @@ private:
 
 public:
 	bool dsqlWindow;
+	bool sortedOutput;	// parent relies on the output being ordered by the group
 };
 
 class UnionSourceNode final : public TypedNode<RecordSourceNode, RecordSourceNode::TYPE_UNION>
@@ -112,7 +112,8 @@ jrd_rel::jrd_rel(MemoryPool& p, Cached::Relation* r)
 	  rel_view_rse(nullptr),
 	  rel_view_contexts(p),
 	  rel_triggers(p),
-	  rel_ss_definer(false)
+	  rel_ss_definer(false),
+	  rel_compressed(false)
 { }
 
 RelationPermanent::RelationPermanent(thread_db* tdbb, MemoryPool& p, MetaId id, NoData)
@@ -121,6 +122,7 @@ RelationPermanent::RelationPermanent(thread_db* tdbb, MemoryPool& p, MetaId id,
 	  rel_gc_lock(this),
 	  rel_gc_records(p),
 	  rel_scan_count(0),
+	  rel_version_cache(p),
 	  rel_formats(/*p*/),
 	  rel_indices(p, this),
 	  rel_name(p),
@@ -33,6 +33,8 @@
 #include "../jrd/ExtEngineManager.h"
 #include "../jrd/met_proto.h"
 #include "../jrd/Resources.h"
+#include "../jrd/optimizer/Histogram.h"
+#include "../jrd/VersionCache.h"
 #include "../common/classes/TriState.h"
 #include "../common/sha2/sha2.h"
 #include "../jrd/ods.h"
@@ -533,6 +535,9 @@ public:
 		idp_formatNumber = fmt;
 	}
 
+	// Histogram is reloaded when the index statistics are recalculated
+	Firebird::RefPtr<const IndexHistogram> getHistogram(thread_db* tdbb, float selectivity);
+
 private:
 	void refreshIndexCode(thread_db* tdbb, Cached::Relation* relation,
 		index_desc* idx, const Ods::index_root_page::irt_repeat* irt_desc);
@@ -547,6 +552,10 @@ private:
 	bid					idp_condition_bid;
 	BoolExprNode*		idp_condition = nullptr;			// node tree for index condition
 	Statement*			idp_condition_statement = nullptr;	// statement for index condition evaluation
+
+	Firebird::Mutex		idp_histogram_mutex;
+	Firebird::RefPtr<const IndexHistogram> idp_histogram;	// distribution of the leading segment values
+	float				idp_histogram_selectivity = -1;		// index selectivity the histogram was loaded for
 };
 
 
@@ -652,6 +661,7 @@ public:
 	TrigArray			rel_triggers;
 
 	Firebird::TriState	rel_ss_definer;
+	bool				rel_compressed;		// store records block compressed
 
 	bool hasData() const;
 	MetaId getId() const noexcept;
@@ -883,6 +893,9 @@ private:
 
 public:
 	std::atomic<SSHORT>	rel_scan_count;		// concurrent sequential scan count
+	std::atomic<ULONG>	rel_visibility_epoch = 0;	// changed when "all visible" bit of data page is reset
+	std::atomic<ULONG>	rel_gc_active = 0;		// record versions being garbage collected, see check_swept() in dpm.epp
+	VersionCache	rel_version_cache;	// latest committed versions of hot records
 
 	class RelPagesSnapshot : public Firebird::Array<RelationPages*>
 	{
@@ -50,6 +50,8 @@ enum class PageStatType
 	READS,
 	MARKS,
 	WRITES,
+	CACHE_HITS,
+	CACHE_MISSES,
 	TOTAL_ITEMS
 };
 
@@ -0,0 +1,57 @@
+﻿/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/VersionCache.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+void VersionCache::put(SINT64 number, TraNumber head, TraNumber version, CommitNumber commit,
+	USHORT format, ULONG length, const UCHAR* data)
+{
+/**************************************
+ *
+ *	p u t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Store the latest committed version of the record,
+ *	replacing any other record sharing the same slot.
+ *
+ **************************************/
+	if (length > MAX_LENGTH)
+		return;
+
+	WriteLockGuard guard(m_lock, FB_FUNCTION);
+
+	if (m_entries.isEmpty())
+		m_entries.grow(SIZE);
+
+	Entry& entry = m_entries[number % SIZE];
+
+	entry.number = number;
+	entry.head = head;
+	entry.version = version;
+	entry.commit = commit;
+	entry.format = format;
+	entry.data.assign(data, length);
+}
@@ -0,0 +1,97 @@
+﻿/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_VERSION_CACHE_H
+#define JRD_VERSION_CACHE_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/objects_array.h"
+#include "../common/classes/rwlock.h"
+
+namespace Jrd {
+
+// Latest committed versions of the records updated by still active (or recently
+// committed) transactions.
+//
+// Readers of the statement level snapshot (READ COMMITTED READ CONSISTENCY) find
+// the primary version of a hot record invisible and walk its chain of back versions,
+// reconstructing the delta versions, on every read. The version found is cached
+// keyed by the record number and the transaction of the primary version: while the
+// primary version belongs to the same transaction, the versions between it and the
+// cached one belong to that transaction too, so the cached version remains the
+// latest committed one. It's visible to every snapshot that is not older than its
+// commit and doesn't see the primary version.
+//
+// The cache is a direct mapped table shared by the attachments, which is allocated
+// when the first version is stored.
+
+class VersionCache : public Firebird::PermanentStorage
+{
+public:
+	static constexpr unsigned SIZE = 128;
+	static constexpr ULONG MAX_LENGTH = 4096;	// longer records are not cached
+
+	explicit VersionCache(MemoryPool& pool)
+		: PermanentStorage(pool), m_entries(pool)
+	{}
+
+	void put(SINT64 number, TraNumber head, TraNumber version, CommitNumber commit,
+		USHORT format, ULONG length, const UCHAR* data);
+
+	// Callback gets format number, transaction number and data of the version
+	template <typename Copier>
+	bool get(SINT64 number, TraNumber head, CommitNumber snapshot, Copier copier)
+	{
+		Firebird::ReadLockGuard guard(m_lock, FB_FUNCTION);
+
+		if (m_entries.isEmpty())
+			return false;
+
+		const Entry& entry = m_entries[number % SIZE];
+
+		if (entry.number != number || entry.head != head || entry.commit > snapshot)
+			return false;
+
+		copier(entry.format, entry.version, entry.data.getCount(), entry.data.begin());
+		return true;
+	}
+
+private:
+	struct Entry
+	{
+		explicit Entry(MemoryPool& pool)
+			: data(pool)
+		{}
+
+		SINT64 number = -1;				// record number
+		TraNumber head = 0;				// transaction of the primary version
+		TraNumber version = 0;			// transaction of the cached version
+		CommitNumber commit = 0;		// commit number of the cached version
+		USHORT format = 0;				// format number of the cached version
+		Firebird::Array<UCHAR> data;	// record data
+	};
+
+	Firebird::ObjectsArray<Entry> m_entries;
+	Firebird::RWLock m_lock;
+};
+
+} // namespace Jrd
+
+#endif // JRD_VERSION_CACHE_H
@@ -70,6 +70,7 @@
 #include "../jrd/pag_proto.h"
 #include "../jrd/scl_proto.h"
 #include "../jrd/BulkInsert.h"
+#include "../jrd/sqz.h"
 #include "../common/sdl_proto.h"
 #include "../common/dsc_proto.h"
 #include "../common/classes/array.h"
@@ -3027,9 +3028,26 @@ void blb::toPageHeader(Ods::blh* header) const
 }
 
 // Used by DPM_get_blob
-void blb::getFromPage(USHORT length, const UCHAR* data)
+bool blb::getFromPage(USHORT length, const UCHAR* data, bool packed)
 {
-	if (blb_level == 0)
+	if (blb_level == 0 && packed)
+	{
+		// Data clump is block compressed, see packToPage()
+
+		if (length <= BLH_SIZE)
+			return false;
+
+		const ULONG packedLength = length - BLH_SIZE;
+		const ULONG dataLength = BlockCompressor::getUnpackedLength(packedLength, data + BLH_SIZE);
+		if (dataLength > blb_clump_size)
+			return false;
+
+		UCHAR* const buffer = getBuffer();
+		memcpy(buffer, data, BLH_SIZE);
+		BlockCompressor::unpack(packedLength, data + BLH_SIZE, dataLength, buffer + BLH_SIZE);
+		blb_space_remaining = dataLength;
+	}
+	else if (blb_level == 0)
 	{
 		blb_space_remaining = length - BLH_SIZE;
 		if (length)
@@ -3043,6 +3061,8 @@ void blb::getFromPage(USHORT length, const UCHAR* data)
 		blb_pages->resize(length / sizeof(ULONG));
 		memcpy(blb_pages->memPtr(), data, length);
 	}
+
+	return true;
 }
 
 // Used by DPM_store_blob
@@ -3093,6 +3113,25 @@ void blb::storeToPage(USHORT* length, Firebird::Array<UCHAR>& buffer, const UCHA
 	}
 }
 
+// Used by DPM_store_blob and BulkInsert: replace the level 0 data clump
+// by its block compressed copy if the latter is shorter
+bool blb::packToPage(USHORT* length, Firebird::Array<UCHAR>& buffer, const UCHAR** data) const
+{
+	if (blb_level != 0 || *length < BlockCompressor::MIN_LENGTH)
+		return false;
+
+	const ULONG maxLength = *length - 1;
+	const ULONG packedLength = BlockCompressor::pack(*length, *data,
+		maxLength, buffer.getBuffer(maxLength, false));
+
+	if (!packedLength)
+		return false;
+
+	*length = static_cast<USHORT>(packedLength);
+	*data = buffer.begin();
+	return true;
+}
+
 void blb::BLB_cancel()
 {
 	BLB_cancel(JRD_get_thread_data());
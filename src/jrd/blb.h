@@ -123,8 +123,16 @@ public:
 	static void delete_blob_id(thread_db*, const bid*, ULONG, Jrd::jrd_rel*);
 	void fromPageHeader(const Ods::blh* header);
 	void toPageHeader(Ods::blh* header) const;
-	void getFromPage(USHORT length, const UCHAR* data);
+	bool getFromPage(USHORT length, const UCHAR* data, bool packed = false);
 	void storeToPage(USHORT* length, Firebird::Array<UCHAR>& buffer, const UCHAR** data, void* stack);
+	bool packToPage(USHORT* length, Firebird::Array<UCHAR>& buffer, const UCHAR** data) const;
+
+	// Check if blob data is stored on the primary data page, next to its record.
+	// Zero threshold (SmallBlobThreshold in firebird.conf) disables it.
+	static bool isSmall(USHORT level, ULONG length, ULONG threshold)
+	{
+		return !level && threshold && length <= threshold;
+	}
 
 	static bid copy(thread_db* tdbb, const bid* source)
 	{
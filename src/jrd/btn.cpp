@@ -629,3 +629,120 @@ UCHAR* IndexNode::writeNode(UCHAR* pagePointer, bool leafNode, bool withData)
 
 	return pagePointer;
 }
+
+
+bool IndexPageDirectory::build(const btree_page* page, ULONG maxKeySize)
+{
+/**************************************
+ *
+ *	b u i l d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Walk the page nodes and store their
+ *  offsets and decoded keys.
+ *
+ **************************************/
+	entries.clear();
+	keys.clear();
+
+	const bool leafNode = (page->btr_level == 0);
+	UCHAR* pointer = (UCHAR*) page->btr_nodes + page->btr_jump_size;
+	const UCHAR* const endPointer = (UCHAR*) page + page->btr_length;
+
+	ULONG lastStart = 0;
+	USHORT lastLength = 0;
+
+	IndexNode node;
+
+	while (pointer < endPointer)
+	{
+		pointer = node.readNode(pointer, leafNode);
+
+		if (pointer > endPointer || node.prefix > lastLength)
+			return false;
+
+		Entry& entry = entries.add();
+		entry.offset = (USHORT) (node.nodePointer - (UCHAR*) page);
+		entry.endLevel = node.isEndLevel;
+		entry.keyStart = keys.getCount();
+		entry.keyLength = node.prefix + node.length;
+
+		if (keys.getCount() + entry.keyLength > maxKeySize)
+			return false;
+
+		// Prefix is taken from the previous key, it's the last one in the buffer
+		keys.grow(entry.keyStart + entry.keyLength);
+		UCHAR* const nodeKey = keys.begin() + entry.keyStart;
+
+		if (node.prefix)
+			memcpy(nodeKey, keys.begin() + lastStart, node.prefix);
+
+		memcpy(nodeKey + node.prefix, node.data, node.length);
+
+		if (node.isEndLevel || node.isEndBucket)
+			return true;
+
+		lastStart = entry.keyStart;
+		lastLength = entry.keyLength;
+	}
+
+	// END_LEVEL or END_BUCKET marker is not found
+	return false;
+}
+
+
+FB_SIZE_T IndexPageDirectory::findNode(const UCHAR* key, USHORT length) const
+{
+/**************************************
+ *
+ *	f i n d N o d e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Binary search for the first node which
+ *  key is not less than the given one.
+ *
+ **************************************/
+	FB_SIZE_T lowBound = 0, highBound = entries.getCount();
+
+	while (highBound > lowBound)
+	{
+		const FB_SIZE_T temp = (highBound + lowBound) >> 1;
+
+		if (isLess(entries[temp], key, length))
+			lowBound = temp + 1;
+		else
+			highBound = temp;
+	}
+
+	return lowBound;
+}
+
+
+USHORT IndexPageDirectory::getPrefix(FB_SIZE_T pos, const UCHAR* key, USHORT length) const
+{
+	const Entry& entry = entries[pos];
+	const UCHAR* const nodeKey = keys.begin() + entry.keyStart;
+	const USHORT maxLength = MIN(length, entry.keyLength);
+
+	USHORT prefix = 0;
+	while (prefix < maxLength && nodeKey[prefix] == key[prefix])
+		prefix++;
+
+	return prefix;
+}
+
+
+bool IndexPageDirectory::isLess(const Entry& entry, const UCHAR* key, USHORT length) const
+{
+	// The last node of the level is greater than any key
+	if (entry.endLevel)
+		return false;
+
+	const int result = memcmp(keys.begin() + entry.keyStart, key, MIN(entry.keyLength, length));
+
+	return (result < 0) || (!result && entry.keyLength < length);
+}
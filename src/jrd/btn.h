@@ -276,6 +276,74 @@ struct IndexJumpNode
 	UCHAR* writeJumpNode(UCHAR* pagePointer);
 };
 
+// Decoded keys of all nodes of a b-tree page. Nodes are prefix compressed
+// and have to be read sequentially, while the directory allows to locate
+// the node by a binary search. It's built by page readers and cached with
+// the page buffer until the page is changed, see BTR_find_page.
+
+class IndexPageDirectory : public Firebird::PermanentStorage
+{
+public:
+	explicit IndexPageDirectory(MemoryPool& pool)
+		: PermanentStorage(pool),
+		  entries(pool),
+		  keys(pool)
+	{}
+
+	// Decode the page nodes, return false if the decoded keys exceed maxKeySize
+	// or the page looks inconsistent
+	bool build(const Ods::btree_page* page, ULONG maxKeySize);
+
+	// Find the first node with the key not less than the given one (the last node
+	// of the level is greater than any key). Return the node position in the page
+	// or getCount() if all the nodes, including END_BUCKET marker, are less.
+	FB_SIZE_T findNode(const UCHAR* key, USHORT length) const;
+
+	// Length of the common prefix of the given key and the key of the node
+	USHORT getPrefix(FB_SIZE_T pos, const UCHAR* key, USHORT length) const;
+
+	FB_SIZE_T getCount() const
+	{
+		return entries.getCount();
+	}
+
+	UCHAR* getNode(Ods::btree_page* page, FB_SIZE_T pos) const
+	{
+		return (UCHAR*) page + entries[pos].offset;
+	}
+
+	const UCHAR* getKey(FB_SIZE_T pos, USHORT& length) const
+	{
+		length = entries[pos].keyLength;
+		return keys.begin() + entries[pos].keyStart;
+	}
+
+	bool isEndLevel(FB_SIZE_T pos) const
+	{
+		return entries[pos].endLevel;
+	}
+
+	// Memory allocated for the decoded nodes
+	FB_SIZE_T getMemorySize() const
+	{
+		return entries.getCapacity() * sizeof(Entry) + keys.getCapacity();
+	}
+
+private:
+	struct Entry
+	{
+		ULONG keyStart;		// offset of the decoded key in the keys buffer
+		USHORT keyLength;	// length of the decoded key
+		USHORT offset;		// offset of the node in the page
+		bool endLevel;		// END_LEVEL marker
+	};
+
+	bool isLess(const Entry& entry, const UCHAR* key, USHORT length) const;
+
+	Firebird::Array<Entry> entries;
+	Firebird::Array<UCHAR> keys;
+};
+
 } // namespace Jrd
 
 #endif // JRD_BTN_H
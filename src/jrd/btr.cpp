@@ -65,6 +65,10 @@
 #include "../jrd/tra_proto.h"
 #include "../jrd/tpc_proto.h"
 #include "../dsql/DdlNodes.h"
+#include "../jrd/optimizer/Histogram.h"
+#include "../jrd/WorkerAttachment.h"
+#include "../common/StatusHolder.h"
+#include "../common/Task.h"
 
 using namespace Jrd;
 using namespace Ods;
@@ -98,6 +102,21 @@ namespace
 	// of the main page.
 	inline constexpr ULONG NO_SPLIT = 0;
 
+	// Decoded key directory is built for the page searched more than once
+	// since it was read or changed. Decoded keys are limited by the page size
+	// multiplied by DIRECTORY_KEY_FACTOR, otherwise the page is searched linearly.
+	// Directories of all cached pages may take up to 1/DIRECTORY_CACHE_SHARE
+	// of the page cache size, pages over this limit are searched linearly too.
+	constexpr int DIRECTORY_MIN_LOOKUPS = 2;
+	constexpr ULONG DIRECTORY_KEY_FACTOR = 2;
+	constexpr ULONG DIRECTORY_CACHE_SHARE = 4;
+
+	// Leaf level is scanned by parallel workers in ranges of at least
+	// STATISTICS_RANGE_PAGES pages, every worker is given a few ranges
+	// to balance the load
+	constexpr ULONG STATISTICS_RANGE_PAGES = 64;
+	constexpr ULONG STATISTICS_RANGES_PER_WORKER = 4;
+
 	// Thresholds for determing of a page should be garbage collected
 	// Garbage collect if page size is below GARBAGE_COLLECTION_THRESHOLD
 #define GARBAGE_COLLECTION_BELOW_THRESHOLD	(dbb->dbb_page_size / 4)
@@ -234,17 +253,19 @@ static ULONG fast_load(thread_db*, IndexCreation&, SelectivityList&);
 
 static const index_root_page* fetch_root(thread_db*, WIN*, const RelationPermanent*, const RelationPages*);
 static UCHAR* find_node_start_point(btree_page*, temporary_key*, UCHAR*, USHORT*,
-									bool, int, bool = false, RecordNumber = NO_VALUE);
+									bool, int, bool = false, RecordNumber = NO_VALUE,
+									const IndexPageDirectory* = nullptr);
 
 static UCHAR* find_area_start_point(btree_page*, const temporary_key*, UCHAR*, USHORT*,
 									bool, int, RecordNumber = NO_VALUE);
 
 static ULONG find_page(btree_page*, const temporary_key*, const index_desc*, RecordNumber = NO_VALUE,
-					   int = 0);
+					   int = 0, const IndexPageDirectory* = nullptr);
 
-static contents garbage_collect(thread_db*, WIN*, ULONG);
+static contents garbage_collect(thread_db*, WIN*, ULONG, bool = false);
 static void generate_jump_nodes(thread_db*, btree_page*, JumpNodeList*, USHORT,
 								USHORT*, USHORT*, USHORT*, USHORT);
+static const IndexPageDirectory* get_directory(thread_db*, WIN*);
 
 static ULONG insert_node(thread_db*, WIN*, index_insertion*, temporary_key*,
 						 RecordNumber*, ULONG*, ULONG*);
@@ -254,6 +275,8 @@ static INT64_KEY make_int64_key(SINT64, SSHORT);
 static void print_int64_key(SINT64, SSHORT, INT64_KEY);
 #endif
 static string print_key(thread_db*, jrd_rel*, index_desc*, Record*);
+static void read_ahead_leaf_pages(thread_db*, WIN*, btree_page*, const index_desc*,
+								  const IndexRetrieval*, ULONG, const temporary_key*);
 static contents remove_node(thread_db*, index_insertion*, WIN*);
 static contents remove_leaf_node(thread_db*, index_insertion*, WIN*);
 static bool scan(thread_db*, UCHAR*, RecordBitmap**, RecordBitmap*, index_desc*,
@@ -1051,6 +1074,170 @@ void BTR_complement_key(temporary_key* key)
 }
 
 
+void BTR_compact(thread_db* tdbb, Cached::Relation* relation, MetaId id)
+{
+/**************************************
+ *
+ *	B T R _ c o m p a c t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Merge sparse pages of an index into their
+ *	left siblings, level by level starting from
+ *	the leaf one, then remove the top levels left
+ *	with a single page. Pages are merged one by one
+ *	the same way as they are garbage collected, thus
+ *	concurrent readers and writers are not blocked.
+ *
+ **************************************/
+
+	SET_TDBB(tdbb);
+	RelationPages* const relPages = relation->getPages(tdbb);
+	WIN window(relPages->rel_pg_space_id, -1);
+
+	const auto isLevelPage = [relation, id](const btree_page* page, UCHAR level)
+	{
+		return page->btr_header.pag_type == pag_index &&
+			!(page->btr_header.pag_flags & btr_released) &&
+			page->btr_relation == relation->getId() &&
+			page->btr_id == (UCHAR) (id % 256) &&
+			page->btr_level == level;
+	};
+
+	HalfStaticArray<ULONG, 256> children;
+
+	for (UCHAR level = 1; ; level++)
+	{
+		// Find the leftmost page of the level above the pages to merge
+
+		const index_root_page* const root = fetch_root(tdbb, &window, relation, relPages);
+		if (!root)
+			return;
+
+		if (id >= root->irt_count || root->irt_rpt[id].getState() != irt_normal)
+		{
+			CCH_RELEASE(tdbb, &window);
+			return;
+		}
+
+		btree_page* bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, root->irt_rpt[id].getRoot(),
+			LCK_read, pag_index);
+
+		if (bucket->btr_level < level)
+		{
+			CCH_RELEASE(tdbb, &window);
+			break;
+		}
+
+		while (bucket->btr_level > level)
+		{
+			IndexNode pageNode;
+			pageNode.readNode(bucket->btr_nodes + bucket->btr_jump_size, false);
+			bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, pageNode.pageNumber, LCK_read, pag_index);
+		}
+
+		while (true)
+		{
+			// Remember children of the parent page and release it,
+			// garbage_collect() locks the parent page itself
+
+			const ULONG parentNumber = window.win_page.getPageNum();
+			const ULONG sibling = bucket->btr_sibling;
+
+			children.clear();
+
+			UCHAR* pointer = bucket->btr_nodes + bucket->btr_jump_size;
+			IndexNode pageNode;
+
+			while (true)
+			{
+				pointer = pageNode.readNode(pointer, false);
+
+				if (pageNode.isEndBucket || pageNode.isEndLevel)
+					break;
+
+				children.add(pageNode.pageNumber);
+			}
+
+			CCH_RELEASE(tdbb, &window);
+
+			// The first child is never merged into the last child of the previous parent
+
+			for (FB_SIZE_T i = 1; i < children.getCount(); i++)
+			{
+				WIN childWindow(relPages->rel_pg_space_id, children[i]);
+				const btree_page* const child =
+					(btree_page*) CCH_FETCH(tdbb, &childWindow, LCK_write, pag_undefined);
+
+				if (isLevelPage(child, level - 1))
+					garbage_collect(tdbb, &childWindow, parentNumber, true);
+				else
+					CCH_RELEASE(tdbb, &childWindow);
+
+				JRD_reschedule(tdbb);
+			}
+
+			if (!sibling)
+				break;
+
+			// The next parent page could be garbage collected meanwhile
+
+			window.win_page = sibling;
+			bucket = (btree_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_undefined);
+
+			if (!isLevelPage(bucket, level))
+			{
+				CCH_RELEASE(tdbb, &window);
+				break;
+			}
+		}
+	}
+
+	// Remove the levels above the single page, as BTR_remove() does
+
+	while (true)
+	{
+		window.win_page = relPages->rel_index_root;
+		window.win_flags = 0;
+		index_root_page* const root = BTR_fetch_root_for_update(FB_FUNCTION, tdbb, &window);
+
+		if (id >= root->irt_count || root->irt_rpt[id].getState() != irt_normal)
+		{
+			CCH_RELEASE(tdbb, &window);
+			break;
+		}
+
+		WIN topWindow(relPages->rel_pg_space_id, root->irt_rpt[id].getRoot());
+		btree_page* const top = (btree_page*) CCH_FETCH(tdbb, &topWindow, LCK_write, pag_index);
+
+		IndexNode pageNode;
+		UCHAR* pointer = pageNode.readNode(top->btr_nodes + top->btr_jump_size, false);
+		const ULONG number = pageNode.pageNumber;
+
+		if (top->btr_level > 1)
+			pageNode.readNode(pointer, false);
+
+		if (top->btr_level <= 1 || !(pageNode.isEndBucket || pageNode.isEndLevel))
+		{
+			CCH_RELEASE(tdbb, &topWindow);
+			CCH_RELEASE(tdbb, &window);
+			break;
+		}
+
+		CCH_MARK(tdbb, &window);
+		root->irt_rpt[id].setRoot(number);
+		CCH_RELEASE(tdbb, &window);
+
+		CCH_MARK(tdbb, &topWindow);
+		top->btr_header.pag_flags |= btr_released;
+		CCH_RELEASE(tdbb, &topWindow);
+
+		PAG_release_page(tdbb, topWindow.win_page, window.win_page);
+	}
+}
+
+
 void BTR_create(thread_db* tdbb,
 				IndexCreation& creation,
 				SelectivityList& selectivity)
@@ -1100,6 +1287,209 @@ void BTR_create(thread_db* tdbb,
 }
 
 
+bool BTR_decodable(thread_db* tdbb, jrd_rel* relation, const index_desc* idx)
+{
+/**************************************
+ *
+ *	B T R _ d e c o d a b l e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Check if values of all the index segments could be
+ *	restored from the index key, see BTR_decode_key.
+ *	Only ascending indices on the simple fields of the
+ *	fixed size numeric, date/time and boolean types are
+ *	supported. Note that string keys are not decodable,
+ *	as well as keys of BIGINT and decimal types.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	if (idx->idx_flags & (idx_descending | idx_expression))
+		return false;
+
+	const Format* format = relation->currentFormat(tdbb);
+
+	for (USHORT n = 0; n < idx->idx_count; n++)
+	{
+		const index_desc::idx_repeat* tail = &idx->idx_rpt[n];
+
+		if (tail->idx_field >= format->fmt_count)
+			return false;
+
+		const UCHAR dtype = format->fmt_desc[tail->idx_field].dsc_dtype;
+
+		switch (tail->idx_itype)
+		{
+		case idx_numeric:
+			if (dtype != dtype_short && dtype != dtype_long && dtype != dtype_real && dtype != dtype_double)
+				return false;
+			break;
+
+		case idx_sql_date:
+		case idx_sql_time:
+		case idx_timestamp:
+		case idx_boolean:
+			break;
+
+		default:
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+bool BTR_decode_key(thread_db* tdbb, const index_desc* idx, const UCHAR* key, USHORT length, Record* record)
+{
+/**************************************
+ *
+ *	B T R _ d e c o d e _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Restore values of the index segments from the index key
+ *	and assign them to the corresponding record fields. This
+ *	is the reverse of compress() for the types accepted by
+ *	BTR_decodable. Return false if the key is malformed.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	const Format* format = record->getFormat();
+	const UCHAR* p = key;
+	const UCHAR* const end = key + length;
+
+	for (USHORT n = 0; n < idx->idx_count; n++)
+	{
+		const index_desc::idx_repeat* tail = &idx->idx_rpt[n];
+
+		// Collect the segment bytes, see IndexKey::compose() for the layout of compound keys
+
+		UCHAR data[sizeof(double)];
+		memset(data, 0, sizeof(data));
+		USHORT dataLength = 0;
+
+		if (idx->idx_count == 1)
+		{
+			if (length > sizeof(data))
+				return false;
+
+			memcpy(data, p, length);
+			dataLength = length;
+			p = end;
+		}
+		else
+		{
+			const UCHAR marker = idx->idx_count - n;
+
+			while (p < end && *p == marker)
+			{
+				p++;
+				const USHORT chunk = MIN(STUFF_COUNT, end - p);
+
+				if (dataLength + chunk > sizeof(data))
+					return false;
+
+				memcpy(data + dataLength, p, chunk);
+				dataLength += chunk;
+				p += chunk;
+			}
+		}
+
+		const USHORT id = tail->idx_field;
+
+		// Ascending NULL has no key bytes, while not NULL value has at least one
+		if (!dataLength)
+		{
+			record->setNull(id);
+			continue;
+		}
+
+		// Undo the sign handling, negative numbers are complemented as a whole
+		if (tail->idx_itype == idx_numeric && !(data[0] & 0x80))
+		{
+			for (auto& byte : data)
+				byte = ~byte;
+		}
+		else
+			data[0] ^= 0x80;
+
+		FB_UINT64 value = 0;
+		for (const auto byte : data)
+			value = (value << 8) | byte;
+
+		union
+		{
+			double d;
+			SLONG date;
+			ULONG time;
+			ISC_TIMESTAMP timestamp;
+			UCHAR boolean;
+		} temp;
+
+		dsc from;
+
+		switch (tail->idx_itype)
+		{
+		case idx_numeric:
+			memcpy(&temp.d, &value, sizeof(double));
+			from.makeDouble(&temp.d);
+			break;
+
+		case idx_sql_date:
+			temp.date = (SLONG) (value >> 32);
+			from.makeDate(&temp.date);
+			break;
+
+		case idx_sql_time:
+			temp.time = (ULONG) (value >> 32);
+			from.makeTime(&temp.time);
+			break;
+
+		case idx_timestamp:
+			{
+				const SINT64 ticksPerDay = NoThrowTimeStamp::SECONDS_PER_DAY * ISC_TIME_SECONDS_PRECISION;
+				const SINT64 ticks = (SINT64) value;
+
+				SINT64 date = ticks / ticksPerDay;
+				SINT64 time = ticks % ticksPerDay;
+
+				if (time < 0)
+				{
+					time += ticksPerDay;
+					date--;
+				}
+
+				temp.timestamp.timestamp_date = (ISC_DATE) date;
+				temp.timestamp.timestamp_time = (ISC_TIME) time;
+				from.makeTimestamp(&temp.timestamp);
+			}
+			break;
+
+		case idx_boolean:
+			temp.boolean = (UCHAR) (value >> 56);
+			from.makeBoolean(&temp.boolean);
+			break;
+
+		default:
+			return false;
+		}
+
+		dsc to = format->fmt_desc[id];
+		to.dsc_address = record->getData() + (IPTR) to.dsc_address;
+
+		MOV_move(tdbb, &from, &to);
+		record->clearNull(id);
+	}
+
+	return true;
+}
+
+
 bool BTR_delete_index(thread_db* tdbb, WIN* window, MetaId id, bool withCleanup)
 {
 /**************************************
@@ -1545,6 +1935,113 @@ static void checkForLowerKeySkip(bool& skipLowerKey,
 	}
 }
 
+namespace
+{
+	// Skip scan support: walks the distinct values of the leading index segment
+	// and makes the scan bounds for every such value by prefixing it to the bounds
+	// of the trailing segments. Used for ascending compound indices only.
+
+	class IndexSkipScan
+	{
+	public:
+		IndexSkipScan(const temporary_key* lower, const temporary_key* upper)
+		{
+			copy_key(lower, &m_lowerTail);
+			m_lowerTail.key_nulls = lower->key_nulls;
+			copy_key(upper, &m_upperTail);
+			m_upperTail.key_nulls = upper->key_nulls;
+
+			// Empty key positions the first lookup at the left side of the index
+			m_seek.key_flags = 0;
+			m_seek.key_nulls = 0;
+			m_seek.key_length = 0;
+		}
+
+		bool getNext(thread_db* tdbb, const IndexRetrieval* retrieval, WIN* window,
+					 temporary_key* lower, temporary_key* upper);
+
+	private:
+		void makeKey(thread_db* tdbb, const IndexRetrieval* retrieval, USHORT length,
+					 const temporary_key& tail, temporary_key* key) const;
+
+		temporary_key m_lowerTail;
+		temporary_key m_upperTail;
+		temporary_key m_seek;
+		UCHAR m_value[MAX_KEY + 1];
+	};
+
+	bool IndexSkipScan::getNext(thread_db* tdbb, const IndexRetrieval* retrieval, WIN* window,
+								temporary_key* lower, temporary_key* upper)
+	{
+		// Find the first node following all keys of the prior leading segment value
+
+		index_desc idx;
+		btree_page* page = BTR_find_page(tdbb, retrieval, window, &idx, &m_seek, nullptr);
+		fb_assert(!(idx.idx_flags & idx_descending) && idx.idx_count > 1);
+
+		UCHAR* pointer;
+		USHORT prefix;
+		while (!(pointer = find_node_start_point(page, &m_seek, m_value, &prefix, false, irb_partial,
+				false, NO_VALUE, get_directory(tdbb, window))))
+		{
+			page = (btree_page*) CCH_HANDOFF(tdbb, window, page->btr_sibling, LCK_read, pag_index);
+		}
+
+		IndexNode node;
+		node.readNode(pointer, true);
+
+		CCH_RELEASE(tdbb, window);
+
+		if (node.isEndLevel)
+			return false;
+
+		// Leading segment is stored as chunks marked with the highest segment number.
+		// Its last chunk is not padded if all trailing segments are NULLs, so pad it here
+		// to be comparable with keys having the trailing segments.
+
+		const USHORT keyLength = node.prefix + node.length;
+		const UCHAR marker = (UCHAR) idx.idx_count;
+
+		USHORT length = 0;
+		while (length < keyLength && m_value[length] == marker)
+			length += STUFF_COUNT + 1;
+
+		for (USHORT i = keyLength; i < length; i++)
+			m_value[i] = 0;
+
+		makeKey(tdbb, retrieval, length, m_lowerTail, lower);
+		makeKey(tdbb, retrieval, length, m_upperTail, upper);
+
+		// Keys having the same leading value are followed by either the end of key or
+		// the lower segment markers, so the next leading value is not less than this one
+
+		memcpy(m_seek.key_data, m_value, length);
+		m_seek.key_data[length] = marker;
+		m_seek.key_length = length + 1;
+
+		return true;
+	}
+
+	void IndexSkipScan::makeKey(thread_db* tdbb, const IndexRetrieval* retrieval, USHORT length,
+								const temporary_key& tail, temporary_key* key) const
+	{
+		const auto dbb = tdbb->getDatabase();
+
+		if (length + tail.key_length >= dbb->getMaxIndexKeyLength())
+		{
+			index_desc temp_idx = retrieval->irb_desc; // to avoid constness issues
+			IndexErrorContext context(retrieval->getRelation(tdbb), &temp_idx);
+			context.raise(tdbb, idx_e_keytoobig);
+		}
+
+		memcpy(key->key_data, m_value, length);
+		memcpy(key->key_data + length, tail.key_data, tail.key_length);
+		key->key_length = length + tail.key_length;
+		key->key_flags = tail.key_flags;
+		key->key_nulls = tail.key_nulls;
+	}
+} // namespace
+
 void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap** bitmap,
 				  RecordBitmap* bitmap_and)
 {
@@ -1581,6 +2078,20 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 	if (!BTR_make_bounds(tdbb, retrieval, iterator, lower, upper, forceInclFlag))
 		return;
 
+	// For a skip scan, the bounds made above cover the trailing segments only
+
+	AutoPtr<IndexSkipScan> skipScan;
+
+	if (retrieval->irb_generic & irb_skip_scan)
+	{
+		fb_assert(!iterator && !lower->key_next && !upper->key_next);
+
+		skipScan = FB_NEW_POOL(*tdbb->getDefaultPool()) IndexSkipScan(lower, upper);
+
+		if (!skipScan->getNext(tdbb, retrieval, &window, lower, upper))
+			return;
+	}
+
 	index_desc idx;
 	btree_page* page = nullptr;
 
@@ -1602,7 +2113,8 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 		if (retrieval->irb_lower_count)
 		{
 			while (!(pointer = find_node_start_point(page, lower, nullptr, &prefix,
-				descending, (retrieval->irb_generic & (irb_starting | irb_partial)))))
+				descending, (retrieval->irb_generic & (irb_starting | irb_partial)),
+				false, NO_VALUE, get_directory(tdbb, &window))))
 			{
 				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
 			}
@@ -1637,6 +2149,9 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 				page = (btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
 				pointer = page->btr_nodes + page->btr_jump_size;
 				prefix = 0;
+
+				if (page->btr_sibling)
+					CCH_read_ahead(tdbb, window.win_page.getPageSpaceID(), &page->btr_sibling, 1);
 			}
 		}
 		else
@@ -1691,6 +2206,9 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 				pointer = page->btr_nodes + page->btr_jump_size;
 				pointer = node.readNode(pointer, true);
 
+				if (page->btr_sibling)
+					CCH_read_ahead(tdbb, window.win_page.getPageSpaceID(), &page->btr_sibling, 1);
+
 				// Check if pointer is still valid
 				if (pointer > endPointer)
 					BUGCHECK(204);	// msg 204 index inconsistent
@@ -1705,7 +2223,7 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 			if (!(retrieval->irb_generic & irb_root_list_scan))
 				continue;
 		}
-		else
+		else if (!skipScan)
 		{
 			lower = lower->key_next.get();
 			upper = upper->key_next.get();
@@ -1714,6 +2232,11 @@ void BTR_evaluate(thread_db* tdbb, const IndexRetrieval* retrieval, RecordBitmap
 		CCH_RELEASE(tdbb, &window);
 		page = nullptr;
 
+		// Switch to the next value of the leading segment
+
+		if (skipScan && !skipScan->getNext(tdbb, retrieval, &window, lower, upper))
+			break;
+
 	} while (lower && upper);
 }
 
@@ -1797,9 +2320,11 @@ btree_page* BTR_find_page(thread_db* tdbb,
 			{
 				const temporary_key* tkey = ignoreNulls ? &firstNotNullKey : lower;
 				const ULONG number = find_page(page, tkey, idx,
-					NO_VALUE, (retrieval->irb_generic & (irb_starting | irb_partial)));
+					NO_VALUE, (retrieval->irb_generic & (irb_starting | irb_partial)),
+					get_directory(tdbb, window));
 				if (number != END_BUCKET)
 				{
+					read_ahead_leaf_pages(tdbb, window, page, idx, retrieval, number, upper);
 					page = (btree_page*) CCH_HANDOFF(tdbb, window, number, LCK_read, pag_index);
 					break;
 				}
@@ -1822,6 +2347,7 @@ btree_page* BTR_find_page(thread_db* tdbb,
 			if (pointer > endPointer)
 				BUGCHECK(204);	// msg 204 index inconsistent
 
+			read_ahead_leaf_pages(tdbb, window, page, idx, retrieval, node.pageNumber, upper);
 			page = (btree_page*) CCH_HANDOFF(tdbb, window, node.pageNumber, LCK_read, pag_index);
 		}
 	}
@@ -2347,9 +2873,12 @@ idx_e BTR_make_key(thread_db* tdbb,
 					return idx_e_keytoobig;
 			}
 
-			const auto desc = EVL_expr(tdbb, request, *exprs++);
+			// Missing expression stands for the leading segment of a skip scan,
+			// it's handled as NULL but not reported as a NULL segment
+			const auto expr = *exprs++;
+			const auto desc = expr ? EVL_expr(tdbb, request, expr) : nullptr;
 
-			if (!desc)
+			if (!desc && expr)
 				key->key_nulls |= 1 << n;
 
 			temp.key_flags |= key_empty;
@@ -2448,6 +2977,33 @@ idx_e BTR_make_key(thread_db* tdbb,
 }
 
 
+void BTR_make_leading_key(thread_db* tdbb, const index_desc* idx, const dsc* desc, SSHORT scale,
+						  temporary_key* key)
+{
+/**************************************
+ *
+ *	B T R _ m a k e _ l e a d i n g _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compress the given value of the leading index
+ *	segment without the compound key markers.
+ *	Used to look up the value distribution histogram.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	fb_assert(idx && desc && key);
+
+	key->key_flags = 0;
+	key->key_nulls = 0;
+
+	compress(tdbb, desc, scale, key, idx->idx_rpt[0].idx_itype, (idx->idx_flags & idx_descending),
+		(idx->idx_flags & idx_unique) ? INTL_KEY_UNIQUE : INTL_KEY_SORT, nullptr);
+}
+
+
 void BTR_make_null_key(thread_db* tdbb, const index_desc* idx, temporary_key* key)
 {
 /**************************************
@@ -3018,44 +3574,507 @@ void BTR_reserve_slot(thread_db* tdbb, IndexCreation& creation, IndexCreateLock&
 			// If this is the second try already, then there really is no more room.
 			if (retry == 2)
 			{
-				CCH_RELEASE(tdbb, &window);
-				ERR_post(Arg::Gds(isc_no_meta_update) <<
-						 Arg::Gds(isc_index_root_page_full));
+				CCH_RELEASE(tdbb, &window);
+				ERR_post(Arg::Gds(isc_no_meta_update) <<
+						 Arg::Gds(isc_index_root_page_full));
+			}
+
+			if (retry == 1)
+				compress_root(tdbb, root);
+		}
+		else
+			break;
+	}
+
+	// If we didn't pick up an empty slot, allocate a new one
+	fb_assert(!use_idx_id || (use_idx_id && slot));
+	if (!slot)
+	{
+		slot = end;
+		root->irt_count++;
+	}
+
+	idx->idx_id = slot - root->irt_rpt;
+	slot->irt_desc = space;
+	fb_assert(idx->idx_count <= MAX_UCHAR);
+	slot->irt_keys = (UCHAR) idx->idx_count;
+	slot->irt_flags = idx->idx_flags;
+	slot->setInProgress(transaction->tra_number);
+
+	// Exploit the fact idx_repeat structure matches ODS IRTD one
+	memcpy(desc, idx->idx_rpt, len);
+
+	// Take creation lock on new index before releasing a window
+	// Will be always taken cause nobody except us knows about this index ID
+	createLock.exclusive(idx->idx_id);
+	CCH_RELEASE(tdbb, &window);
+}
+
+
+namespace
+{
+	// Leaf level statistics collected by BTR_selectivity. Large indices may be
+	// split into ranges of leaf pages scanned by parallel workers, then results
+	// of the ranges are merged in the index order.
+
+	class LeafStatistics
+	{
+	public:
+		LeafStatistics(MemoryPool& pool, ULONG aSegments, bool aDescending, IndexHistogram* aHistogram)
+			: duplicatesList(pool), histogram(aHistogram), segments(aSegments), descending(aDescending)
+		{
+			duplicatesList.resize(segments, 0);
+			key.key_length = firstKey.key_length = 0;
+			key.key_flags = firstKey.key_flags = 0;
+		}
+
+		void scan(thread_db* tdbb, WIN* window, btree_page* bucket, const SortedArray<ULONG>* stopPages);
+		void append(const LeafStatistics& next);
+
+		FB_UINT64 nodes = 0;
+		FB_UINT64 duplicates = 0;
+		HalfStaticArray<FB_UINT64, 4> duplicatesList;
+		IndexHistogram* const histogram;
+
+	private:
+		void countDuplicates(const IndexNode& node, bool pageStart);
+
+		const ULONG segments;
+		const bool descending;
+		temporary_mini_key key;			// last key
+		temporary_mini_key firstKey;
+	};
+
+	void LeafStatistics::scan(thread_db* tdbb, WIN* window, btree_page* bucket,
+							  const SortedArray<ULONG>* stopPages)
+	{
+		// Go through the leaf nodes and count them, also count how many
+		// of them are duplicates. Pages starting other ranges are not scanned.
+
+		UCHAR* pointer = bucket->btr_nodes + bucket->btr_jump_size;
+		IndexNode node;
+
+		while (true)
+		{
+			pointer = node.readNode(pointer, true);
+
+			while (true)
+			{
+				if (node.isEndBucket || (nodes % 100 == 0))
+					JRD_reschedule(tdbb);
+
+				if (node.isEndBucket || node.isEndLevel)
+					break;
+
+				if (nodes)
+					countDuplicates(node, node.nodePointer == bucket->btr_nodes + bucket->btr_jump_size);
+
+				++nodes;
+
+				// keep the key value current for comparison with the next key
+				key.key_length = node.length + node.prefix;
+				memcpy(key.key_data + node.prefix, node.data, node.length);
+
+				if (nodes == 1)
+					copy_key(&key, &firstKey);
+
+				if (histogram)
+				{
+					IndexHistogram::Key value;
+					IndexHistogram::makeKey(key.key_data, key.key_length, segments, value);
+					histogram->add(value);
+				}
+
+				pointer = node.readNode(pointer, true);
+			}
+
+			const ULONG page = bucket->btr_sibling;
+
+			if (node.isEndLevel || !page || (stopPages && stopPages->exist(page)))
+				break;
+
+			bucket = (btree_page*) CCH_HANDOFF_TAIL(tdbb, window, page, LCK_read, pag_index);
+			pointer = bucket->btr_nodes + bucket->btr_jump_size;
+		}
+
+		CCH_RELEASE_TAIL(tdbb, window);
+	}
+
+	void LeafStatistics::append(const LeafStatistics& next)
+	{
+		if (!next.nodes)
+			return;
+
+		if (nodes)
+		{
+			// The first key of the next range is compared with our last key
+			// the same way as the first node of a page
+
+			IndexNode node;
+			node.prefix = 0;
+			node.length = next.firstKey.key_length;
+			node.data = const_cast<UCHAR*>(next.firstKey.key_data);
+
+			countDuplicates(node, true);
+		}
+		else
+			copy_key(&next.firstKey, &firstKey);
+
+		nodes += next.nodes;
+		duplicates += next.duplicates;
+
+		for (ULONG i = 0; i < segments; i++)
+			duplicatesList[i] += next.duplicatesList[i];
+
+		copy_key(&next.key, &key);
+
+		if (histogram && next.histogram)
+			histogram->append(*next.histogram);
+	}
+
+	void LeafStatistics::countDuplicates(const IndexNode& node, bool pageStart)
+	{
+		if (segments > 1)
+		{
+			// Initialize variables for segment duplicate check.
+			// count holds the current checking segment (starting by
+			// the maximum segment number to 1).
+			const UCHAR* p1 = key.key_data;
+			const UCHAR* const p1_end = p1 + key.key_length;
+			const UCHAR* p2 = node.data;
+			const UCHAR* const p2_end = p2 + node.length;
+			SSHORT count, stuff_count;
+			if (node.prefix == 0)
+			{
+				count = *p2;
+				stuff_count = 0;
+			}
+			else
+			{
+				const SSHORT pos = node.prefix;
+				// find the segment number were we're starting.
+				const SSHORT i = (pos / (STUFF_COUNT + 1)) * (STUFF_COUNT + 1);
+				if (i == pos)
+				{
+					// We _should_ pick number from data if available
+					count = *p2;
+				}
+				else
+					count = *(p1 + i);
+
+				// update stuff_count to the current position.
+				stuff_count = STUFF_COUNT + 1 - (pos - i);
+				p1 += pos;
+			}
+
+			//Look for duplicates in the segments
+			while ((p1 < p1_end) && (p2 < p2_end))
+			{
+				if (stuff_count == 0)
+				{
+					if (*p1 != *p2)
+					{
+						// We're done
+						break;
+					}
+					count = *p2;
+					p1++;
+					p2++;
+					stuff_count = STUFF_COUNT;
+				}
+
+				if (*p1 != *p2)
+				{
+					//We're done
+					break;
+				}
+
+				p1++;
+				p2++;
+				stuff_count--;
+			}
+
+			// For descending indexes the segment-number is also
+			// complemented, thus reverse it back.
+			// Note: values are complemented per UCHAR base.
+			if (descending)
+				count = (255 - count);
+
+			if ((p1 == p1_end) && (p2 == p2_end))
+				count = 0; // All segments are duplicates
+
+			for (ULONG i = count + 1; i <= segments; i++)
+				duplicatesList[segments - i]++;
+		}
+
+		// figure out if this is a duplicate
+		bool dup;
+		if (pageStart)
+			dup = node.keyEqual(key.key_length, key.key_data);
+		else
+			dup = (!node.length && (node.prefix + node.length == key.key_length));
+
+		if (dup)
+			++duplicates;
+	}
+
+
+	// Scans ranges of the leaf level using parallel workers
+
+	class SelectivityTask final : public Task
+	{
+		struct Range
+		{
+			explicit Range(MemoryPool& pool, ULONG aPage, ULONG aLeftPage, ULONG segments, bool descending,
+						   bool withHistogram)
+				: page(aPage),
+				  leftPage(aLeftPage),
+				  histogram(withHistogram ? FB_NEW_POOL(pool) IndexHistogram(pool) : nullptr),
+				  stats(pool, segments, descending, histogram)
+			{}
+
+			const ULONG page;
+			const ULONG leftPage;		// left sibling of the page when the range was made
+			AutoPtr<IndexHistogram> histogram;
+			LeafStatistics stats;
+		};
+
+		class Item final : public Task::WorkItem
+		{
+		public:
+			explicit Item(SelectivityTask* task)
+				: Task::WorkItem(task)
+			{}
+
+			~Item()
+			{
+				if (m_ownAttach && m_attStable)
+				{
+					FbLocalStatus status;
+					WorkerAttachment::releaseAttachment(&status, m_attStable);
+				}
+			}
+
+			bool init(thread_db* tdbb)
+			{
+				FbStatusVector* const status = tdbb->tdbb_status_vector;
+
+				if (!m_attStable)
+					m_attStable = WorkerAttachment::getAttachment(status, getTask()->m_dbb);
+
+				Attachment* const att = m_attStable ? m_attStable->getHandle() : nullptr;
+
+				if (!att)
+				{
+					if (!status->hasData())
+						Arg::Gds(isc_bad_db_handle).copyTo(status);
+
+					return false;
+				}
+
+				tdbb->setDatabase(att->att_database);
+				tdbb->setAttachment(att);
+
+				return true;
+			}
+
+			SelectivityTask* getTask() const
+			{
+				return static_cast<SelectivityTask*>(m_task);
+			}
+
+			bool m_inuse = false;
+			bool m_ownAttach = true;
+			RefPtr<StableAttachmentPart> m_attStable;
+			FB_SIZE_T m_range = 0;
+		};
+
+	public:
+		SelectivityTask(thread_db* tdbb, MemoryPool& pool, const RelationPermanent* relation,
+						MetaId id, const Array<ULONG>& leafPages, ULONG rangeCount, int workers,
+						ULONG segments, bool descending, bool withHistogram)
+			: m_pool(pool), m_dbb(tdbb->getDatabase()), m_relationId(relation->getId()), m_indexId(id),
+			  m_items(pool), m_ranges(pool), m_stopPages(pool), m_nextRange(0), m_stop(false),
+			  m_changed(false)
+		{
+			// Every range starts at the leaf page following the same number of pages
+
+			for (ULONG i = 0; i < rangeCount; i++)
+			{
+				const FB_SIZE_T pos = (FB_SIZE_T) ((FB_UINT64) i * leafPages.getCount() / rangeCount);
+				const ULONG page = leafPages[pos];
+				const ULONG leftPage = pos ? leafPages[pos - 1] : 0;
+
+				m_ranges.add(FB_NEW_POOL(pool) Range(pool, page, leftPage, segments, descending, withHistogram));
+				m_stopPages.add(page);
+			}
+
+			for (int i = 0; i < workers; i++)
+				m_items.add(FB_NEW_POOL(pool) Item(this));
+
+			m_items[0]->m_ownAttach = false;
+			m_items[0]->m_attStable = tdbb->getAttachment()->getStable();
+		}
+
+		~SelectivityTask()
+		{
+			for (auto item : m_items)
+				delete item;
+
+			for (auto range : m_ranges)
+				delete range;
+		}
+
+		bool handler(WorkItem& _item) override;
+		bool getWorkItem(WorkItem** pItem) override;
+
+		bool getResult(IStatus* status) override
+		{
+			if (status)
+			{
+				status->init();
+				status->setErrors(m_status.getErrors());
+			}
+
+			return m_status.isSuccess();
+		}
+
+		int getMaxWorkers() override
+		{
+			return (int) MIN(m_items.getCount(), m_ranges.getCount());
+		}
+
+		// Leaf level was changed since the ranges were made, they can't be merged
+		bool isChanged() const
+		{
+			return m_changed;
+		}
+
+		void merge(LeafStatistics& stats) const
+		{
+			for (const auto range : m_ranges)
+				stats.append(range->stats);
+		}
+
+	private:
+		void setError(FbStatusVector* status)
+		{
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (m_status.isSuccess())
+				m_status.save(status);
+
+			m_stop = true;
+		}
+
+		MemoryPool& m_pool;
+		Database* const m_dbb;
+		const USHORT m_relationId;
+		const MetaId m_indexId;
+
+		Mutex m_mutex;
+		HalfStaticArray<Item*, 8> m_items;
+		Array<Range*> m_ranges;
+		SortedArray<ULONG> m_stopPages;		// first pages of the ranges
+		StatusHolder m_status;
+		FB_SIZE_T m_nextRange;
+		volatile bool m_stop;
+		volatile bool m_changed;
+	};
+
+	bool SelectivityTask::handler(WorkItem& _item)
+	{
+		Item* const item = static_cast<Item*>(&_item);
+
+		ThreadContextHolder tdbb(nullptr);
+
+		if (!item->init(tdbb))
+		{
+			setError(tdbb->tdbb_status_vector);
+			return false;
+		}
+
+		WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+		try
+		{
+			Range* const range = m_ranges[item->m_range];
+
+			// Leaf pages were collected without latching them. The page could
+			// be released and reused, or pages could be added in front of it
+			// since then. Ranges must follow each other exactly, so check the
+			// page is still the leaf of our index next to the same left sibling,
+			// otherwise the leaf level is scanned serially.
+
+			WIN window(DB_PAGE_SPACE, range->page);
+			window.win_flags = WIN_large_scan;
+			window.win_scans = 1;
+
+			btree_page* const bucket = (btree_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_undefined);
+
+			if (bucket->btr_header.pag_type != pag_index || bucket->btr_relation != m_relationId ||
+				bucket->btr_id != (UCHAR) (m_indexId % 256) || bucket->btr_level != 0 ||
+				bucket->btr_left_sibling != range->leftPage)
+			{
+				CCH_RELEASE_TAIL(tdbb, &window);
+
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+				m_changed = true;
+				m_stop = true;
+
+				return false;
 			}
 
-			if (retry == 1)
-				compress_root(tdbb, root);
+			range->stats.scan(tdbb, &window, bucket, &m_stopPages);
 		}
-		else
-			break;
+		catch (const Exception& ex)
+		{
+			ex.stuffException(tdbb->tdbb_status_vector);
+			setError(tdbb->tdbb_status_vector);
+			return false;
+		}
+
+		return true;
 	}
 
-	// If we didn't pick up an empty slot, allocate a new one
-	fb_assert(!use_idx_id || (use_idx_id && slot));
-	if (!slot)
+	bool SelectivityTask::getWorkItem(WorkItem** pItem)
 	{
-		slot = end;
-		root->irt_count++;
-	}
+		Item* item = static_cast<Item*>(*pItem);
 
-	idx->idx_id = slot - root->irt_rpt;
-	slot->irt_desc = space;
-	fb_assert(idx->idx_count <= MAX_UCHAR);
-	slot->irt_keys = (UCHAR) idx->idx_count;
-	slot->irt_flags = idx->idx_flags;
-	slot->setInProgress(transaction->tra_number);
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
 
-	// Exploit the fact idx_repeat structure matches ODS IRTD one
-	memcpy(desc, idx->idx_rpt, len);
+		if (m_stop || m_nextRange >= m_ranges.getCount())
+		{
+			if (item)
+				item->m_inuse = false;
 
-	// Take creation lock on new index before releasing a window
-	// Will be always taken cause nobody except us knows about this index ID
-	createLock.exclusive(idx->idx_id);
-	CCH_RELEASE(tdbb, &window);
-}
+			return false;
+		}
+
+		if (!item)
+		{
+			for (auto iter : m_items)
+			{
+				if (!iter->m_inuse)
+				{
+					iter->m_inuse = true;
+					*pItem = item = iter;
+					break;
+				}
+			}
+		}
+
+		if (!item)
+			return false;
+
+		item->m_range = m_nextRange++;
+		return true;
+	}
+} // namespace
 
 
-void BTR_selectivity(thread_db* tdbb, Cached::Relation* relation, MetaId id, SelectivityList& selectivity)
+void BTR_selectivity(thread_db* tdbb, Cached::Relation* relation, MetaId id, SelectivityList& selectivity,
+	IndexHistogram* histogram, int workers)
 {
 /**************************************
  *
@@ -3069,6 +4088,12 @@ void BTR_selectivity(thread_db* tdbb, Cached::Relation* relation, MetaId id, Sel
  *	without visiting data pages. Thus the
  *	effects of uncommitted transactions
  *	will be included in the calculation.
+ *	If requested, the distribution of the
+ *	leading segment values is collected
+ *	(for ascending indices only).
+ *	Leaf level of large indices is split
+ *	into ranges scanned by parallel workers,
+ *	if more than one worker is allowed.
  *
  **************************************/
 
@@ -3090,165 +4115,119 @@ void BTR_selectivity(thread_db* tdbb, Cached::Relation* relation, MetaId id, Sel
 	const bool descending = (root->irt_rpt[id].irt_flags & irt_descending);
 	const ULONG segments = root->irt_rpt[id].irt_keys;
 
+	if (descending)
+		histogram = nullptr;
+
 	window.win_flags = WIN_large_scan;
 	window.win_scans = 1;
 	btree_page* bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, page, LCK_read, pag_index);
 
-	// go down the left side of the index to leaf level
-	UCHAR* pointer = bucket->btr_nodes + bucket->btr_jump_size;
-	while (bucket->btr_level)
+	// Workers use their own attachments, so the relation pages must be shared.
+	// Classic in single-user shutdown mode can't create additional worker attachments.
+
+	const Database* const dbb = tdbb->getDatabase();
+
+	if (relPages->rel_pg_space_id != DB_PAGE_SPACE || relation->isTemporary() ||
+		(dbb->isShutdown(shut_mode_single) && !(dbb->dbb_flags & DBB_shared)))
 	{
-		IndexNode pageNode;
-		pageNode.readNode(pointer, false);
-		bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, pageNode.pageNumber, LCK_read, pag_index);
-		pointer = bucket->btr_nodes + bucket->btr_jump_size;
-		page = pageNode.pageNumber;
+		workers = 1;
 	}
 
-	FB_UINT64 nodes = 0;
-	FB_UINT64 duplicates = 0;
-	temporary_key key;
-	key.key_flags = 0;
-	key.key_length = 0;
-	SSHORT l;
-	bool firstNode = true;
+	// go down the left side of the index to leaf level,
+	// or to the level above it to collect leaf pages for parallel scan
+	const UCHAR stopLevel = (workers > 1) ? 1 : 0;
 
-	// SSHORT count, stuff_count, pos, i;
-	HalfStaticArray<FB_UINT64, 4> duplicatesList;
-	duplicatesList.grow(segments);
-	memset(duplicatesList.begin(), 0, segments * sizeof(FB_UINT64));
+	while (bucket->btr_level > stopLevel)
+	{
+		IndexNode pageNode;
+		pageNode.readNode(bucket->btr_nodes + bucket->btr_jump_size, false);
+		bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, pageNode.pageNumber, LCK_read, pag_index);
+	}
 
-	//const Database* dbb = tdbb->getDatabase();
+	LeafStatistics stats(*tdbb->getDefaultPool(), segments, descending, histogram);
 
-	// go through all the leaf nodes and count them;
-	// also count how many of them are duplicates
-	IndexNode node;
-	while (page)
+	if (bucket->btr_level)
 	{
-		pointer = node.readNode(pointer, true);
+		Array<ULONG> leafPages(*tdbb->getDefaultPool());
+		IndexNode pageNode;
+
 		while (true)
 		{
-			if (node.isEndBucket || (nodes % 100 == 0))
-				JRD_reschedule(tdbb);
+			UCHAR* pointer = bucket->btr_nodes + bucket->btr_jump_size;
 
-			if (node.isEndBucket || node.isEndLevel)
-				break;
-
-			++nodes;
-			l = node.length + node.prefix;
-
-			if (segments > 1 && !firstNode)
+			while (true)
 			{
+				pointer = pageNode.readNode(pointer, false);
 
-				// Initialize variables for segment duplicate check.
-				// count holds the current checking segment (starting by
-				// the maximum segment number to 1).
-				const UCHAR* p1 = key.key_data;
-				const UCHAR* const p1_end = p1 + key.key_length;
-				const UCHAR* p2 = node.data;
-				const UCHAR* const p2_end = p2 + node.length;
-				SSHORT count, stuff_count;
-				if (node.prefix == 0)
-				{
-					count = *p2;
-					//pos = 0;
-					stuff_count = 0;
-				}
-				else
-				{
-					const SSHORT pos = node.prefix;
-					// find the segment number were we're starting.
-					const SSHORT i = (pos / (STUFF_COUNT + 1)) * (STUFF_COUNT + 1);
-					if (i == pos)
-					{
-						// We _should_ pick number from data if available
-						count = *p2;
-					}
-					else
-						count = *(p1 + i);
+				if (pageNode.isEndBucket || pageNode.isEndLevel)
+					break;
 
-					// update stuff_count to the current position.
-					stuff_count = STUFF_COUNT + 1 - (pos - i);
-					p1 += pos;
-				}
+				leafPages.add(pageNode.pageNumber);
+			}
 
-				//Look for duplicates in the segments
-				while ((p1 < p1_end) && (p2 < p2_end))
-				{
-					if (stuff_count == 0)
-					{
-						if (*p1 != *p2)
-						{
-							// We're done
-							break;
-						}
-						count = *p2;
-						p1++;
-						p2++;
-						stuff_count = STUFF_COUNT;
-					}
+			if (pageNode.isEndLevel || !bucket->btr_sibling)
+				break;
 
-					if (*p1 != *p2)
-					{
-						//We're done
-						break;
-					}
+			bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, bucket->btr_sibling, LCK_read, pag_index);
+		}
 
-					p1++;
-					p2++;
-					stuff_count--;
-				}
+		const ULONG rangeCount = MIN((ULONG) workers * STATISTICS_RANGES_PER_WORKER,
+			(ULONG) leafPages.getCount() / STATISTICS_RANGE_PAGES);
 
-				// For descending indexes the segment-number is also
-				// complemented, thus reverse it back.
-				// Note: values are complemented per UCHAR base.
-				if (descending)
-					count = (255 - count);
+		if (rangeCount > 1)
+		{
+			CCH_RELEASE(tdbb, &window);
 
-				if ((p1 == p1_end) && (p2 == p2_end))
-					count = 0; // All segments are duplicates
+			SelectivityTask task(tdbb, *tdbb->getDefaultPool(), relation, id, leafPages,
+				rangeCount, workers, segments, descending, histogram != nullptr);
 
-				for (ULONG i = count + 1; i <= segments; i++)
-					duplicatesList[segments - i]++;
+			{
+				Coordinator coord(tdbb->getDefaultPool());
+				EngineCheckout cout(tdbb, FB_FUNCTION);
+
+				coord.runSync(&task);
 			}
 
-			// figure out if this is a duplicate
-			bool dup;
-			if (node.nodePointer == bucket->btr_nodes + bucket->btr_jump_size)
-				dup = node.keyEqual(key.key_length, key.key_data);
-			else
-				dup = (!node.length && (l == key.key_length));
+			FbLocalStatus status;
+			if (!task.getResult(&status))
+				status.raise();
 
-			if (dup && !firstNode)
-				++duplicates;
+			if (!task.isChanged())
+				task.merge(stats);
+			else
+			{
+				// Leftmost leaf page is never released, scan the level from it
 
-			if (firstNode)
-				firstNode = false;
+				window.win_page = leafPages.front();
+				window.win_flags = WIN_large_scan;
+				window.win_scans = 1;
 
-			// keep the key value current for comparison with the next key
-			key.key_length = l;
-			memcpy(key.key_data + node.prefix, node.data, node.length);
-			pointer = node.readNode(pointer, true);
+				bucket = (btree_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_index);
+				stats.scan(tdbb, &window, bucket, nullptr);
+			}
+		}
+		else
+		{
+			bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, leafPages.front(), LCK_read, pag_index);
+			stats.scan(tdbb, &window, bucket, nullptr);
 		}
-
-		if (node.isEndLevel || !(page = bucket->btr_sibling))
-			break;
-
-		bucket = (btree_page*) CCH_HANDOFF_TAIL(tdbb, &window, page, LCK_read, pag_index);
-		pointer = bucket->btr_nodes + bucket->btr_jump_size;
 	}
-
-	CCH_RELEASE_TAIL(tdbb, &window);
+	else
+		stats.scan(tdbb, &window, bucket, nullptr);
 
 	// calculate the selectivity
+	const FB_UINT64 nodes = stats.nodes;
 	selectivity.grow(segments);
 	if (segments > 1)
 	{
 		for (ULONG i = 0; i < segments; i++)
-			selectivity[i] = (float) (nodes ? 1.0 / (float) (nodes - duplicatesList[i]) : 0.0);
+			selectivity[i] = (float) (nodes ? 1.0 / (float) (nodes - stats.duplicatesList[i]) : 0.0);
 	}
 	else
-		selectivity[0] = (float) (nodes ? 1.0 / (float) (nodes - duplicates) : 0.0);
+		selectivity[0] = (float) (nodes ? 1.0 / (float) (nodes - stats.duplicates) : 0.0);
+
+	if (histogram)
+		histogram->finish(selectivity.back());
 
 	// Store the selectivity on the root page
 	window.win_page = relPages->rel_index_root;
@@ -4595,6 +5574,17 @@ static ULONG fast_load(thread_db* tdbb,
 				const RecordNumber lastRecordNumber = previousNode.recordNumber;
 				previousNode.readNode(previousNode.nodePointer, true);
 				previousNode.setEndBucket();
+
+				// The parent needs only the shortest key that still separates
+				// the page from its right sibling
+				USHORT splitKeyLength = leafKey->key_length;
+				if (!descending && previousNode.length > 1 &&
+					previousNode.nodePointer != bucket->btr_nodes + bucket->btr_jump_size)
+				{
+					previousNode.length = 1;
+					splitKeyLength = previousNode.prefix + 1;
+				}
+
 				pointer = previousNode.writeNode(previousNode.nodePointer, true, false);
 				bucket->btr_length = pointer - (UCHAR*) bucket;
 
@@ -4682,6 +5672,7 @@ static ULONG fast_load(thread_db* tdbb,
 
 				// save the first key on page as the page to be propagated
 				copy_key(leafKey, &split_key);
+				split_key.key_length = splitKeyLength;
 
 				// Clear jumplist.
 				IndexJumpNode* walkJumpNode = leafJumpNodes->begin();
@@ -5234,7 +6225,7 @@ static const index_root_page* fetch_root(thread_db* tdbb, WIN* window, const Rel
 
 static UCHAR* find_node_start_point(btree_page* bucket, temporary_key* key, UCHAR* value, USHORT* return_value,
 									bool descending, int retrieval, bool pointer_by_marker,
-									RecordNumber find_record_number)
+									RecordNumber find_record_number, const IndexPageDirectory* directory)
 {
 /**************************************
  *
@@ -5246,9 +6237,34 @@ static UCHAR* find_node_start_point(btree_page* bucket, temporary_key* key, UCHA
  *	Locate and return a pointer to the insertion point.
  *	If the key doesn't belong in this bucket, return NULL.
  *	A flag indicates the index is descending.
+ *	For ascending index the insertion point is the first node
+ *	not less than the key, so the page directory could be used.
  *
  **************************************/
 
+	if (directory && !descending && find_record_number == NO_VALUE)
+	{
+		const FB_SIZE_T pos = directory->findNode(key->key_data, key->key_length);
+
+		// END_BUCKET marker is less than the key, it belongs to the next page
+		if (pos == directory->getCount())
+			return NULL;
+
+		if (return_value)
+			*return_value = pos ? directory->getPrefix(pos - 1, key->key_data, key->key_length) : 0;
+
+		if (value)
+		{
+			const FB_SIZE_T valuePos = (directory->isEndLevel(pos) && pos) ? pos - 1 : pos;
+
+			USHORT length;
+			const UCHAR* const data = directory->getKey(valuePos, length);
+			memcpy(value, data, length);
+		}
+
+		return directory->getNode(bucket, pos);
+	}
+
 	USHORT prefix = 0;
 	const UCHAR* const key_end = key->key_data + key->key_length;
 	bool firstPass = true;
@@ -5604,7 +6620,7 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
 
 static ULONG find_page(btree_page* bucket, const temporary_key* key,
 					   const index_desc* idx, RecordNumber find_record_number,
-					   int retrieval)
+					   int retrieval, const IndexPageDirectory* directory)
 {
 /**************************************
  *
@@ -5632,6 +6648,23 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 	if (validateDuplicates)
 		find_record_number = NO_VALUE;
 
+	// For ascending index the result is the page of the last node less than
+	// the key, so the page directory could be used
+	if (directory && !descending && find_record_number == NO_VALUE && directory->getCount() > 1)
+	{
+		const FB_SIZE_T pos = directory->findNode(key->key_data, key->key_length);
+
+		IndexNode node;
+
+		// If the END_BUCKET marker is less than the key, return it
+		if (pos == directory->getCount())
+			node.readNode(directory->getNode(bucket, pos - 1), leafPage);
+		else
+			node.readNode(directory->getNode(bucket, pos ? pos - 1 : 0), leafPage);
+
+		return node.pageNumber;
+	}
+
 	const UCHAR* const endPointer = (UCHAR*) bucket + bucket->btr_length;
 
 	USHORT prefix = 0;	// last computed prefix against processed node
@@ -5772,7 +6805,7 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 }
 
 
-static contents garbage_collect(thread_db* tdbb, WIN* window, ULONG parent_number)
+static contents garbage_collect(thread_db* tdbb, WIN* window, ULONG parent_number, bool compact)
 {
 /**************************************
  *
@@ -5790,6 +6823,11 @@ static contents garbage_collect(thread_db* tdbb, WIN* window, ULONG parent_numbe
  *	must lock all the pages involved to prevent
  *	such operations while we are garbage collecting.
  *
+ *	When compacting, the page is merged into its
+ *	left sibling regardless of its fill, as long as
+ *	both fit into one page, and the parent page is
+ *	not checked for the garbage collection then.
+ *
  **************************************/
 
 	SET_TDBB(tdbb);
@@ -5961,7 +6999,7 @@ static contents garbage_collect(thread_db* tdbb, WIN* window, ULONG parent_numbe
 	// now refetch the original page and make sure it is still
 	// below the threshold for garbage collection.
 	gc_page = (btree_page*) CCH_FETCH(tdbb, window, LCK_write, pag_index);
-	if (gc_page->btr_length >= GARBAGE_COLLECTION_BELOW_THRESHOLD ||
+	if ((!compact && gc_page->btr_length >= GARBAGE_COLLECTION_BELOW_THRESHOLD) ||
 		!BtrPageGCLock::isPageGCAllowed(tdbb, window->win_page))
 	{
 		CCH_RELEASE(tdbb, &parent_window);
@@ -6249,6 +7287,9 @@ static contents garbage_collect(thread_db* tdbb, WIN* window, ULONG parent_numbe
 	PAG_release_page(tdbb, window->win_page, left_page ? left_window.win_page :
 		right_page ? right_window.win_page : parent_window.win_page);
 
+	if (compact)
+		return contents_above_threshold;
+
 	// if the parent page needs to be garbage collected, that means we need to
 	// re-fetch the parent and check to see whether it is still garbage-collectable;
 	// make sure that the page is still a btree page in this index and in this level--
@@ -6427,6 +7468,64 @@ static void generate_jump_nodes(thread_db* tdbb, btree_page* page,
 }
 
 
+static const IndexPageDirectory* get_directory(thread_db* tdbb, WIN* window)
+{
+/**************************************
+ *
+ *	g e t _ d i r e c t o r y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return the decoded key directory of the fetched b-tree
+ *	page, build it if the page is searched often enough.
+ *	Page being changed by us has no directory, as well as
+ *	page with too long keys.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	BufferDesc* const bdb = window->win_bdb;
+
+	if (!bdb || bdb->ourExclusiveLock())
+		return nullptr;
+
+	if (const auto directory = bdb->bdb_directory.load())
+		return directory;
+
+	// Only one reader builds the directory, the others keep searching linearly
+
+	if (++bdb->bdb_directory_lookups < DIRECTORY_MIN_LOOKUPS ||
+		bdb->bdb_directory_built.exchange(true))
+	{
+		return nullptr;
+	}
+
+	BufferControl* const bcb = bdb->bdb_bcb;
+	const ULONG maxKeySize = bcb->bcb_page_size * DIRECTORY_KEY_FACTOR;
+
+	// Let it be built later, when directories of other pages are released
+
+	if (bcb->bcb_directory_memory + maxKeySize >
+		(FB_UINT64) bcb->bcb_count * bcb->bcb_page_size / DIRECTORY_CACHE_SHARE)
+	{
+		bdb->bdb_directory_built = false;
+		return nullptr;
+	}
+
+	AutoPtr<IndexPageDirectory> directory(FB_NEW_POOL(*bcb->bcb_bufferpool)
+		IndexPageDirectory(*bcb->bcb_bufferpool));
+
+	if (!directory->build((btree_page*) window->win_buffer, maxKeySize))
+		return nullptr;
+
+	bcb->bcb_directory_memory += directory->getMemorySize();
+	bdb->bdb_directory = directory;
+
+	return directory.release();
+}
+
+
 static ULONG insert_node(thread_db* tdbb,
 						 WIN* window,
 						 index_insertion* insertion,
@@ -6963,6 +8062,19 @@ static ULONG insert_node(thread_db* tdbb,
 	// contain info about the first node on the next page. So we don't
 	// overwrite the existing data.
 	node.setEndBucket();
+
+	// Suffix truncation: at the leaf level the end_bucket marker and the key
+	// propagated to the parent are cut down to the first byte that differs
+	// from the last key of this page. Such key still separates both pages
+	// and makes the branch pages smaller. Not done for descending indices
+	// where a shorter key sorts after the longer ones.
+	if (leafPage && !descending && node.length > 1 &&
+		node.nodePointer != newBucket->btr_nodes + jumpersOriginalSize)
+	{
+		node.length = 1;
+		new_key->key_length = node.prefix + 1;
+	}
+
 	pointer = node.writeNode(node.nodePointer, leafPage, false);
 	newBucket->btr_length = pointer - (UCHAR*) newBucket;
 
@@ -7183,6 +8295,71 @@ string print_key(thread_db* tdbb, jrd_rel* relation, index_desc* idx, Record* re
 }
 
 
+static void read_ahead_leaf_pages(thread_db* tdbb, WIN* window, btree_page* page,
+								  const index_desc* idx, const IndexRetrieval* retrieval,
+								  ULONG firstPage, const temporary_key* upper)
+{
+/**************************************
+ *
+ *	r e a d _ a h e a d _ l e a f _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Level 1 page is going to be left for the first leaf page
+ *	of the retrieval. Read ahead the leaf pages of the range
+ *	listed at this page by single request, as sibling pointers
+ *	of the leaf pages give just one page at a time.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	const Database* const dbb = tdbb->getDatabase();
+
+	// Unique lookups and skip scan probes (no upper key) read single leaf page
+
+	if (page->btr_level != 1 || !upper || (retrieval->irb_generic & irb_unique))
+		return;
+
+	ULONG lastPage = END_BUCKET;
+
+	if (retrieval->irb_upper_count)
+	{
+		lastPage = find_page(page, upper, idx, NO_VALUE,
+			(retrieval->irb_generic & (irb_starting | irb_partial)), get_directory(tdbb, window));
+
+		if (lastPage == firstPage)
+			return;
+	}
+
+	const ULONG maxPages = READ_AHEAD_MAX_TRANSFER / dbb->dbb_page_size;
+	HalfStaticArray<ULONG, READ_AHEAD_MAX_PAGES> pages;
+
+	const UCHAR* const endPointer = (UCHAR*) page + page->btr_length;
+	UCHAR* pointer = page->btr_nodes + page->btr_jump_size;
+
+	IndexNode node;
+
+	while (pointer < endPointer && pages.getCount() < maxPages)
+	{
+		pointer = node.readNode(pointer, false);
+
+		if (pointer > endPointer || node.isEndLevel || node.isEndBucket)
+			break;
+
+		if (pages.hasData() || node.pageNumber == firstPage)
+		{
+			pages.add(node.pageNumber);
+
+			if (node.pageNumber == lastPage)
+				break;
+		}
+	}
+
+	if (pages.getCount() > 1)
+		CCH_read_ahead(tdbb, window->win_page.getPageSpaceID(), pages.begin(), pages.getCount());
+}
+
+
 static contents remove_node(thread_db* tdbb, index_insertion* insertion, WIN* window)
 {
 /**************************************
@@ -49,6 +49,7 @@ template <typename T> class vec;
 class Statement;
 struct temporary_key;
 class thread_db;
+class IndexHistogram;
 class BtrPageGCLock;
 class Sort;
 class PartitionedSort;
@@ -212,6 +213,8 @@ struct index_sort_record
 
 inline constexpr int ISR_secondary	= 1;	// Record is secondary version
 inline constexpr int ISR_null		= 2;	// Record consists of NULL values only
+inline constexpr int ISR_null_segment	= 4;	// Key has NULL segment(s), used by bulk insert
+inline constexpr int ISR_empty		= 8;	// Key contains empty data, used by bulk insert
 
 
 
@@ -279,6 +282,7 @@ inline constexpr int irb_exclude_upper	= 64;			// exclude upper bound keys while
 inline constexpr int irb_multi_starting	= 128;			// Use INTL_KEY_MULTI_STARTING
 inline constexpr int irb_root_list_scan	= 256;			// Locate list items from the root
 inline constexpr int irb_unique		= 512;				// Unique match (currently used only for plan output)
+inline constexpr int irb_skip_scan	= 1024;				// Walk distinct values of the leading segment (not matched)
 
 // Force include flags - always include appropriate key while scanning index
 inline constexpr int irb_force_lower	= irb_exclude_lower;
@@ -34,10 +34,13 @@ void	BTR_all(Jrd::thread_db*, Jrd::Cached::Relation*, Jrd::IndexDescList&, Jrd::
 bool	BTR_activate_index(Jrd::thread_db*, Jrd::Cached::Relation*, MetaId);
 bool	BTR_cleanup_index(Jrd::thread_db*, const Jrd::QualifiedName&, Jrd::jrd_tra*, MetaId);
 void	BTR_complement_key(Jrd::temporary_key*);
+void	BTR_compact(Jrd::thread_db*, Jrd::Cached::Relation*, MetaId);
 void	BTR_create(Jrd::thread_db*, Jrd::IndexCreation&, Jrd::SelectivityList&);
 bool	BTR_delete_index(Jrd::thread_db*, Jrd::win*, MetaId, bool);
 bool	BTR_description(Jrd::thread_db*, Jrd::Cached::Relation*, const Ods::index_root_page*, Jrd::index_desc*,
 						MetaId, USHORT flags = 0);
+bool	BTR_decodable(Jrd::thread_db*, Jrd::jrd_rel*, const Jrd::index_desc*);
+bool	BTR_decode_key(Jrd::thread_db*, const Jrd::index_desc*, const UCHAR*, USHORT, Jrd::Record*);
 DSC*	BTR_eval_expression(Jrd::thread_db*, Jrd::index_desc*, Jrd::Record*);
 void	BTR_evaluate(Jrd::thread_db*, const Jrd::IndexRetrieval*, Jrd::RecordBitmap**, Jrd::RecordBitmap*);
 UCHAR*	BTR_find_leaf(Ods::btree_page*, Jrd::temporary_key*, UCHAR*, USHORT*, bool, int);
@@ -51,6 +54,7 @@ bool	BTR_make_bounds(Jrd::thread_db*, const Jrd::IndexRetrieval*, Jrd::IndexScan
 						Jrd::temporary_key*, Jrd::temporary_key*, USHORT&);
 Jrd::idx_e	BTR_make_key(Jrd::thread_db*, USHORT, const Jrd::ValueExprNode* const*, const SSHORT*,
 						 const Jrd::index_desc*, Jrd::temporary_key*, USHORT, bool*);
+void	BTR_make_leading_key(Jrd::thread_db*, const Jrd::index_desc*, const dsc*, SSHORT, Jrd::temporary_key*);
 void	BTR_make_null_key(Jrd::thread_db*, const Jrd::index_desc*, Jrd::temporary_key*);
 void	BTR_mark_index_for_delete(Jrd::thread_db*, Jrd::RelationPermanent*, MetaId, Jrd::win*, Ods::index_root_page*,
 								  TraNumber tran);
@@ -58,7 +62,8 @@ bool	BTR_next_index(Jrd::thread_db*, Jrd::Cached::Relation*, Jrd::jrd_tra*, Jrd:
 					   Jrd::RelationPages* = nullptr);
 void	BTR_remove(Jrd::thread_db*, Jrd::win*, Jrd::index_insertion*);
 void	BTR_reserve_slot(Jrd::thread_db*, Jrd::IndexCreation&, Jrd::IndexCreateLock&);
-void	BTR_selectivity(Jrd::thread_db*, Jrd::Cached::Relation*, MetaId, Jrd::SelectivityList&);
+void	BTR_selectivity(Jrd::thread_db*, Jrd::Cached::Relation*, MetaId, Jrd::SelectivityList&,
+						Jrd::IndexHistogram* = nullptr, int = 1);
 bool	BTR_types_comparable(const dsc& target, const dsc& source);
 Ods::index_root_page* BTR_fetch_root_for_update(const char* from, Jrd::thread_db* tdbb, Jrd::win* window);
 const Ods::index_root_page* BTR_fetch_root(const char* from, Jrd::thread_db* tdbb, Jrd::win* window);
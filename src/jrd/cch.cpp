@@ -36,6 +36,7 @@
 #include "../jrd/ods.h"
 #include "../jrd/os/pio.h"
 #include "../jrd/cch.h"
+#include "../jrd/btn.h"
 #include "iberror.h"
 #include "../jrd/lls.h"
 #include "../jrd/sdw.h"
@@ -138,9 +139,11 @@ static void prefetch_prologue(Prefetch*, SLONG *);
 static void cacheBuffer(Attachment* att, BufferDesc* bdb);
 static void check_precedence(thread_db*, WIN*, PageNumber);
 static void clear_precedence(thread_db*, BufferDesc*);
+static void detach_page(thread_db*, BufferControl*, BufferDesc*);
 static void down_grade(thread_db*, BufferDesc*, int high = 0);
 static bool expand_buffers(thread_db*, ULONG);
-static BufferDesc* get_buffer(thread_db*, const PageNumber, SyncType, int);
+static void forget_buffer(thread_db*, BufferDesc*);
+static BufferDesc* get_buffer(thread_db*, const PageNumber, SyncType, int, bool = true);
 static int get_related(BufferDesc*, PagesArray&, int, const ULONG);
 static ULONG get_prec_walk_mark(BufferControl*);
 static LockState lock_buffer(thread_db*, BufferDesc*, const SSHORT, const SCHAR);
@@ -148,6 +151,9 @@ static ULONG memory_init(thread_db*, BufferControl*, ULONG);
 static void page_validation_error(thread_db*, win*, SSHORT);
 static void purgePrecedence(BufferControl*, BufferDesc*);
 static SSHORT related(BufferDesc*, const BufferDesc*, SSHORT, const ULONG);
+static bool retire_buffer(thread_db*, BufferControl*, BufferDesc*);
+static ULONG reuse_buffers(BufferControl*, ULONG);
+static void shrink_buffers(thread_db*, ULONG);
 static int write_buffer(thread_db*, BufferDesc*, const PageNumber, const bool, FbStatusVector* const,
 	const bool);
 static bool write_page(thread_db*, BufferDesc*, FbStatusVector* const, const bool);
@@ -195,11 +201,30 @@ static void flushAll(thread_db* tdbb, USHORT flush_flag);
 static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count);
 
 static void recentlyUsed(BufferDesc* bdb);
-static void requeueRecentlyUsed(BufferControl* bcb);
+static void requeueRecentlyUsed(BufferLRU* lru);
+static void removeFromLRU(BufferLRU* lru, BufferDesc* bdb);
+static void appendToLRU(BufferLRU* lru, BufferDesc* bdb);
+static void putOnProbation(BufferLRU* lru, BufferDesc* bdb);
 
 
 constexpr ULONG MIN_BUFFER_SEGMENT = 65536;
 
+// Page buffers are allocated in blocks of limited size, block is the unit
+// of memory returned to the pool when the cache is shrunk
+
+constexpr ULONG MAX_BUFFER_SEGMENT = 64 * 1024 * 1024;
+
+// How long to wait for a buffer in use to take it out of the cache, seconds
+
+constexpr int RETIRE_LATCH_WAIT = 10;
+
+// Two queues policy: probation que is preempted first while it holds more than
+// 1/PROBATION_SHARE of the buffers of its LRU, buffer on probation is promoted
+// when referenced after 1/PROBATION_WINDOW of the probation que was read since
+
+constexpr ULONG PROBATION_SHARE = 4;
+constexpr ULONG PROBATION_WINDOW = 4;
+
 // Given pointer a field in the block, find the block
 
 #define BLOCK(fld_ptr, type, fld) (type*)((SCHAR*) fld_ptr - offsetof(type, fld))
@@ -352,14 +377,15 @@ void CCH_clean_page(thread_db* tdbb, PageNumber page)
 	}
 
 	{
-		Sync lruSync(&bcb->bcb_syncLRU, "CCH_release");
+		BufferLRU* const lru = bdb->bdb_lru;
+
+		Sync lruSync(&lru->lru_sync, "CCH_release");
 		lruSync.lock(SYNC_EXCLUSIVE);
 
 		if (bdb->bdb_flags & BDB_lru_chained)
-			requeueRecentlyUsed(bcb);
+			requeueRecentlyUsed(lru);
 
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+		appendToLRU(lru, bdb);
 	}
 
 	bdb->release(tdbb, true);
@@ -680,6 +706,35 @@ bool CCH_expand(thread_db* tdbb, ULONG number)
 }
 
 
+ULONG CCH_resize(thread_db* tdbb, ULONG number)
+{
+/**************************************
+ *
+ *	C C H _ r e s i z e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Grow or shrink the cache to a given number of buffers
+ *	while the database is in use. Buffers in use for too long
+ *	are not taken out of the cache, thus the cache may stay
+ *	bigger than requested. Return the new number of buffers.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	BufferControl* const bcb = tdbb->getDatabase()->dbb_bcb;
+
+	number = MIN(MAX(number, MIN_PAGE_BUFFERS), MAX_PAGE_BUFFERS);
+
+	if (number > bcb->bcb_count)
+		expand_buffers(tdbb, number);
+	else if (number < bcb->bcb_count)
+		shrink_buffers(tdbb, number);
+
+	return bcb->bcb_count;
+}
+
+
 pag* CCH_fake(thread_db* tdbb, WIN* window, int wait)
 {
 /**************************************
@@ -724,6 +779,7 @@ pag* CCH_fake(thread_db* tdbb, WIN* window, int wait)
 		return NULL;			// latch timeout occurred
 
 	fb_assert(bdb->bdb_page == window->win_page);
+	bdb->resetDirectory();
 
 	// If a dirty orphaned page is being reused - better write it first
 	// to clear current precedences and checkpoint state. This would also
@@ -757,7 +813,7 @@ pag* CCH_fake(thread_db* tdbb, WIN* window, int wait)
 	fb_assert((bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) == 0);
 	fb_assert(bdb->bdb_page == window->win_page);
 
-	bdb->bdb_flags &= BDB_lru_chained;	// yes, clear all except BDB_lru_chained
+	bdb->bdb_flags &= (BDB_lru_chained | BDB_probation | BDB_probation_pending);	// yes, clear all except LRU state
 	bdb->bdb_flags |= (BDB_writer | BDB_faked);
 	bdb->bdb_scan_count = 0;
 
@@ -930,6 +986,7 @@ void CCH_fetch_page(thread_db* tdbb, WIN* window, const bool read_shadow)
 
 	pag* page = bdb->bdb_buffer;
 	bdb->bdb_incarnation = ++bcb->bcb_page_incarnation;
+	bdb->resetDirectory();
 
 	const ULONG pageSpaceId = bdb->bdb_page.getPageSpaceID();
 	tdbb->bumpStats(PageStatType::READS, pageSpaceId);
@@ -1112,9 +1169,9 @@ void CCH_forget_page(thread_db* tdbb, WIN* window)
 
 	// remove from LRU list
 	{
-		SyncLockGuard lruSync(&bcb->bcb_syncLRU, SYNC_EXCLUSIVE, FB_FUNCTION);
-		requeueRecentlyUsed(bcb);
-		QUE_DELETE(bdb->bdb_in_use);
+		SyncLockGuard lruSync(&bdb->bdb_lru->lru_sync, SYNC_EXCLUSIVE, FB_FUNCTION);
+		requeueRecentlyUsed(bdb->bdb_lru);
+		removeFromLRU(bdb->bdb_lru, bdb);
 	}
 
 	// remove from hash table and put into empty list
@@ -1176,6 +1233,9 @@ void CCH_fini(thread_db* tdbb)
 				bdb.bdb_lock->~Lock();
 			bdb.~BufferDesc();
 		}
+
+		if (blk.m_buffers)
+			bcb->bcb_bufferpool->deallocate(blk.m_buffers);
 	}
 
 	bcb->bcb_bdbBlocks.clear();
@@ -1614,7 +1674,10 @@ void CCH_init(thread_db* tdbb, ULONG number)
 	bcb->bcb_flags = shared ? BCB_exclusive : 0;
 	//bcb->bcb_flags = BCB_exclusive;	// TODO detect real state using LM
 
-	QUE_INIT(bcb->bcb_in_use);
+	if (NoCaseString(dbb->dbb_config->getPageCachePolicy()) == PageCachePolicy2Q)
+		bcb->bcb_flags |= BCB_two_queues;
+
+	bcb->bcb_lru_count = MIN(BCB_MAX_LRU, MAX(number / BCB_LRU_MIN_BUFFERS, 1));
 	QUE_INIT(bcb->bcb_dirty);
 	bcb->bcb_dirty_count = 0;
 	QUE_INIT(bcb->bcb_empty);
@@ -1736,6 +1799,7 @@ void CCH_mark(thread_db* tdbb, WIN* window, bool mark_system, bool must_write)
 	fb_assert(dbb->dbb_backup_manager->getState() != Ods::hdr_nbak_unknown);
 
 	bdb->bdb_incarnation = ++bcb->bcb_page_incarnation;
+	bdb->resetDirectory();
 
 	// mark the dirty bit vector for this specific transaction,
 	// if it exists; otherwise mark that the system transaction
@@ -2028,6 +2092,157 @@ bool set_diff_page(thread_db* tdbb, BufferDesc* bdb)
 }
 
 
+void CCH_read_ahead(thread_db* tdbb, USHORT pageSpaceId, const ULONG* pages, FB_SIZE_T count)
+{
+/**************************************
+ *
+ *	C C H _ r e a d _ a h e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read ahead pages which are going to be fetched soon by a
+ *	sequential scan. Pages already in cache are skipped. When the
+ *	database file is served by io_uring the remaining pages are read
+ *	into the cache by single batch, otherwise the OS is advised to
+ *	read them into the file system cache.
+ *
+ *	Read-ahead is just a hint: pages which buffers can't be latched
+ *	immediately are skipped, and I/O errors are ignored as the
+ *	regular fetch re-reads the page and reports them.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
+
+	const auto pageSpace = dbb->dbb_page_manager.findPageSpace(pageSpaceId);
+	if (!pageSpace || !pageSpace->file)
+		return;
+
+	HalfStaticArray<ULONG, READ_AHEAD_MAX_PAGES> toRead;
+
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		BufferDesc* bdb;
+		{
+#ifndef HASH_USE_CDS_LIST
+			SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_SHARED, FB_FUNCTION);
+#endif
+			bdb = bcb->bcb_hashTable->find(PageNumber(pageSpaceId, pages[i]));
+		}
+
+		if (!bdb)
+			toRead.add(pages[i]);
+	}
+
+	if (toRead.isEmpty())
+		return;
+
+	jrd_file* const file = pageSpace->file;
+
+	if (toRead.getCount() < 2 || !(file->fil_flags & FIL_io_uring) || !(bcb->bcb_flags & BCB_exclusive))
+	{
+		PIO_advise_read(tdbb, file, toRead.begin(), toRead.getCount());
+		return;
+	}
+
+	// Pages could be read directly from the database file only
+
+	BackupManager::StateReadGuard stateGuard(tdbb);
+
+	if (!pageSpace->isTemporary() && dbb->dbb_backup_manager->getState() != Ods::hdr_nbak_normal)
+	{
+		PIO_advise_read(tdbb, file, toRead.begin(), toRead.getCount());
+		return;
+	}
+
+	class ReadAhead : public CryptoManager::IOCallback
+	{
+	public:
+		ReadAhead(jrd_file* f, BufferDesc* b, bool r)
+			: file(f), bdb(b), read(r)
+		{ }
+
+		bool callback(thread_db* tdbb, FbStatusVector* status, Ods::pag* page)
+		{
+			// The first call should get the page read by the batch,
+			// the crypto manager could ask to read it again later
+
+			if (read)
+				return PIO_read(tdbb, file, bdb, page, status);
+
+			read = true;
+			return true;
+		}
+
+	private:
+		jrd_file* file;
+		BufferDesc* bdb;
+		bool read;
+	};
+
+	HalfStaticArray<BufferDesc*, READ_AHEAD_MAX_PAGES> bdbs;
+	FB_SIZE_T done = 0;
+
+	try
+	{
+		for (const ULONG* page = toRead.begin(); page < toRead.end(); page++)
+		{
+			BufferDesc* const bdb = get_buffer(tdbb, PageNumber(pageSpaceId, *page), SYNC_EXCLUSIVE, 0, false);
+			if (!bdb)
+				continue;
+
+			// Another thread could read the page meanwhile
+
+			if (bdb->bdb_flags & BDB_read_pending)
+				bdbs.add(bdb);
+			else
+				bdb->release(tdbb, true);
+		}
+
+		FbLocalStatus status;
+		const bool batchRead = bdbs.hasData() &&
+			PIO_read_batch(tdbb, file, bdbs.begin(), bdbs.getCount(), &status);
+
+		for (; done < bdbs.getCount(); done++)
+		{
+			BufferDesc* const bdb = bdbs[done];
+
+			if (batchRead)
+			{
+				ReadAhead io(file, bdb, false);
+				if (dbb->dbb_crypto_manager->read(tdbb, &status, bdb->bdb_buffer, &io))
+				{
+					bdb->bdb_incarnation = ++bcb->bcb_page_incarnation;
+					bdb->resetDirectory();
+					tdbb->bumpStats(PageStatType::READS, pageSpaceId);
+
+					bdb->bdb_flags &= ~(BDB_not_valid | BDB_read_pending);
+					bdb->bdb_flags |= BDB_prefetch;
+
+					bdb->release(tdbb, true);
+					continue;
+				}
+			}
+
+			// Page was not read, the buffer must not stay in the cache as read pending
+
+			forget_buffer(tdbb, bdb);
+		}
+	}
+	catch (const Exception&)
+	{
+		// Buffers not processed yet are still latched by us and not read
+
+		for (; done < bdbs.getCount(); done++)
+			forget_buffer(tdbb, bdbs[done]);
+
+		throw;
+	}
+}
+
+
 void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 {
 /**************************************
@@ -2127,17 +2342,18 @@ void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 				if (window->win_flags & WIN_garbage_collector)
 					bdb->bdb_flags &= ~BDB_garbage_collect;
 
-				{ // bcb_syncLRU scope
-					Sync lruSync(&bcb->bcb_syncLRU, "CCH_release");
+				{ // lru_sync scope
+					BufferLRU* const lru = bdb->bdb_lru;
+
+					Sync lruSync(&lru->lru_sync, "CCH_release");
 					lruSync.lock(SYNC_EXCLUSIVE);
 
 					if (bdb->bdb_flags & BDB_lru_chained)
 					{
-						requeueRecentlyUsed(bcb);
+						requeueRecentlyUsed(lru);
 					}
 
-					QUE_DELETE(bdb->bdb_in_use);
-					QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+					appendToLRU(lru, bdb);
 				}
 
 				if ((bcb->bcb_flags & BCB_cache_writer) &&
@@ -2586,6 +2802,9 @@ static void adjust_scan_count(WIN* window, bool mustRead)
 		if (bdb->bdb_flags & BDB_garbage_collect)
 			bdb->bdb_flags &= ~BDB_garbage_collect;
 	}
+
+	if (bdb->bdb_flags & BDB_prefetch)
+		bdb->bdb_flags &= ~BDB_prefetch;
 }
 
 
@@ -3364,6 +3583,62 @@ static void clear_precedence(thread_db* tdbb, BufferDesc* bdb)
 }
 
 
+static void detach_page(thread_db* tdbb, BufferControl* bcb, BufferDesc* bdb)
+{
+/**************************************
+ *
+ *	d e t a c h _ p a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Prepare exclusively latched buffer to be reused for
+ *	another page or to be taken out of the cache: write
+ *	the page, if dirty, and clear its precedence.
+ *
+ **************************************/
+
+	// If the buffer selected is dirty, arrange to have it written.
+
+	if (bdb->bdb_flags & (BDB_dirty | BDB_db_dirty))
+	{
+		const bool write_thru = (bcb->bcb_flags & BCB_exclusive);
+		if (!write_buffer(tdbb, bdb, bdb->bdb_page, write_thru, tdbb->tdbb_status_vector, true))
+		{
+			bdb->release(tdbb, true);
+			CCH_unwind(tdbb, true);
+		}
+	}
+
+	// If the buffer is still in the dirty tree, remove it.
+	// In any case, release any lock it may have.
+
+	removeDirty(bcb, bdb);
+
+	// Cleanup any residual precedence blocks.  Unless something is
+	// screwed up, the only precedence blocks that can still be hanging
+	// around are ones cleared at AST level.
+
+	if (QUE_NOT_EMPTY(bdb->bdb_higher) || QUE_NOT_EMPTY(bdb->bdb_lower))
+	{
+		Sync precSync(&bcb->bcb_syncPrecedence, "get_buffer");
+		precSync.lock(SYNC_EXCLUSIVE);
+
+		while (QUE_NOT_EMPTY(bdb->bdb_higher))
+		{
+			QUE que2 = bdb->bdb_higher.que_forward;
+			Precedence* precedence = BLOCK(que2, Precedence, pre_higher);
+			QUE_DELETE(precedence->pre_higher);
+			QUE_DELETE(precedence->pre_lower);
+			precedence->pre_hi = (BufferDesc*)bcb->bcb_free;
+			bcb->bcb_free = precedence;
+		}
+
+		clear_precedence(tdbb, bdb);
+	}
+}
+
+
 static void down_grade(thread_db* tdbb, BufferDesc* bdb, int high)
 {
 /**************************************
@@ -3591,6 +3866,7 @@ static bool expand_buffers(thread_db* tdbb, ULONG number)
 	if (number <= bcb->bcb_count || number > MAX_PAGE_BUFFERS)
 		return false;
 
+	MutexLockGuard resizeGuard(bcb->bcb_resizeMutex, FB_FUNCTION);
 	SyncLockGuard syncBcb(&bcb->bcb_syncObject, SYNC_EXCLUSIVE, FB_FUNCTION);
 
 	if (number <= bcb->bcb_count)
@@ -3600,8 +3876,11 @@ static bool expand_buffers(thread_db* tdbb, ULONG number)
 	if ((tdbb->getAttachment()->att_flags & ATT_exclusive) || !(bcb->bcb_flags & BCB_exclusive))
 		bcb->bcb_hashTable->resize(number);
 
+	// Buffers taken out of the cache by shrink_buffers() are used first
+
 	SyncLockGuard syncEmpty(&bcb->bcb_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
-	ULONG allocated = memory_init(tdbb, bcb, number - bcb->bcb_count);
+	ULONG allocated = reuse_buffers(bcb, number - bcb->bcb_count);
+	allocated += memory_init(tdbb, bcb, number - bcb->bcb_count - allocated);
 
 	bcb->bcb_count += allocated;
 	bcb->bcb_free_minimum = (SSHORT) MIN(bcb->bcb_count / 4, 128);	// 25% clean page reserve
@@ -3610,6 +3889,56 @@ static bool expand_buffers(thread_db* tdbb, ULONG number)
 }
 
 
+static void forget_buffer(thread_db* tdbb, BufferDesc* bdb)
+{
+/**************************************
+ *
+ *	f o r g e t _ b u f f e r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Buffer latched exclusively by us was assigned to the page
+ *	but the page was not read. Unlink it from the LRU queue and
+ *	hash table and put into the empty list, then release it, so
+ *	nobody finds the page not read. See also CCH_forget_page.
+ *
+ **************************************/
+	BufferControl* const bcb = bdb->bdb_bcb;
+
+	fb_assert(bdb->ourExclusiveLock() && (bdb->bdb_flags & BDB_read_pending));
+
+	{
+		BufferLRU* const lru = bdb->bdb_lru;
+
+		SyncLockGuard lruSync(&lru->lru_sync, SYNC_EXCLUSIVE, FB_FUNCTION);
+		if (bdb->bdb_flags & BDB_lru_chained)
+			requeueRecentlyUsed(lru);
+
+		removeFromLRU(lru, bdb);
+	}
+
+	{
+#ifndef HASH_USE_CDS_LIST
+		SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_EXCLUSIVE, FB_FUNCTION);
+#endif
+		bcb->bcb_hashTable->remove(bdb);
+	}
+
+	{
+		SyncLockGuard syncEmpty(&bcb->bcb_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
+		QUE_INSERT(bcb->bcb_empty, bdb->bdb_que);
+		bcb->bcb_inuse--;
+	}
+
+	// Threads waiting for the latch should see the buffer was reassigned
+
+	bdb->bdb_page = PageNumber(0, 0);
+	bdb->bdb_flags = 0;
+	bdb->release(tdbb, true);
+}
+
+
 static BufferDesc* get_dirty_buffer(thread_db* tdbb)
 {
 	// This code is only used by the background I/O threads:
@@ -3618,82 +3947,85 @@ static BufferDesc* get_dirty_buffer(thread_db* tdbb)
 	SET_TDBB(tdbb);
 	Database* dbb = tdbb->getDatabase();
 	BufferControl* bcb = dbb->dbb_bcb;
-	int walk = bcb->bcb_free_minimum;
-	int chained = walk;
 
-	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
-	lruSync.lock(SYNC_SHARED);
+	// Tail of every LRU queue is walked for its share of the free buffers reserve
 
-	for (QUE que_inst = bcb->bcb_in_use.que_backward;
-		 que_inst != &bcb->bcb_in_use; que_inst = que_inst->que_backward)
+	const int minimum = MAX(bcb->bcb_free_minimum / (int) bcb->bcb_lru_count, 1);
+	bool requeued = false;
+
+	for (ULONG i = 0; i < bcb->bcb_lru_count; i++)
 	{
-		BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
+		BufferLRU* const lru = &bcb->bcb_lru[i];
+		int walk = minimum;
+		int chained = walk;
 
-		if (bdb->bdb_flags & BDB_lru_chained)
-		{
-			if (!--chained)
-				break;
-			continue;
-		}
+		Sync lruSync(&lru->lru_sync, FB_FUNCTION);
+		lruSync.lock(SYNC_SHARED);
 
-		if (bdb->bdb_use_count || (bdb->bdb_flags & BDB_free_pending))
-			continue;
+		// Probation que is preempted first, thus walked first
 
-		if (bdb->bdb_flags & BDB_db_dirty)
+		que* const queues[] = {&lru->lru_probation, &lru->lru_in_use};
+		const FB_SIZE_T first = (bcb->bcb_flags & BCB_two_queues) ? 0 : 1;
+
+		for (FB_SIZE_T q = first; q < FB_NELEM(queues) && walk && chained; q++)
 		{
-			//tdbb->bumpStats(PageStatType::FETCHES); shouldn't it be here?
-			return bdb;
+			que* const lru_que = queues[q];
+
+			for (QUE que_inst = lru_que->que_backward;
+				 que_inst != lru_que; que_inst = que_inst->que_backward)
+			{
+				BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
+
+				if (bdb->bdb_flags & BDB_lru_chained)
+				{
+					if (!--chained)
+						break;
+					continue;
+				}
+
+				if (bdb->bdb_use_count || (bdb->bdb_flags & BDB_free_pending))
+					continue;
+
+				if (bdb->bdb_flags & BDB_db_dirty)
+				{
+					//tdbb->bumpStats(PageStatType::FETCHES); shouldn't it be here?
+					return bdb;
+				}
+
+				if (!--walk)
+					break;
+			}
 		}
 
-		if (!--walk)
-			break;
+		if (!chained)
+		{
+			lruSync.unlock();
+			lruSync.lock(SYNC_EXCLUSIVE);
+			requeueRecentlyUsed(lru);
+			requeued = true;
+		}
 	}
 
-	if (!chained)
-	{
-		lruSync.unlock();
-		lruSync.lock(SYNC_EXCLUSIVE);
-		requeueRecentlyUsed(bcb);
-	}
-	else
+	if (!requeued)
 		bcb->bcb_flags &= ~BCB_free_pending;
 
 	return NULL;
 }
 
 
-static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
+static BufferDesc* get_oldest_in_que(thread_db* tdbb, BufferControl* bcb, que& lru_que, int& walk)
 {
 /**************************************
  * Function description:
- *       Get candidate for preemption
+ *       Walk LRU que from its tail looking for candidate for preemption.
  *       Found page buffer must have SYNC_EXCLUSIVE lock.
  **************************************/
 
-	int walk = bcb->bcb_free_minimum;
-	BufferDesc* bdb = nullptr;
-
-	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
-	if (bcb->bcb_lru_chain.load() != NULL)
-	{
-		lruSync.lock(SYNC_EXCLUSIVE);
-		requeueRecentlyUsed(bcb);
-		lruSync.downgrade(SYNC_SHARED);
-	}
-	else
-		lruSync.lock(SYNC_SHARED);
-
-	for (QUE que_inst = bcb->bcb_in_use.que_backward;
-		 que_inst != &bcb->bcb_in_use;
+	for (QUE que_inst = lru_que.que_backward;
+		 que_inst != &lru_que;
 		 que_inst = que_inst->que_backward)
 	{
-		bdb = nullptr;
-
-		// get the oldest buffer as the least recently used -- note
-		// that since there are no empty buffers this queue cannot be empty
-
-		if (bcb->bcb_in_use.que_forward == &bcb->bcb_in_use)
-			BUGCHECK(213);	// msg 213 insufficient cache size
+		// get the oldest buffer as the least recently used
 
 		BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
 
@@ -3709,71 +4041,87 @@ static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
 			continue;
 		}*/
 
-		bdb = oldest;
-		if (!(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) || !walk)
-			break;
+		if (!(oldest->bdb_flags & (BDB_dirty | BDB_db_dirty)) || !walk)
+			return oldest;
 
 		if (!(bcb->bcb_flags & BCB_cache_writer))
-			break;
+			return oldest;
 
 		bcb->bcb_flags |= BCB_free_pending;
 		if (!(bcb->bcb_flags & BCB_writer_active))
 			bcb->bcb_writer_sem.release();
 
-		bdb->release(tdbb, true);
-		bdb = nullptr;
+		oldest->release(tdbb, true);
 		--walk;
 	}
 
-	lruSync.unlock();
+	return nullptr;
+}
 
-	if (!bdb)
-		return nullptr;
 
-	// If the buffer selected is dirty, arrange to have it written.
+static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
+{
+/**************************************
+ * Function description:
+ *       Get candidate for preemption
+ *       Found page buffer must have SYNC_EXCLUSIVE lock.
+ **************************************/
 
-	if (bdb->bdb_flags & (BDB_dirty | BDB_db_dirty))
+	int walk = bcb->bcb_free_minimum;
+	BufferDesc* bdb = nullptr;
+
+	// Attachments start looking for the candidate from different LRU queues
+	// and go to the next queue if all buffers in the current one are busy
+
+	const ULONG first = bcb->bcb_lru_next++;
+	const ULONG probationLimit = bcb->bcb_count / bcb->bcb_lru_count / PROBATION_SHARE;
+
+	for (ULONG i = 0; i < bcb->bcb_lru_count && !bdb; i++)
 	{
-		const bool write_thru = (bcb->bcb_flags & BCB_exclusive);
-		if (!write_buffer(tdbb, bdb, bdb->bdb_page, write_thru, tdbb->tdbb_status_vector, true))
+		BufferLRU* const lru = &bcb->bcb_lru[(first + i) % bcb->bcb_lru_count];
+
+		Sync lruSync(&lru->lru_sync, FB_FUNCTION);
+		if (lru->lru_chain.load() != NULL)
 		{
-			bdb->release(tdbb, true);
-			CCH_unwind(tdbb, true);
+			lruSync.lock(SYNC_EXCLUSIVE);
+			requeueRecentlyUsed(lru);
+			lruSync.downgrade(SYNC_SHARED);
 		}
-	}
+		else
+			lruSync.lock(SYNC_SHARED);
 
-	// If the buffer is still in the dirty tree, remove it.
-	// In any case, release any lock it may have.
+		if (!(bcb->bcb_flags & BCB_two_queues))
+		{
+			bdb = get_oldest_in_que(tdbb, bcb, lru->lru_in_use, walk);
+			continue;
+		}
 
-	removeDirty(bcb, bdb);
+		// Pages read once are preempted first unless probation que is small enough
+		// to let them stay there for a while
 
-	// Cleanup any residual precedence blocks.  Unless something is
-	// screwed up, the only precedence blocks that can still be hanging
-	// around are ones cleared at AST level.
+		const bool probationFirst = lru->lru_probation_count > probationLimit;
 
-	if (QUE_NOT_EMPTY(bdb->bdb_higher) || QUE_NOT_EMPTY(bdb->bdb_lower))
-	{
-		Sync precSync(&bcb->bcb_syncPrecedence, "get_buffer");
-		precSync.lock(SYNC_EXCLUSIVE);
+		bdb = get_oldest_in_que(tdbb, bcb,
+			probationFirst ? lru->lru_probation : lru->lru_in_use, walk);
 
-		while (QUE_NOT_EMPTY(bdb->bdb_higher))
+		if (!bdb)
 		{
-			QUE que2 = bdb->bdb_higher.que_forward;
-			Precedence* precedence = BLOCK(que2, Precedence, pre_higher);
-			QUE_DELETE(precedence->pre_higher);
-			QUE_DELETE(precedence->pre_lower);
-			precedence->pre_hi = (BufferDesc*)bcb->bcb_free;
-			bcb->bcb_free = precedence;
+			bdb = get_oldest_in_que(tdbb, bcb,
+				probationFirst ? lru->lru_in_use : lru->lru_probation, walk);
 		}
-
-		clear_precedence(tdbb, bdb);
 	}
 
+	if (!bdb)
+		return nullptr;
+
+	detach_page(tdbb, bcb, bdb);
+
 	return bdb;
 }
 
 
-static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType syncType, int wait)
+static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType syncType, int wait,
+	bool fetch)
 {
 /**************************************
  *
@@ -3794,6 +4142,8 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
  *			0 => If the lock can't be acquired immediately,
  *				give up and return 0;
  *			<negative number> => Latch timeout interval in seconds.
+ *	fetch:	false => buffer is taken by read-ahead, it's not counted
+ *				as page fetch.
  *
  * return
  *	BufferDesc pointer if successful.
@@ -3808,6 +4158,16 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 
 	const ULONG pageSpaceId = page.getPageSpaceID();
 
+	// Read-ahead is not a fetch, the page is counted when it's really fetched
+	const auto bumpFetch = [tdbb, pageSpaceId, fetch](PageStatType type)
+	{
+		if (fetch)
+		{
+			tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
+			tdbb->bumpStats(type, pageSpaceId);
+		}
+	};
+
 	if (att && att->att_bdb_cache)
 	{
 		if (BufferDesc* bdb = att->att_bdb_cache->get(page))
@@ -3817,7 +4177,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				if (bdb->bdb_page == page)
 				{
 					recentlyUsed(bdb);
-					tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
+					bumpFetch(PageStatType::CACHE_HITS);
 					return bdb;
 				}
 
@@ -3860,7 +4220,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				if (bdb->bdb_page == page)
 				{
 					recentlyUsed(bdb);
-					tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
+					bumpFetch(PageStatType::CACHE_HITS);
 					cacheBuffer(att, bdb);
 					return bdb;
 				}
@@ -3900,7 +4260,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				{
 					bdb->downgrade(syncType);
 					recentlyUsed(bdb);
-					tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
+					bumpFetch(PageStatType::CACHE_HITS);
 					cacheBuffer(att, bdb);
 					return bdb;
 				}
@@ -3923,7 +4283,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				if (!bdb2)
 				{
 					bdb->bdb_page = page;
-					bdb->bdb_flags &= BDB_lru_chained; // yes, clear all except BDB_lru_chained
+					bdb->bdb_flags &= (BDB_lru_chained | BDB_probation | BDB_probation_pending); // yes, clear all except LRU state
 					bdb->bdb_flags |= BDB_read_pending;
 					bdb->bdb_scan_count = 0;
 					if (bdb->bdb_lock)
@@ -3933,18 +4293,41 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					bcbSync.unlock();
 #endif
 
-					if (!(bdb->bdb_flags & BDB_lru_chained))
+					if (bcb->bcb_flags & BCB_two_queues)
+					{
+						// Page just read is not hot yet, let it prove itself in probation que.
+						// Don't wait for the LRU lock, the next lock holder will do it.
+
+						BufferLRU* const lru = bdb->bdb_lru;
+
+						Sync syncLRU(&lru->lru_sync, FB_FUNCTION);
+						if (syncLRU.lockConditional(SYNC_EXCLUSIVE))
+						{
+							if (bdb->bdb_flags & BDB_lru_chained)
+								requeueRecentlyUsed(lru);
+
+							putOnProbation(lru, bdb);
+						}
+						else
+						{
+							bdb->bdb_flags |= BDB_probation_pending;
+							recentlyUsed(bdb);
+						}
+					}
+					else if (!(bdb->bdb_flags & BDB_lru_chained))
 					{
-						Sync syncLRU(&bcb->bcb_syncLRU, FB_FUNCTION);
+						BufferLRU* const lru = bdb->bdb_lru;
+
+						Sync syncLRU(&lru->lru_sync, FB_FUNCTION);
 						if (syncLRU.lockConditional(SYNC_EXCLUSIVE))
 						{
-							QUE_DELETE(bdb->bdb_in_use);
-							QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+							removeFromLRU(lru, bdb);
+							QUE_INSERT(lru->lru_in_use, bdb->bdb_in_use);
 						}
 						else
 							recentlyUsed(bdb);
 					}
-					tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
+					bumpFetch(PageStatType::CACHE_MISSES);
 					cacheBuffer(att, bdb);
 					return bdb;
 				}
@@ -3962,7 +4345,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					continue;
 				}
 				recentlyUsed(bdb2);
-				tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
+				bumpFetch(PageStatType::CACHE_HITS);
 				cacheBuffer(att, bdb2);
 			}
 			else
@@ -4239,8 +4622,8 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 	const size_t page_size = dbb->dbb_page_size;
 	UCHAR* memory = nullptr;
 	UCHAR* lock_memory = nullptr;
-	const UCHAR* memory_end = nullptr;
 	BufferDesc* tail = nullptr;
+	ULONG left = 0;
 
 	const size_t lock_key_extra = PageNumber::getLockLen() > Lock::KEY_STATIC_SIZE ?
 		PageNumber::getLockLen() - Lock::KEY_STATIC_SIZE : 0;
@@ -4248,20 +4631,26 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 	const size_t lock_size = (bcb->bcb_flags & BCB_exclusive) ? 0 :
 		FB_ALIGN(sizeof(Lock) + lock_key_extra, alignof(Lock));
 
+	const ULONG max_block = MAX(MAX_BUFFER_SEGMENT / page_size, 1);
+
 	while (number)
 	{
-		if (!memory)
+		if (!left)
 		{
-			// Allocate memory block big enough to accommodate BufferDesc's, Lock's and page buffers.
+			// Allocate memory block big enough to accommodate BufferDesc's and Lock's.
+			// Page buffers are allocated separately to be released when all buffers
+			// of the block are taken out of the cache, see shrink_buffers().
 
-			ULONG to_alloc = number;
+			ULONG to_alloc = MIN(number, max_block);
+			UCHAR* page_memory = nullptr;
 
 			while (true)
 			{
-				const size_t memory_size = (sizeof(BufferDesc) + lock_size + page_size) * (to_alloc + 1);
+				const size_t memory_size = (sizeof(BufferDesc) + lock_size) * (to_alloc + 1);
+				const size_t buffers_size = page_size * (to_alloc + 1);
 
 				fb_assert(memory_size > 0);
-				if (memory_size < MIN_BUFFER_SEGMENT)
+				if (memory_size + buffers_size < MIN_BUFFER_SEGMENT)
 				{
 					// Diminishing returns
 					return buffers;
@@ -4269,8 +4658,17 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 
 				try
 				{
-					memory = (UCHAR*) bcb->bcb_bufferpool->allocate(memory_size);
-					memory_end = memory + memory_size;
+					page_memory = (UCHAR*) bcb->bcb_bufferpool->allocate(buffers_size);
+
+					try
+					{
+						memory = (UCHAR*) bcb->bcb_bufferpool->allocate(memory_size);
+					}
+					catch (const Firebird::BadAlloc&)
+					{
+						bcb->bcb_bufferpool->deallocate(page_memory);
+						throw;
+					}
 					break;
 				}
 				catch (Firebird::BadAlloc&)
@@ -4289,23 +4687,22 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 			BufferControl::BDBBlock blk;
 			blk.m_bdbs = tail;
 			blk.m_count = to_alloc;
+			blk.m_buffers = page_memory;
 			bcb->bcb_bdbBlocks.push(blk);
 
+			if (!(bcb->bcb_flags & BCB_exclusive))
+				lock_memory = FB_ALIGN((UCHAR*) (blk.m_bdbs + to_alloc), lock_size);
+
 			// Allocate buffers on an address that is an even multiple
 			// of the page size (rather the physical sector size.) This
 			// is a necessary condition to support raw I/O interfaces.
-			memory = (UCHAR*) (blk.m_bdbs + to_alloc);
-			if (!(bcb->bcb_flags & BCB_exclusive))
-			{
-				lock_memory = FB_ALIGN(memory, lock_size);
-				memory = (UCHAR*) (lock_memory + lock_size * to_alloc);
-			}
-			memory = FB_ALIGN(memory, page_size);
-
-			fb_assert(memory_end >= memory + page_size * to_alloc);
+			memory = FB_ALIGN(page_memory, page_size);
+			left = to_alloc;
 		}
 
-		tail = ::new(tail) BufferDesc(bcb);
+		// Spread buffers among LRU queues evenly
+		BufferLRU* const lru = &bcb->bcb_lru[(bcb->bcb_count + buffers) % bcb->bcb_lru_count];
+		tail = ::new(tail) BufferDesc(bcb, lru);
 
 		if (!(bcb->bcb_flags & BCB_exclusive))
 		{
@@ -4323,30 +4720,7 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 
 		buffers++;				// Allocated buffers
 		number--;				// Remaining buffers
-
-		// Check if memory segment has been exhausted.
-
-		if (memory + page_size > memory_end)
-		{
-			const auto blk = bcb->bcb_bdbBlocks.end() - 1;
-			const BufferDesc* bdb = blk->m_bdbs;
-
-			if (!(bcb->bcb_flags & BCB_exclusive))
-			{
-				// first lock block is after last BufferDesc
-				fb_assert((char*) bdb->bdb_lock >= (char*) tail);
-
-				// first page buffer is after last lock block
-				fb_assert((char*) bdb->bdb_buffer >= (char*) tail[-1].bdb_lock + lock_size);
-			}
-			else
-			{
-				// first page buffer is after last BufferDesc
-				fb_assert((char*) bdb->bdb_buffer >= (char*) tail);
-			}
-
-			memory = nullptr;
-		}
+		left--;					// Remaining buffers in the memory block
 	}
 
 	return buffers;
@@ -4629,6 +5003,208 @@ static SSHORT related(BufferDesc* low, const BufferDesc* high, SSHORT limit, con
 }
 
 
+static bool retire_buffer(thread_db* tdbb, BufferControl* bcb, BufferDesc* bdb)
+{
+/**************************************
+ *
+ *	r e t i r e _ b u f f e r
+ *
+ **************************************
+ *
+ * Functional description
+ *	Take buffer out of the cache: write its page, if dirty,
+ *	and remove the buffer from the hash table and LRU queue
+ *	or from the empty queue. Return false if the buffer is
+ *	in use for too long.
+ *
+ **************************************/
+	while (true)
+	{
+		if (!bdb->addRef(tdbb, SYNC_EXCLUSIVE, -RETIRE_LATCH_WAIT))
+			return false;
+
+		bool hashed;
+		{
+#ifndef HASH_USE_CDS_LIST
+			SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_SHARED, FB_FUNCTION);
+#endif
+			hashed = (bcb->bcb_hashTable->find(bdb->bdb_page) == bdb);
+		}
+
+		if (hashed)
+		{
+			detach_page(tdbb, bcb, bdb);
+
+			if (bdb->bdb_lock)
+				PAGE_LOCK_RELEASE(tdbb, bcb, bdb->bdb_lock);
+
+			{
+				BufferLRU* const lru = bdb->bdb_lru;
+
+				SyncLockGuard lruSync(&lru->lru_sync, SYNC_EXCLUSIVE, FB_FUNCTION);
+				requeueRecentlyUsed(lru);
+				removeFromLRU(lru, bdb);
+				QUE_INIT(bdb->bdb_in_use);
+			}
+
+#ifndef HASH_USE_CDS_LIST
+			{
+				SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_EXCLUSIVE, FB_FUNCTION);
+				bcb->bcb_hashTable->remove(bdb);
+				QUE_INIT(bdb->bdb_que);
+			}
+#else
+			bcb->bcb_hashTable->remove(bdb);
+#endif
+
+			SyncLockGuard syncEmpty(&bcb->bcb_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
+			bcb->bcb_inuse--;
+			break;
+		}
+
+		{
+			SyncLockGuard syncEmpty(&bcb->bcb_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
+
+			if (QUE_NOT_EMPTY(bdb->bdb_que))
+			{
+				QUE_DELETE(bdb->bdb_que);
+				QUE_INIT(bdb->bdb_que);
+				break;
+			}
+		}
+
+		// Buffer was just taken from the empty queue by get_buffer(),
+		// let it be put into the hash table and try again
+
+		bdb->release(tdbb, false);
+		Thread::yield();
+	}
+
+	bdb->bdb_page = PageNumber(0, 0);
+	bdb->bdb_flags = BDB_retired;
+	bdb->resetDirectory();
+	bdb->release(tdbb, false);
+
+	return true;
+}
+
+
+static ULONG reuse_buffers(BufferControl* bcb, ULONG number)
+{
+/**************************************
+ *
+ *	r e u s e _ b u f f e r s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Put buffers taken out of the cache by shrink_buffers()
+ *	back into the empty queue, allocating page buffers of
+ *	their memory block again if necessary.
+ *	Return number of buffers put back.
+ *
+ **************************************/
+	fb_assert(bcb->bcb_syncEmpty.ourExclusiveLock());
+
+	ULONG buffers = 0;
+
+	for (auto& blk : bcb->bcb_bdbBlocks)
+	{
+		for (ULONG i = 0; i < blk.m_count && buffers < number; i++)
+		{
+			BufferDesc* const bdb = &blk.m_bdbs[i];
+
+			if (!(bdb->bdb_flags & BDB_retired))
+				continue;
+
+			if (!blk.m_buffers)
+			{
+				const size_t page_size = bcb->bcb_page_size;
+
+				try
+				{
+					blk.m_buffers = (UCHAR*) bcb->bcb_bufferpool->allocate(page_size * (blk.m_count + 1));
+				}
+				catch (const Firebird::BadAlloc&)
+				{
+					return buffers;
+				}
+
+				UCHAR* memory = FB_ALIGN(blk.m_buffers, page_size);
+				for (ULONG j = 0; j < blk.m_count; j++, memory += page_size)
+					blk.m_bdbs[j].bdb_buffer = (pag*) memory;
+			}
+
+			bdb->bdb_flags &= ~BDB_retired;
+			QUE_INSERT(bcb->bcb_empty, bdb->bdb_que);
+			buffers++;
+		}
+	}
+
+	return buffers;
+}
+
+
+static void shrink_buffers(thread_db* tdbb, ULONG number)
+{
+/**************************************
+ *
+ *	s h r i n k _ b u f f e r s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Take buffers out of the cache until there are given
+ *	number of buffers left. Buffers of the last memory blocks
+ *	go first, page buffers of the block are released when
+ *	all its buffers are taken out.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	BufferControl* const bcb = tdbb->getDatabase()->dbb_bcb;
+
+	MutexLockGuard resizeGuard(bcb->bcb_resizeMutex, FB_FUNCTION);
+
+	// Memory blocks are added by expand_buffers() only, and it waits for us
+
+	for (FB_SIZE_T n = bcb->bcb_bdbBlocks.getCount(); n && number < bcb->bcb_count; n--)
+	{
+		BufferControl::BDBBlock& blk = bcb->bcb_bdbBlocks[n - 1];
+		bool retired = true;
+
+		for (ULONG i = blk.m_count; i--;)
+		{
+			BufferDesc* const bdb = &blk.m_bdbs[i];
+
+			if (bdb->bdb_flags & BDB_retired)
+				continue;
+
+			if (number >= bcb->bcb_count || !retire_buffer(tdbb, bcb, bdb))
+			{
+				retired = false;
+				break;
+			}
+
+			bcb->bcb_count--;
+		}
+
+		if (!retired)
+			break;
+
+		if (blk.m_buffers)
+		{
+			for (ULONG i = 0; i < blk.m_count; i++)
+				blk.m_bdbs[i].bdb_buffer = nullptr;
+
+			bcb->bcb_bufferpool->deallocate(blk.m_buffers);
+			blk.m_buffers = nullptr;
+		}
+	}
+
+	bcb->bcb_free_minimum = (SSHORT) MIN(bcb->bcb_count / 4, 128);	// 25% clean page reserve
+}
+
+
 #ifdef NOT_USED_OR_REPLACED
 static inline bool writeable(BufferDesc* bdb)
 {
@@ -5106,10 +5682,10 @@ void recentlyUsed(BufferDesc* bdb)
 	if (oldFlags & BDB_lru_chained)
 		return;
 
-	BufferControl* bcb = bdb->bdb_bcb;
+	BufferLRU* const lru = bdb->bdb_lru;
 
 #ifdef DEV_BUILD
-	volatile BufferDesc* chain = bcb->bcb_lru_chain;
+	volatile BufferDesc* chain = lru->lru_chain;
 	for (; chain; chain = chain->bdb_lru_chain)
 	{
 		if (chain == bdb)
@@ -5118,14 +5694,14 @@ void recentlyUsed(BufferDesc* bdb)
 #endif
 	for (;;)
 	{
-		bdb->bdb_lru_chain = bcb->bcb_lru_chain;
-		if (bcb->bcb_lru_chain.compare_exchange_strong(bdb->bdb_lru_chain, bdb))
+		bdb->bdb_lru_chain = lru->lru_chain;
+		if (lru->lru_chain.compare_exchange_strong(bdb->bdb_lru_chain, bdb))
 			break;
 	}
 }
 
 
-void requeueRecentlyUsed(BufferControl* bcb)
+void requeueRecentlyUsed(BufferLRU* lru)
 {
 	BufferDesc* chain = NULL;
 
@@ -5133,8 +5709,8 @@ void requeueRecentlyUsed(BufferControl* bcb)
 
 	for (;;)
 	{
-		chain = bcb->bcb_lru_chain;
-		if (bcb->bcb_lru_chain.compare_exchange_strong(chain, NULL))
+		chain = lru->lru_chain;
+		if (lru->lru_chain.compare_exchange_strong(chain, NULL))
 			break;
 	}
 
@@ -5153,17 +5729,67 @@ void requeueRecentlyUsed(BufferControl* bcb)
 		reversed = bdb;
 	}
 
+	// Buffer on probation is promoted only if it was referenced again after some
+	// other pages were read, repeated references right after the read (e.g. when
+	// all records of the page are fetched by a scan) are not counted
+
+	const ULONG window = MAX(lru->lru_probation_count / PROBATION_WINDOW, 1);
+
 	while ((bdb = reversed) != NULL)
 	{
 		reversed = bdb->bdb_lru_chain;
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+
+		if (bdb->bdb_flags & BDB_probation_pending)
+			putOnProbation(lru, bdb);
+		else if (!(bdb->bdb_flags & BDB_probation) || lru->lru_stamp - bdb->bdb_lru_stamp >= window)
+		{
+			removeFromLRU(lru, bdb);
+			QUE_INSERT(lru->lru_in_use, bdb->bdb_in_use);
+		}
 
 		bdb->bdb_lru_chain = NULL;
-		bdb->bdb_flags &= ~BDB_lru_chained;
+		bdb->bdb_flags &= ~(BDB_lru_chained | BDB_probation_pending);
 	}
 
-	chain = bcb->bcb_lru_chain;
+	chain = lru->lru_chain;
+}
+
+
+void removeFromLRU(BufferLRU* lru, BufferDesc* bdb)
+{
+	QUE_DELETE(bdb->bdb_in_use);
+
+	if (bdb->bdb_flags & BDB_probation)
+	{
+		fb_assert(lru->lru_probation_count > 0);
+
+		bdb->bdb_flags &= ~BDB_probation;
+		lru->lru_probation_count--;
+	}
+}
+
+
+void appendToLRU(BufferLRU* lru, BufferDesc* bdb)
+{
+	// Make the buffer first candidate for preemption in the que it belongs to
+
+	QUE_DELETE(bdb->bdb_in_use);
+
+	if (bdb->bdb_flags & BDB_probation)
+		QUE_APPEND(lru->lru_probation, bdb->bdb_in_use);
+	else
+		QUE_APPEND(lru->lru_in_use, bdb->bdb_in_use);
+}
+
+
+void putOnProbation(BufferLRU* lru, BufferDesc* bdb)
+{
+	removeFromLRU(lru, bdb);
+	QUE_INSERT(lru->lru_probation, bdb->bdb_in_use);
+
+	bdb->bdb_flags |= BDB_probation;
+	bdb->bdb_lru_stamp = ++lru->lru_stamp;
+	lru->lru_probation_count++;
 }
 
 
@@ -5304,6 +5930,28 @@ void BufferDesc::unLockIO(thread_db* tdbb)
 }
 
 
+void BufferDesc::resetDirectory()
+{
+	// Readers use the directory under shared latch only, so it's safe
+	// to delete it while the page is latched exclusively or not yet valid
+
+	if (const auto directory = bdb_directory.exchange(nullptr))
+	{
+		bdb_bcb->bcb_directory_memory -= directory->getMemorySize();
+		delete directory;
+	}
+
+	bdb_directory_lookups = 0;
+	bdb_directory_built = false;
+}
+
+
+BufferDesc::~BufferDesc()
+{
+	resetDirectory();
+}
+
+
 namespace Jrd {
 
 /// class BCBHashTable
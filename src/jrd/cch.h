@@ -63,6 +63,7 @@ struct que;
 class BufferDesc;
 class Database;
 class BCBHashTable;
+class IndexPageDirectory;
 
 // Page buffer cache size constraints.
 
@@ -73,6 +74,41 @@ inline constexpr ULONG MAX_PAGE_BUFFERS = 131072;
 inline constexpr ULONG MAX_PAGE_BUFFERS = MAX_SLONG - 1;
 #endif
 
+// Page buffers are spread among several LRU queues to let concurrent
+// attachments requeue and preempt buffers without a single point of contention
+
+inline constexpr ULONG BCB_MAX_LRU = 16;			// max number of LRU queues
+inline constexpr ULONG BCB_LRU_MIN_BUFFERS = 256;	// min number of buffers per LRU queue
+
+class BufferLRU
+{
+public:
+	BufferLRU()
+		: lru_probation_count(0),
+		  lru_stamp(0),
+		  lru_chain(nullptr)
+	{
+		QUE_INIT(lru_in_use);
+		QUE_INIT(lru_probation);
+	}
+
+	que			lru_in_use;			// Que of buffers in use, LRU order
+
+	// Two queues policy: buffers just read are put into the probation FIFO que and
+	// go to lru_in_use only when referenced again after other pages were read, so
+	// pages touched once by a big scan don't push frequently used pages out
+	que			lru_probation;		// Que of buffers referenced once, FIFO order
+	ULONG		lru_probation_count;	// Number of buffers in lru_probation
+	ULONG		lru_stamp;			// Count of buffers put into lru_probation
+
+	// Recently used buffer put there without locking LRU que (lru_in_use).
+	// When lru_sync is locked this chain is merged into lru_in_use. See also
+	// requeueRecentlyUsed() and recentlyUsed()
+	std::atomic<BufferDesc*>	lru_chain;
+
+	Firebird::SyncObject	lru_sync;
+};
+
 // BufferControl -- Buffer control block -- one per system
 
 class BufferControl : public pool_alloc<type_bcb>
@@ -85,7 +121,8 @@ class BufferControl : public pool_alloc<type_bcb>
 		  bcb_bdbBlocks(p)
 	{
 		bcb_database = NULL;
-		QUE_INIT(bcb_in_use);
+		bcb_lru_count = 1;
+		bcb_lru_next = 0;
 		QUE_INIT(bcb_pending);
 		QUE_INIT(bcb_empty);
 		QUE_INIT(bcb_dirty);
@@ -99,6 +136,7 @@ class BufferControl : public pool_alloc<type_bcb>
 		bcb_page_size = 0;
 		bcb_page_incarnation = 0;
 		bcb_hashTable = nullptr;
+		bcb_directory_memory = 0;
 #ifdef SUPERSERVER_V2
 		bcb_prefetch = NULL;
 #endif
@@ -115,15 +153,13 @@ public:
 	Firebird::MemoryStats bcb_memory_stats;
 
 	UCharStack	bcb_memory;			// Large block partitioned into buffers
-	que			bcb_in_use;			// Que of buffers in use, main LRU que
+	BufferLRU	bcb_lru[BCB_MAX_LRU];	// LRU queues of buffers in use
+	ULONG		bcb_lru_count;		// Number of LRU queues used
+	std::atomic<ULONG>	bcb_lru_next;	// LRU queue to look for preemption candidate first
+
 	que			bcb_pending;		// Que of buffers which are going to be freed and reassigned
 	que			bcb_empty;			// Que of empty buffers
 
-	// Recently used buffer put there without locking common LRU que (bcb_in_use).
-	// When bcb_syncLRU is locked this chain is merged into bcb_in_use. See also
-	// requeueRecentlyUsed() and recentlyUsed()
-	std::atomic<BufferDesc*>	bcb_lru_chain;
-
 	que			bcb_dirty;			// que of dirty buffers
 	SLONG		bcb_dirty_count;	// count of pages in dirty page btree
 
@@ -140,11 +176,13 @@ public:
 	Firebird::SyncObject	bcb_syncDirtyBdbs;
 	Firebird::SyncObject	bcb_syncEmpty;
 	Firebird::SyncObject	bcb_syncPrecedence;
-	Firebird::SyncObject	bcb_syncLRU;
 
 	// If we make bcb_flags atomic this mutex will become unneeded: XCHG of bcb_flags is enough
 	Firebird::Mutex			bcb_threadStartup;
 
+	// Serializes growing and shrinking of the cache while database is in use
+	Firebird::Mutex			bcb_resizeMutex;
+
 	typedef ThreadFinishSync<BufferControl*> BcbThreadSync;
 
 	static void cache_writer(BufferControl* bcb);
@@ -164,12 +202,14 @@ public:
 	void exceptionHandler(const Firebird::Exception& ex, BcbThreadSync::ThreadRoutine* routine);
 
 	BCBHashTable* bcb_hashTable;
+	std::atomic<FB_UINT64> bcb_directory_memory;	// Memory used by b-tree page directories
 
-	// block of allocated BufferDesc's
+	// block of allocated BufferDesc's and their page buffers
 	struct BDBBlock
 	{
 		BufferDesc* m_bdbs;
 		ULONG m_count;
+		UCHAR* m_buffers;	// memory of page buffers, released when all BufferDesc's are retired
 	};
 	Firebird::Array<BDBBlock>	bcb_bdbBlocks;		// all allocated BufferDesc's
 };
@@ -184,6 +224,7 @@ inline constexpr int BCB_reader_active	= 32;	// cache reader not blocked on even
 #endif
 inline constexpr int BCB_free_pending	= 64;	// request cache writer to free pages
 inline constexpr int BCB_exclusive		= 128;	// there is only BCB in whole system
+inline constexpr int BCB_two_queues		= 256;	// scan resistant two queues replacement policy
 
 
 // BufferDesc -- Buffer descriptor block
@@ -191,8 +232,9 @@ inline constexpr int BCB_exclusive		= 128;	// there is only BCB in whole system
 class BufferDesc : public pool_alloc<type_bdb>
 {
 public:
-	explicit BufferDesc(BufferControl* bcb)
+	explicit BufferDesc(BufferControl* bcb, BufferLRU* lru = nullptr)
 		: bdb_bcb(bcb),
+		  bdb_lru(lru),
 		  bdb_page(0, 0)
 	{
 		bdb_lock = NULL;
@@ -200,6 +242,7 @@ public:
 		QUE_INIT(bdb_in_use);
 		QUE_INIT(bdb_dirty);
 		bdb_lru_chain = NULL;
+		bdb_lru_stamp = 0;
 		bdb_buffer = NULL;
 		bdb_incarnation = 0;
 		bdb_transactions = 0;
@@ -213,8 +256,12 @@ public:
 		bdb_scan_count = 0;
 		bdb_difference_page = 0;
 		bdb_prec_walk_mark = 0;
+		bdb_directory = nullptr;
+		bdb_directory_built = false;
 	}
 
+	~BufferDesc();
+
 	bool addRef(thread_db* tdbb, Firebird::SyncType syncType, int wait = 1);
 	bool addRefConditional(thread_db* tdbb, Firebird::SyncType syncType);
 	void downgrade(Firebird::SyncType syncType);
@@ -223,6 +270,9 @@ public:
 	void lockIO(thread_db*);
 	void unLockIO(thread_db*);
 
+	// Drop decoded b-tree page directory when page contents is changed or replaced
+	void resetDirectory();
+
 	bool isLocked() const
 	{
 		return bdb_syncPage.isLocked();
@@ -239,12 +289,14 @@ public:
 	}
 
 	BufferControl*	bdb_bcb;
+	BufferLRU*	bdb_lru;				// LRU queue the buffer belongs to
 	Firebird::SyncObject	bdb_syncPage;
 	Lock*		bdb_lock;				// Lock block for buffer
 	que			bdb_que;				// Either mod que in hash table or bcb_empty que if never used
-	que			bdb_in_use;				// queue of buffers in use
+	que			bdb_in_use;				// LRU queue of buffers in use
 	que			bdb_dirty;				// dirty pages LRU queue
 	BufferDesc*	bdb_lru_chain;			// pending LRU chain
+	ULONG		bdb_lru_stamp;			// lru_stamp when buffer was put into probation que
 	Ods::pag*	bdb_buffer;				// Actual buffer
 	PageNumber	bdb_page;				// Database page number in buffer
 	ULONG		bdb_incarnation;
@@ -267,6 +319,12 @@ public:
 	Firebird::AtomicCounter	bdb_scan_count;		// concurrent sequential scans
 	ULONG       bdb_difference_page;			// Number of page in difference file, NBAK
 	ULONG		bdb_prec_walk_mark;				// mark value used in precedence graph walk
+
+	// Decoded b-tree page nodes, built by readers and reset by the page
+	// modification, so it's valid while the page is latched, see btn.h
+	std::atomic<IndexPageDirectory*>	bdb_directory;
+	Firebird::AtomicCounter	bdb_directory_lookups;	// page searches since the last reset
+	std::atomic<bool>	bdb_directory_built;	// directory was built, or found too large, since the last reset
 };
 
 // bdb_flags
@@ -291,6 +349,9 @@ inline constexpr int BDB_prefetch			= 0x4000;	// page has been prefetched but no
 inline constexpr int BDB_no_blocking_ast	= 0x8000;	// No blocking AST registered with page lock
 inline constexpr int BDB_lru_chained		= 0x10000;	// buffer is in pending LRU chain
 inline constexpr int BDB_nbak_state_lock	= 0x20000;	// nbak state lock should be released after buffer is written
+inline constexpr int BDB_probation			= 0x40000;	// buffer is in probation LRU que
+inline constexpr int BDB_probation_pending	= 0x80000;	// buffer is to be put on probation by pending LRU chain
+inline constexpr int BDB_retired			= 0x100000;	// buffer is taken out of the cache by CCH_resize
 
 // bdb_ast_flags
 
@@ -377,6 +438,11 @@ public:
 inline constexpr int PRF_active = 1;		// prefetch block currently in use
 #endif // SUPERSERVER_V2
 
+// Maximum amount of data read ahead of a sequential scan by single request (bytes)
+inline constexpr ULONG READ_AHEAD_MAX_TRANSFER	= 256 * 1024;
+// Maximum pages read ahead by single request
+inline constexpr ULONG READ_AHEAD_MAX_PAGES		= READ_AHEAD_MAX_TRANSFER / MIN_PAGE_SIZE;
+
 typedef Firebird::SortedArray<SLONG, Firebird::InlineStorage<SLONG, 256>, SLONG> PagesArray;
 
 
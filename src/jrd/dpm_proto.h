@@ -56,6 +56,7 @@ namespace Ods
 }
 
 Ods::pag* DPM_allocate(Jrd::thread_db*, Jrd::win*);
+bool	DPM_all_visible(Jrd::thread_db*, Jrd::record_param*);
 void	DPM_backout(Jrd::thread_db*, Jrd::record_param*);
 void	DPM_backout_mark(Jrd::thread_db*, Jrd::record_param*, const Jrd::jrd_tra*);
 double	DPM_cardinality(Jrd::thread_db*, Jrd::jrd_rel*, const Jrd::Format*);
@@ -78,9 +79,11 @@ void	DPM_pages(Jrd::thread_db*, SSHORT, int, ULONG, ULONG);
 SLONG	DPM_prefetch_bitmap(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::PageBitmap*, SLONG);
 #endif
 ULONG	DPM_pointer_pages(Jrd::thread_db*, Jrd::jrd_rel*);
+void	DPM_read_ahead(Jrd::thread_db*, Jrd::record_param*, const ULONG*, FB_SIZE_T);
 void	DPM_scan_pages(Jrd::thread_db*);
 void	DPM_store(Jrd::thread_db*, Jrd::record_param*, Jrd::PageStack&, const Jrd::RecordStorageType type);
 RecordNumber DPM_store_blob(Jrd::thread_db*, Jrd::blb*, Jrd::jrd_rel*, Jrd::Record*);
+void	DPM_reset_all_visible(Jrd::thread_db*, Jrd::record_param*);
 void	DPM_rewrite_header(Jrd::thread_db*, Jrd::record_param*);
 void	DPM_scan_marker(Jrd::thread_db*, MetaId);
 void	DPM_update(Jrd::thread_db*, Jrd::record_param*, Jrd::PageStack*, const Jrd::jrd_tra*);
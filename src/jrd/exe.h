@@ -126,6 +126,7 @@ inline constexpr int csb_unmatched		= 512;		// stream has conjuncts unmatched by
 inline constexpr int csb_update			= 1024;		// erase or modify for relation
 inline constexpr int csb_unstable		= 2048;		// unstable explicit cursor
 inline constexpr int csb_skip_locked	= 4096;		// skip locked record
+inline constexpr int csb_record_version	= 8192;		// record version (transaction number) is referenced
 
 
 // Aggregate Sort Block (for DISTINCT aggregates)
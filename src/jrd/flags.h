@@ -42,6 +42,7 @@ inline constexpr USHORT FILE_backing_up		= 64;
 // flags for RDB$RELATIONS
 
 inline constexpr USHORT REL_sql			= 0x0001;
+inline constexpr USHORT REL_compressed	= 0x0002;		// records are block compressed
 
 // flags for RDB$TRIGGERS
 
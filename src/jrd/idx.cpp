@@ -206,6 +206,25 @@ bool IDX_check_master_types(thread_db* tdbb, index_desc& idx, Cached::Relation*
 }
 
 
+void IDX_compact(thread_db* tdbb, Cached::Relation* relation, MetaId id)
+{
+/**************************************
+ *
+ *	I D X _ c o m p a c t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Merge sparse index pages online.
+ *
+ **************************************/
+
+	SET_TDBB(tdbb);
+
+	BTR_compact(tdbb, relation, id);
+}
+
+
 namespace Jrd {
 
 class IndexCreateTask : public Task
@@ -1503,7 +1522,8 @@ void IDX_modify_flag_uk_modified(thread_db* tdbb,
 }
 
 
-void IDX_statistics(thread_db* tdbb, Cached::Relation* relation, USHORT id, SelectivityList& selectivity)
+void IDX_statistics(thread_db* tdbb, Cached::Relation* relation, USHORT id, SelectivityList& selectivity,
+	IndexHistogram* histogram, int workers)
 {
 /**************************************
  *
@@ -1513,13 +1533,15 @@ void IDX_statistics(thread_db* tdbb, Cached::Relation* relation, USHORT id, Sele
  *
  * Functional description
  *	Scan index pages recomputing
- *	selectivity.
+ *	selectivity and, optionally, the value
+ *	distribution histogram, using up to
+ *	the given number of parallel workers.
  *
  **************************************/
 
 	SET_TDBB(tdbb);
 
-	BTR_selectivity(tdbb, relation, id, selectivity);
+	BTR_selectivity(tdbb, relation, id, selectivity, histogram, workers);
 }
 
 
@@ -1596,6 +1618,76 @@ void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 	}
 }
 
+
+void IDX_store_key(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction, index_desc* idx,
+				   temporary_key* key, RecordNumber number)
+{
+/**************************************
+ *
+ *	I D X _ s t o r e _ k e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Insert the already composed key of the stored
+ *	record into the single index. Used by the bulk
+ *	insert which applies the buffered keys in the key
+ *	order. The record is fetched from its data page
+ *	only if it's needed for the constraints checking.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	RelationPages* relPages = relation->getPages(tdbb);
+	WIN window(relPages->rel_pg_space_id, relPages->rel_index_root);
+
+	// The index could grow a new level since its description was taken
+	const index_root_page* root = BTR_fetch_root(FB_FUNCTION, tdbb, &window);
+	idx->idx_root = root->irt_rpt[idx->idx_id].getRoot();
+
+	index_insertion insertion;
+	insertion.iib_relation = relation;
+	insertion.iib_number = number;
+	insertion.iib_descriptor = idx;
+	insertion.iib_transaction = transaction;
+	insertion.iib_btr_level = 0;
+	insertion.iib_key = key;
+	insertion.iib_duplicates = NULL;
+
+	BTR_insert(tdbb, &window, &insertion);
+
+	const bool checkForeign = (idx->idx_flags & idx_foreign) && key->key_nulls == 0;
+
+	if (!insertion.iib_duplicates && !checkForeign)
+		return;
+
+	AutoPtr<RecordBitmap> duplicates(insertion.iib_duplicates);
+
+	record_param rpb;
+	rpb.rpb_relation = relation;
+	rpb.rpb_record = NULL;
+	rpb.rpb_number = number;
+
+	if (!DPM_get(tdbb, &rpb, LCK_read))
+		BUGCHECK(186);	// msg 186 record disappeared
+
+	VIO_data(tdbb, &rpb, relation->rel_pool);
+	AutoPtr<Record> record(rpb.rpb_record);
+
+	IndexErrorContext context(relation, idx);
+	idx_e result = idx_e_ok;
+
+	if (duplicates)
+		result = check_duplicates(tdbb, record, idx, &insertion, NULL);
+
+	if (result == idx_e_ok && checkForeign)
+		result = check_foreign_key(tdbb, record, relation, transaction, idx, context);
+
+	if (result != idx_e_ok)
+		context.raise(tdbb, result, record);
+}
+
+
 static bool cmpRecordKeys(thread_db* tdbb,
 						  Record* rec1, jrd_rel* rel1, index_desc* idx1,
 						  Record* rec2, jrd_rel* rel2, index_desc* idx2)
@@ -41,6 +41,7 @@ namespace Jrd
 bool IDX_activate_index(Jrd::thread_db*, Jrd::Cached::Relation*, MetaId);
 void IDX_check_access(Jrd::thread_db*, Jrd::CompilerScratch*, Jrd::Cached::Relation*, Jrd::Cached::Relation*);
 bool IDX_check_master_types (Jrd::thread_db*, Jrd::index_desc&, Jrd::Cached::Relation*, int&);
+void IDX_compact(Jrd::thread_db*, Jrd::Cached::Relation*, MetaId);
 void IDX_create_index(Jrd::thread_db*, Jrd::IdxCreate createMethod, Jrd::jrd_rel*, Jrd::index_desc*,
 					  const Jrd::QualifiedName&, USHORT*, Jrd::jrd_tra*, Jrd::SelectivityList&);
 bool IDX_mark_index(Jrd::thread_db*, Jrd::Cached::Relation*, MetaId);
@@ -51,8 +52,11 @@ void IDX_erase(Jrd::thread_db*, Jrd::record_param*, Jrd::jrd_tra*);
 void IDX_garbage_collect(Jrd::thread_db*, Jrd::record_param*, Jrd::RecordStack&, Jrd::RecordStack&);
 void IDX_modify(Jrd::thread_db*, Jrd::record_param*, Jrd::record_param*, Jrd::jrd_tra*);
 void IDX_modify_check_constraints(Jrd::thread_db*, Jrd::record_param*, Jrd::record_param*, Jrd::jrd_tra*);
-void IDX_statistics(Jrd::thread_db*, Jrd::Cached::Relation*, USHORT, Jrd::SelectivityList&);
+void IDX_statistics(Jrd::thread_db*, Jrd::Cached::Relation*, USHORT, Jrd::SelectivityList&,
+					Jrd::IndexHistogram* = nullptr, int = 1);
 void IDX_store(Jrd::thread_db*, Jrd::record_param*, Jrd::jrd_tra*);
+void IDX_store_key(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::jrd_tra*, Jrd::index_desc*, Jrd::temporary_key*,
+				   RecordNumber);
 void IDX_modify_flag_uk_modified(Jrd::thread_db*, Jrd::record_param*, Jrd::record_param*, Jrd::jrd_tra*);
 
 
@@ -178,6 +178,7 @@ enum irq_type_t
 	irq_index_scan,			// scan index for caching
 	irq_index_id_erase,		// cleanup index ID
 	irq_l_index_cnstrt,     // lookup index for constraint
+	irq_l_histogram,		// lookup index histogram
 
 	irq_MAX
 };
@@ -3637,6 +3637,53 @@ int JBlob::getSegment(CheckStatusWrapper* user_status, unsigned int buffer_lengt
 }
 
 
+int JBlob::getData(CheckStatusWrapper* user_status, unsigned int buffer_length, void* buffer,
+	unsigned int* data_length)
+{
+/**************************************
+ *
+ *	J B l o b : : g e t D a t a
+ *
+ **************************************
+ *
+ * Functional description
+ *	Fill the buffer with blob data regardless of segments.
+ *
+ **************************************/
+	ULONG len = 0;
+	int cc = IStatus::RESULT_ERROR;
+
+	try
+	{
+		EngineContextHolder tdbb(user_status, this, FB_FUNCTION);
+		check_database(tdbb);
+
+		try
+		{
+			const SLONG length = (SLONG) MIN(buffer_length, (unsigned int) MAX_SLONG);
+			len = getHandle()->BLB_get_data(tdbb, static_cast<UCHAR*>(buffer), length, false);
+		}
+		catch (const Exception& ex)
+		{
+			transliterateException(tdbb, ex, user_status, "JBlob::getData");
+			return cc;
+		}
+
+		cc = (len || !buffer_length) ? IStatus::RESULT_OK : IStatus::RESULT_NO_DATA;
+	}
+	catch (const Exception& ex)
+	{
+		ex.stuffException(user_status);
+		return cc;
+	}
+
+	successful_completion(user_status);
+	if (data_length)
+		*data_length = len;
+	return cc;
+}
+
+
 int JAttachment::getSlice(CheckStatusWrapper* user_status, ITransaction* tra, ISC_QUAD* array_id,
 	unsigned int /*sdl_length*/, const unsigned char* sdl, unsigned int param_length,
 	const unsigned char* param, int slice_length, unsigned char* slice)
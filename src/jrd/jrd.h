@@ -190,6 +190,7 @@ inline constexpr USHORT WIN_large_scan			= 1;	// large sequential scan
 inline constexpr USHORT WIN_secondary			= 2;	// secondary stream
 inline constexpr USHORT WIN_garbage_collector	= 4;	// garbage collector's window
 inline constexpr USHORT WIN_garbage_collect		= 8;	// scan left a page for garbage collector
+inline constexpr USHORT WIN_read_ahead			= 16;	// sequential scan, read pages ahead of it
 
 // Helper class to temporarily activate sweeper context
 class ThreadSweepGuard
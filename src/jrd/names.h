@@ -511,5 +511,10 @@ NAME("MON$FIELD_PRECISION", nam_mon_f_precision)
 NAME("MON$FIELD_SUB_TYPE", nam_mon_f_sub_type)
 NAME("MON$CHAR_LENGTH", nam_mon_char_length)
 NAME("MON$COLLATION_ID", nam_mon_collate_id)
+NAME("MON$CACHE_HITS", nam_mon_cache_hits)
+NAME("MON$CACHE_MISSES", nam_mon_cache_misses)
+NAME("MON$GC_PENDING_PAGES", nam_mon_gc_pending_pages)
+NAME("MON$GC_PROCESSED_PAGES", nam_mon_gc_processed_pages)
 
 NAME("RDB$AGGREGATE_FLAG", nam_aggregate_flag)
+NAME("RDB$HISTOGRAM", nam_histogram)
@@ -133,7 +133,8 @@ inline constexpr USHORT ODS_CURRENT13	= 1;
 // Minor versions for ODS 14
 
 inline constexpr USHORT ODS_CURRENT14_0	= 0;	// Firebird 6.0 features
-inline constexpr USHORT ODS_CURRENT14	= 0;
+inline constexpr USHORT ODS_CURRENT14_1	= 1;	// Block compressed records
+inline constexpr USHORT ODS_CURRENT14	= 1;
 
 // useful ODS macros. These are currently used to flag the version of the
 // system triggers and system indices in ini.e
@@ -156,6 +157,7 @@ inline constexpr USHORT ODS_12_0	= ENCODE_ODS(ODS_VERSION12, 0);
 inline constexpr USHORT ODS_13_0	= ENCODE_ODS(ODS_VERSION13, 0);
 inline constexpr USHORT ODS_13_1	= ENCODE_ODS(ODS_VERSION13, 1);
 inline constexpr USHORT ODS_14_0	= ENCODE_ODS(ODS_VERSION14, 0);
+inline constexpr USHORT ODS_14_1	= ENCODE_ODS(ODS_VERSION14, 1);
 
 inline constexpr USHORT ODS_FIREBIRD_FLAG = 0x8000;
 
@@ -183,7 +185,7 @@ inline constexpr USHORT ODS_RELEASED = ODS_CURRENT14_0;		// The lowest stable mi
 inline constexpr USHORT ODS_CURRENT = ODS_CURRENT14;		// The highest defined minor version
 															// number for this ODS_VERSION!
 
-inline constexpr USHORT ODS_CURRENT_VERSION = ODS_14_0;		// Current ODS version in use which includes
+inline constexpr USHORT ODS_CURRENT_VERSION = ODS_14_1;		// Current ODS version in use which includes
 															// both major and minor ODS versions!
 
 
@@ -863,6 +865,8 @@ inline constexpr UCHAR ppg_dp_swept			= 0x04;		// Sweep has nothing to do on dat
 inline constexpr UCHAR ppg_dp_secondary		= 0x08;		// Primary record versions not stored on data page
 inline constexpr UCHAR ppg_dp_empty			= 0x10;		// Data page is empty
 inline constexpr UCHAR ppg_dp_reserved		= 0x20;		// Slot is reserved for bulk insert
+inline constexpr UCHAR ppg_dp_all_visible	= 0x40;		// All records on swept data page are visible
+														// to every transaction, set by sweep only
 
 inline constexpr UCHAR PPG_DP_ALL_BITS	= (1 << PPG_DP_BITS_NUM) - 1;
 
@@ -1033,6 +1037,7 @@ inline constexpr USHORT rhd_gc_active		= 256;		// garbage collecting dead record
 inline constexpr USHORT rhd_uk_modified		= 512;		// record key field values are changed
 inline constexpr USHORT rhd_long_tranum		= 1024;		// transaction number is 64-bit
 inline constexpr USHORT rhd_not_packed		= 2048;		// record (or delta) is stored "as is"
+inline constexpr USHORT rhd_block_packed	= 4096;		// record is compressed by the block compressor (ODS 14.1)
 
 
 // This (not exact) copy of class DSC is used to store descriptors on disk.
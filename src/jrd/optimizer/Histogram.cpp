@@ -0,0 +1,564 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/ods.h"
+#include "../jrd/optimizer/Histogram.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	const UCHAR HISTOGRAM_VERSION = 1;
+
+	void putInteger(UCharBuffer& buffer, FB_UINT64 value, unsigned size)
+	{
+		for (unsigned i = 0; i < size; i++, value >>= 8)
+			buffer.add((UCHAR) (value & 0xFF));
+	}
+
+	bool getInteger(const UCHAR*& ptr, const UCHAR* end, FB_UINT64& value, unsigned size)
+	{
+		if (end - ptr < (SINT64) size)
+			return false;
+
+		value = 0;
+		for (unsigned i = 0; i < size; i++)
+			value |= ((FB_UINT64) *ptr++) << (i * 8);
+
+		return true;
+	}
+
+	void putKey(UCharBuffer& buffer, const IndexHistogram::Key& key)
+	{
+		buffer.add((UCHAR) key.length);
+		buffer.add(key.data, key.length);
+	}
+
+	bool getKey(const UCHAR*& ptr, const UCHAR* end, IndexHistogram::Key& key)
+	{
+		FB_UINT64 length;
+		if (!getInteger(ptr, end, length, 1) ||
+			length > IndexHistogram::MAX_KEY_LENGTH || end - ptr < (SINT64) length)
+		{
+			return false;
+		}
+
+		key.assign(ptr, (USHORT) length);
+		ptr += length;
+		return true;
+	}
+
+	// Treat up to 8 bytes of the key starting from the given offset
+	// as a big-endian number, for the interpolation purposes
+
+	double keyToNumber(const IndexHistogram::Key& key, USHORT offset)
+	{
+		double value = 0;
+
+		for (unsigned i = 0; i < sizeof(FB_UINT64); i++)
+		{
+			const USHORT pos = offset + i;
+			value = value * 256 + ((pos < key.length) ? key.data[pos] : 0);
+		}
+
+		return value;
+	}
+
+	// Estimate the position of the key inside the (low, high) range,
+	// the common prefix of the range bounds is shared by the key
+
+	double interpolate(const IndexHistogram::Key& low, const IndexHistogram::Key& high,
+		const IndexHistogram::Key& key)
+	{
+		USHORT prefix = 0;
+		while (prefix < low.length && prefix < high.length && low.data[prefix] == high.data[prefix])
+			prefix++;
+
+		const double lowValue = keyToNumber(low, prefix);
+		const double highValue = keyToNumber(high, prefix);
+
+		if (highValue <= lowValue)
+			return 0.5;
+
+		const double fraction = (keyToNumber(key, prefix) - lowValue) / (highValue - lowValue);
+		return MIN(MAX(fraction, 0.0), 1.0);
+	}
+} // namespace
+
+
+void IndexHistogram::Key::assign(const UCHAR* value, USHORT valueLength)
+{
+	length = MIN(valueLength, MAX_KEY_LENGTH);
+	memcpy(data, value, length);
+}
+
+
+int IndexHistogram::Key::compare(const Key& other) const
+{
+	const int result = memcmp(data, other.data, MIN(length, other.length));
+
+	if (result)
+		return result;
+
+	return (int) length - (int) other.length;
+}
+
+
+void IndexHistogram::makeKey(const UCHAR* data, USHORT length, USHORT segments, Key& key)
+{
+/**************************************
+ *
+ *	m a k e K e y
+ *
+ **************************************
+ *
+ * Functional description
+ *	Extract the leading segment value from the ascending
+ *	index key. Compound keys are split into chunks prefixed
+ *	by the segment marker, the leading one is marked with
+ *	the segment count. Trailing pad bytes are removed, so the
+ *	same value produces the same key for any index layout.
+ *
+ **************************************/
+	key.length = 0;
+
+	if (segments <= 1)
+		key.assign(data, length);
+	else
+	{
+		const UCHAR* ptr = data;
+		const UCHAR* const end = data + length;
+
+		while (ptr < end && key.length < MAX_KEY_LENGTH && *ptr++ == segments)
+		{
+			for (int i = 0; i < Ods::STUFF_COUNT && ptr < end && key.length < MAX_KEY_LENGTH; i++)
+				key.data[key.length++] = *ptr++;
+		}
+	}
+
+	while (key.length && !key.data[key.length - 1])
+		key.length--;
+}
+
+
+void IndexHistogram::add(const Key& key)
+{
+	totalCount++;
+
+	// NULLs (and empty values which are indistinguishable from them) are counted separately
+	if (!key.length)
+	{
+		nullCount++;
+		return;
+	}
+
+	if (runCount && runKey == key)
+	{
+		runCount++;
+		return;
+	}
+
+	flushRun();
+
+	if (buckets.isEmpty() && !bucketOpen)
+		lowest = key;
+
+	runKey = key;
+	runCount = 1;
+}
+
+
+void IndexHistogram::finish(float aSelectivity)
+{
+	flushRun();
+	bucketOpen = false;
+
+	addCommonValue(lowest, firstRunCount);
+	firstRunCount = 0;
+
+	while (buckets.getCount() > MAX_BUCKETS)
+		mergeBuckets();
+
+	selectivity = aSelectivity;
+
+	// Keep only the values which are noticeably more frequent than the average one
+	// and exclude them from the buckets, so the latter describe the remaining values
+
+	FB_UINT64 distinct = 0;
+	for (const auto& bucket : buckets)
+		distinct += bucket.distinct;
+
+	const double average = distinct ? (double) (totalCount - nullCount) / distinct : 0;
+
+	for (FB_SIZE_T i = 0; i < commonValues.getCount();)
+	{
+		const auto& value = commonValues[i];
+
+		if (value.count < 2 || value.count < 2 * average)
+		{
+			commonValues.remove(i);
+			continue;
+		}
+
+		FB_SIZE_T pos = 0;
+		while (pos < buckets.getCount() - 1 && buckets[pos].upper.compare(value.value) < 0)
+			pos++;
+
+		auto& bucket = buckets[pos];
+		fb_assert(bucket.count >= value.count && bucket.distinct);
+		bucket.count -= value.count;
+		bucket.distinct--;
+		i++;
+	}
+}
+
+
+void IndexHistogram::append(IndexHistogram& next)
+{
+/**************************************
+ *
+ *	a p p e n d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Merge the histogram collected from the next range
+ *	of the index keys, when the leaf level is scanned
+ *	by parallel workers. Both histograms keep their
+ *	first and last runs of equal values aside, so a run
+ *	split between the ranges is counted as a whole and
+ *	the common values are the same as of the single scan.
+ *	Bucket bounds may differ from the single scan ones,
+ *	but the buckets keep roughly the same depth.
+ *
+ **************************************/
+	totalCount += next.totalCount;
+	nullCount += next.nullCount;
+
+	if (next.buckets.isEmpty() && !next.runCount)
+		return;
+
+	if (buckets.isEmpty() && !runCount)
+		lowest = next.lowest;
+
+	if (next.buckets.isEmpty())
+	{
+		// The next range consists of a single run which is not flushed yet
+
+		if (runCount && runKey == next.runKey)
+			runCount += next.runCount;
+		else
+		{
+			flushRun();
+			runKey = next.runKey;
+			runCount = next.runCount;
+		}
+
+		return;
+	}
+
+	FB_UINT64 firstCount = next.firstRunCount;
+
+	if (runCount && runKey == next.lowest)
+	{
+		// Our last run continues in the next range, join it to the first bucket
+		// of the next range, as equal values never span buckets
+
+		next.buckets.front().count += runCount;
+		firstCount += runCount;
+		runCount = 0;
+	}
+	else
+		flushRun();
+
+	addCommonValue(next.lowest, firstCount);
+
+	for (const auto& bucket : next.buckets)
+		buckets.add(bucket);
+
+	for (const auto& value : next.commonValues)
+		addCommonValue(value.value, value.count);
+
+	bucketOpen = next.bucketOpen;
+	bucketDepth = MAX(bucketDepth, next.bucketDepth);
+
+	while (buckets.getCount() >= 2 * MAX_BUCKETS)
+		mergeBuckets();
+
+	// The last run of the next range may continue in the range after it
+
+	runKey = next.runKey;
+	runCount = next.runCount;
+}
+
+
+void IndexHistogram::addCommonValue(const Key& value, FB_UINT64 count)
+{
+	if (!count)
+		return;
+
+	if (commonValues.getCount() < MAX_COMMON_VALUES)
+	{
+		CommonValue& common = commonValues.add();
+		common.value = value;
+		common.count = count;
+		return;
+	}
+
+	auto least = commonValues.begin();
+	for (auto iter = commonValues.begin(); iter != commonValues.end(); ++iter)
+	{
+		if (iter->count < least->count)
+			least = iter;
+	}
+
+	if (count > least->count)
+	{
+		least->value = value;
+		least->count = count;
+	}
+}
+
+
+void IndexHistogram::flushRun()
+{
+	if (!runCount)
+		return;
+
+	// The first run may continue the last run of the previous range,
+	// thus it's counted as a common value when the histogram is finished
+	// or appended to the previous one
+
+	if (buckets.isEmpty() && !bucketOpen)
+		firstRunCount = runCount;
+	else
+		addCommonValue(runKey, runCount);
+
+	// Equal values never span buckets, so a bucket is closed only on the value change
+
+	if (!bucketOpen)
+	{
+		buckets.add(Bucket());
+		bucketOpen = true;
+	}
+
+	auto& bucket = buckets.back();
+	bucket.upper = runKey;
+	bucket.count += runCount;
+	bucket.distinct++;
+
+	if (bucket.count >= bucketDepth)
+	{
+		bucketOpen = false;
+
+		if (buckets.getCount() >= 2 * MAX_BUCKETS)
+		{
+			mergeBuckets();
+			bucketDepth *= 2;
+		}
+	}
+
+	runCount = 0;
+}
+
+
+void IndexHistogram::mergeBuckets()
+{
+	FB_SIZE_T count = 0;
+
+	for (FB_SIZE_T i = 0; i < buckets.getCount(); i += 2)
+	{
+		Bucket merged = buckets[i];
+
+		if (i + 1 < buckets.getCount())
+		{
+			const auto& next = buckets[i + 1];
+			merged.upper = next.upper;
+			merged.count += next.count;
+			merged.distinct += next.distinct;
+		}
+
+		buckets[count++] = merged;
+	}
+
+	buckets.shrink(count);
+}
+
+
+void IndexHistogram::serialize(UCharBuffer& buffer) const
+{
+	static_assert(sizeof(float) == sizeof(ULONG), "unexpected float size");
+
+	buffer.clear();
+	buffer.add(HISTOGRAM_VERSION);
+
+	ULONG selectivityBits;
+	memcpy(&selectivityBits, &selectivity, sizeof(selectivityBits));
+	putInteger(buffer, selectivityBits, sizeof(ULONG));
+
+	putInteger(buffer, totalCount, sizeof(FB_UINT64));
+	putInteger(buffer, nullCount, sizeof(FB_UINT64));
+	putKey(buffer, lowest);
+
+	buffer.add((UCHAR) buckets.getCount());
+	for (const auto& bucket : buckets)
+	{
+		putKey(buffer, bucket.upper);
+		putInteger(buffer, bucket.count, sizeof(FB_UINT64));
+		putInteger(buffer, bucket.distinct, sizeof(FB_UINT64));
+	}
+
+	buffer.add((UCHAR) commonValues.getCount());
+	for (const auto& value : commonValues)
+	{
+		putKey(buffer, value.value);
+		putInteger(buffer, value.count, sizeof(FB_UINT64));
+	}
+}
+
+
+bool IndexHistogram::parse(const UCHAR* data, ULONG length)
+{
+	const UCHAR* ptr = data;
+	const UCHAR* const end = data + length;
+	FB_UINT64 value;
+
+	if (!getInteger(ptr, end, value, 1) || value != HISTOGRAM_VERSION)
+		return false;
+
+	if (!getInteger(ptr, end, value, sizeof(ULONG)))
+		return false;
+
+	const ULONG selectivityBits = (ULONG) value;
+	memcpy(&selectivity, &selectivityBits, sizeof(selectivity));
+
+	if (!getInteger(ptr, end, totalCount, sizeof(FB_UINT64)) ||
+		!getInteger(ptr, end, nullCount, sizeof(FB_UINT64)) ||
+		!getKey(ptr, end, lowest))
+	{
+		return false;
+	}
+
+	if (!getInteger(ptr, end, value, 1) || value > MAX_BUCKETS)
+		return false;
+
+	buckets.grow((FB_SIZE_T) value);
+	for (auto& bucket : buckets)
+	{
+		if (!getKey(ptr, end, bucket.upper) ||
+			!getInteger(ptr, end, bucket.count, sizeof(FB_UINT64)) ||
+			!getInteger(ptr, end, bucket.distinct, sizeof(FB_UINT64)))
+		{
+			return false;
+		}
+	}
+
+	if (!getInteger(ptr, end, value, 1) || value > MAX_COMMON_VALUES)
+		return false;
+
+	commonValues.grow((FB_SIZE_T) value);
+	for (auto& commonValue : commonValues)
+	{
+		if (!getKey(ptr, end, commonValue.value) ||
+			!getInteger(ptr, end, commonValue.count, sizeof(FB_UINT64)))
+		{
+			return false;
+		}
+	}
+
+	return (ptr == end && nullCount <= totalCount);
+}
+
+
+double IndexHistogram::getEqualSelectivity(const Key& key) const
+{
+	if (!totalCount || !key.length)
+		return -1;
+
+	for (const auto& value : commonValues)
+	{
+		if (value.value == key)
+			return (double) value.count / totalCount;
+	}
+
+	if (buckets.isEmpty() || key.compare(lowest) < 0 || key.compare(buckets.back().upper) > 0)
+		return 0;
+
+	FB_SIZE_T pos = 0;
+	while (buckets[pos].upper.compare(key) < 0)
+		pos++;
+
+	const auto& bucket = buckets[pos];
+
+	if (!bucket.distinct)
+		return 0;
+
+	return (double) bucket.count / bucket.distinct / totalCount;
+}
+
+
+double IndexHistogram::getRangeSelectivity(const Key* lower, const Key* upper) const
+{
+	if (!totalCount)
+		return -1;
+
+	double count = 0;
+
+	for (const auto& value : commonValues)
+	{
+		if ((!lower || value.value.compare(*lower) >= 0) &&
+			(!upper || value.value.compare(*upper) <= 0))
+		{
+			count += value.count;
+		}
+	}
+
+	for (FB_SIZE_T i = 0; i < buckets.getCount(); i++)
+		count += buckets[i].count * getBucketFraction(i, lower, upper);
+
+	return count / totalCount;
+}
+
+
+double IndexHistogram::getBucketFraction(FB_SIZE_T pos, const Key* lower, const Key* upper) const
+{
+	// The first bucket covers [lowest, upper], others cover (previous upper, upper]
+
+	const auto& high = buckets[pos].upper;
+	const auto& low = pos ? buckets[pos - 1].upper : lowest;
+
+	if (lower && lower->compare(high) > 0)
+		return 0;
+
+	if (upper)
+	{
+		const int result = upper->compare(low);
+
+		if (result < 0 || (result == 0 && pos))
+			return 0;
+	}
+
+	const double start = (lower && lower->compare(low) > 0) ? interpolate(low, high, *lower) : 0;
+	const double end = (upper && upper->compare(high) < 0) ? interpolate(low, high, *upper) : 1;
+
+	return (end > start) ? end - start : 0;
+}
@@ -0,0 +1,130 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_HISTOGRAM_H
+#define JRD_HISTOGRAM_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/RefCounted.h"
+
+namespace Jrd {
+
+// Value distribution of the leading index segment.
+//
+// Histogram is collected by SET STATISTICS while walking the index leaf level,
+// so the keys arrive already sorted. It consists of the equi-depth buckets
+// (every bucket covers roughly the same number of index entries) and the list
+// of the most common values, whose entries are excluded from the buckets.
+// Values are represented by their (possibly truncated) index keys, so they
+// are compared bytewise in the index order.
+
+class IndexHistogram : public Firebird::RefCounted, public Firebird::PermanentStorage
+{
+public:
+	static constexpr unsigned MAX_BUCKETS = 64;
+	static constexpr unsigned MAX_COMMON_VALUES = 16;
+	static constexpr unsigned MAX_KEY_LENGTH = 64;
+
+	struct Key
+	{
+		USHORT length = 0;
+		UCHAR data[MAX_KEY_LENGTH];
+
+		void assign(const UCHAR* value, USHORT valueLength);
+		int compare(const Key& other) const;
+
+		bool operator==(const Key& other) const
+		{
+			return compare(other) == 0;
+		}
+	};
+
+	explicit IndexHistogram(MemoryPool& pool)
+		: PermanentStorage(pool),
+		  buckets(pool),
+		  commonValues(pool)
+	{}
+
+	// Extract the normalized value of the leading segment from the index key
+	static void makeKey(const UCHAR* data, USHORT length, USHORT segments, Key& key);
+
+	// Build the histogram, keys must be passed in the index order
+	void add(const Key& key);
+	void finish(float selectivity);
+
+	// Append the histogram of the next key range, both are not finished yet
+	void append(IndexHistogram& next);
+
+	// Store and load the histogram as the binary blob
+	void serialize(Firebird::UCharBuffer& buffer) const;
+	bool parse(const UCHAR* data, ULONG length);
+
+	float getSelectivity() const
+	{
+		return selectivity;
+	}
+
+	bool isEmpty() const
+	{
+		return !totalCount;
+	}
+
+	// Fraction of the index entries matching the given value or range.
+	// Negative result means that the histogram cannot provide an estimation.
+	double getEqualSelectivity(const Key& key) const;
+	double getRangeSelectivity(const Key* lower, const Key* upper) const;
+
+private:
+	struct Bucket
+	{
+		Key upper;					// highest value inside the bucket
+		FB_UINT64 count = 0;		// number of entries, excluding common values
+		FB_UINT64 distinct = 0;		// number of distinct values, excluding common values
+	};
+
+	struct CommonValue
+	{
+		Key value;
+		FB_UINT64 count = 0;
+	};
+
+	void addCommonValue(const Key& value, FB_UINT64 count);
+	void flushRun();
+	void mergeBuckets();
+	double getBucketFraction(FB_SIZE_T pos, const Key* lower, const Key* upper) const;
+
+	Firebird::Array<Bucket> buckets;
+	Firebird::Array<CommonValue> commonValues;
+	Key lowest;						// lowest non-NULL value
+	FB_UINT64 totalCount = 0;		// all entries including NULLs
+	FB_UINT64 nullCount = 0;
+	float selectivity = 0;			// leading segment selectivity the histogram was built with
+
+	// Build-time state
+	Key runKey;
+	FB_UINT64 runCount = 0;
+	FB_UINT64 firstRunCount = 0;	// entries of the lowest value, not in the common values yet
+	FB_UINT64 bucketDepth = 1;
+	bool bucketOpen = false;
+};
+
+} // namespace Jrd
+
+#endif // JRD_HISTOGRAM_H
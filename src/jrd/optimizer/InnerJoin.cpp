@@ -589,7 +589,9 @@ River* InnerJoin::formRiver()
 		}
 		else
 		{
-			rsb = optimizer->generateRetrieval(stream.number, sortPtr, false, false);
+			// Only the first stream is not re-opened by the nested loop join
+			rsb = optimizer->generateRetrieval(stream.number, sortPtr, false, false,
+				nullptr, rsbs.isEmpty());
 		}
 
 		rsbs.add(rsb);
@@ -672,7 +672,8 @@ Optimizer::~Optimizer()
 // Compile and optimize a record selection expression into a set of record source blocks
 //
 
-RecordSource* Optimizer::compile(RseNode* subRse, BoolExprNodeStack* parentStack)
+RecordSource* Optimizer::compile(RseNode* subRse, BoolExprNodeStack* parentStack,
+								 SortedStream** sortedStream)
 {
 	// dimitr:	it makes no sense to optimize sub-RSE for first rows
 	//			if we're going to sort/aggregate the resultset afterwards
@@ -681,6 +682,11 @@ RecordSource* Optimizer::compile(RseNode* subRse, BoolExprNodeStack* parentStack
 	Optimizer subOpt(tdbb, csb, subRse, subFirstRows);
 	const auto rsb = subOpt.compile(parentStack);
 
+	// Report the sort only if nothing else has been put on top of it
+
+	if (sortedStream)
+		*sortedStream = (subOpt.sortedStream == rsb) ? subOpt.sortedStream : nullptr;
+
 	if (parentStack && !subRse->isFullJoin())
 	{
 		// If any parent conjunct was utilized, update our copy of its flags.
@@ -1155,7 +1161,7 @@ RecordSource* Optimizer::compile(BoolExprNodeStack* parentStack)
 
 		// Handle sort clause if present
 		if (sort)
-			rsb = generateSort(bedStreams, &keyStreams, rsb, sort, favorFirstRows(), false);
+			rsb = sortedStream = generateSort(bedStreams, &keyStreams, rsb, sort, favorFirstRows(), false);
 	}
 
 	// Add invariant booleans, if any. They should be evaluated before
@@ -2159,6 +2165,7 @@ void Optimizer::checkSorts()
 				setDirection(sort, group);
 				setPosition(sort, group, map);
 				sort = rse->rse_sorted = nullptr;
+				aggregate->sortedOutput = true;
 			}
 		}
 	}
@@ -3045,7 +3052,8 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 										   SortNode** sortClause,
 										   bool outerFlag,
 										   bool innerFlag,
-										   BoolExprNode** returnBoolean)
+										   BoolExprNode** returnBoolean,
+										   bool drivingFlag)
 {
 	const auto tail = &csb->csb_rpt[stream];
 	const auto relation = tail->csb_relation;
@@ -3218,7 +3226,19 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 		}
 		else
 		{
-			rsb = FB_NEW_POOL(getPool()) FullTableScan(csb, alias, stream, relation, dbkeyRanges);
+			// Full scan of a large user table may be done by parallel workers if
+			// the stream drives its join, i.e. it's not re-opened for every record
+			// of the outer streams. The final decision is made when the scan is opened.
+
+			if (drivingFlag && dbkeyRanges.isEmpty() &&
+				tdbb->getAttachment()->att_parallel_workers > 1 &&
+				!relation()->isSystem() && !relation()->isTemporary() &&
+				DPM_data_pages(tdbb, relation()) > tdbb->getDatabase()->dbb_dp_per_pp)
+			{
+				rsb = FB_NEW_POOL(getPool()) ParallelTableScan(csb, alias, stream, relation);
+			}
+			else
+				rsb = FB_NEW_POOL(getPool()) FullTableScan(csb, alias, stream, relation, dbkeyRanges);
 
 			if (boolean)
 				csb->csb_rpt[stream].csb_flags |= csb_unmatched;
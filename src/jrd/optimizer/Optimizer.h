@@ -42,6 +42,7 @@
 #include "../jrd/exe.h"
 #include "../jrd/Statement.h"
 #include "../jrd/recsrc/RecordSource.h"
+#include "../jrd/optimizer/Histogram.h"
 
 #include <cmath>
 
@@ -507,7 +508,8 @@ public:
 
 	~Optimizer();
 
-	RecordSource* compile(RseNode* subRse, BoolExprNodeStack* parentStack);
+	RecordSource* compile(RseNode* subRse, BoolExprNodeStack* parentStack,
+						  SortedStream** sortedStream = nullptr);
 	void compileLocalTable(StreamType stream);
 	void compileRelation(StreamType stream);
 	unsigned decomposeBoolean(BoolExprNode* boolNode, BoolExprNodeStack& stack);
@@ -517,7 +519,8 @@ public:
 									SortNode** sortClause,
 									bool outerFlag,
 									bool innerFlag,
-									BoolExprNode** returnBoolean = nullptr);
+									BoolExprNode** returnBoolean = nullptr,
+									bool drivingFlag = false);
 	SortedStream* generateSort(const StreamList& streams,
 							   const StreamList* dbkeyStreams,
 							   RecordSource* rsb, SortNode* sort,
@@ -548,6 +551,11 @@ public:
 		return rse->isSpecialJoin();
 	}
 
+	bool hasWriteLock() const
+	{
+		return rse->hasWriteLock();
+	}
+
 	const StreamList& getOuterStreams() const noexcept
 	{
 		return outerStreams;
@@ -631,6 +639,8 @@ private:
 	bool firstRows = false;					// optimize for first rows
 	double cardinality = 0;					// self or parent cardinality
 
+	SortedStream* sortedStream = nullptr;	// sort generated for the ORDER BY (or GROUP BY)
+
 	FILE* debugFile = nullptr;
 	unsigned baseConjuncts = 0;				// number of conjuncts in our rse, next conjuncts are distributed parent
 	unsigned baseParentConjuncts = 0;		// number of conjuncts in our rse + distributed with parent, next are parent
@@ -702,6 +712,8 @@ struct IndexScratch
 	bool usePartialKey = false;					// Use INTL_KEY_PARTIAL
 	bool useMultiStartingKeys = false;			// Use INTL_KEY_MULTI_STARTING
 	bool useRootListScan = false;
+	bool useSkipScan = false;					// Leading segment is not matched, walk its values
+	Firebird::RefPtr<const IndexHistogram> histogram;	// distribution of the leading segment values
 
 	Firebird::ObjectsArray<IndexScratchSegment> segments;
 	BooleanList matches;					// matched booleans (partial indices only)
@@ -778,10 +790,12 @@ protected:
 	bool betterInversion(const InversionCandidate* inv1, const InversionCandidate* inv2,
 						 bool navigation) const;
 	bool checkIndexCondition(index_desc& idx, BooleanList& matches) const;
+	bool checkIndexOnly(const index_desc* idx) const;
 	bool checkIndexExpression(const index_desc* idx, ValueExprNode* node) const;
 	InversionNode* composeInversion(InversionNode* node1, InversionNode* node2,
 		InversionNode::Type node_type) const;
 	const Firebird::string& getAlias();
+	double getHistogramSelectivity(const IndexScratch& scratch, const IndexScratchSegment& segment) const;
 	void getInversionCandidates(InversionCandidateList& inversions,
 		IndexScratchList& indexScratches, unsigned scope) const;
 	InversionNode* makeIndexScanNode(IndexScratch* indexScratch) const;
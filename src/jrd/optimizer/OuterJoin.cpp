@@ -163,7 +163,7 @@ RecordSource* OuterJoin::process()
 	if (outer.number != INVALID_STREAM)
 	{
 		outerRsb = optimizer->generateRetrieval(outer.number,
-			optimizer->isFullJoin() ? nullptr : sortPtr, true, false, &boolean);
+			optimizer->isFullJoin() ? nullptr : sortPtr, true, false, &boolean, true);
 	}
 	else
 	{
@@ -133,6 +133,8 @@ IndexScratch::IndexScratch(MemoryPool& p, const IndexScratch& other)
 	  usePartialKey(other.usePartialKey),
 	  useMultiStartingKeys(other.useMultiStartingKeys),
 	  useRootListScan(other.useRootListScan),
+	  useSkipScan(other.useSkipScan),
+	  histogram(other.histogram),
 	  segments(p, other.segments),
 	  matches(p, other.matches)
 {}
@@ -194,6 +196,14 @@ Retrieval::Retrieval(thread_db* aTdbb, Optimizer* opt, StreamType streamNumber,
 		scratch.cardinality = cardinality;
 		scratch.matches.assign(matches);
 
+		// Distribution of the leading segment values is collected by SET STATISTICS
+		// for ascending indices, it's valid for the current index selectivity only
+		if (!(index.idx_flags & idx_descending) && index.idx_selectivity > 0)
+		{
+			if (const auto idp = relation()->lookupIndex(tdbb, index.idx_id, CacheFlag::AUTOCREATE))
+				scratch.histogram = idp->getHistogram(tdbb, index.idx_selectivity);
+		}
+
 		indexScratches.add(scratch);
 	}
 }
@@ -415,14 +425,69 @@ IndexTableScan* Retrieval::getNavigation()
 	const auto scratch = navigationCandidate->scratch;
 	scratch->index->idx_runtime_flags |= idx_navigate;
 
+	// Navigation does not support skip scan, so the whole index is walked instead.
+	// Inversions are already made at this point, so the scratch may be reset.
+	if (scratch->useSkipScan)
+	{
+		scratch->useSkipScan = false;
+		scratch->lowerCount = scratch->upperCount = 0;
+	}
+
 	const auto indexNode = makeIndexScanNode(scratch);
 
 	const USHORT keyLength =
 		ROUNDUP(BTR_key_length(tdbb, relation(tdbb), scratch->index), sizeof(SLONG));
 
-	return FB_NEW_POOL(getPool())
+	const auto rsb = FB_NEW_POOL(getPool())
 		IndexTableScan(csb, getAlias(), stream, relation, indexNode, keyLength,
 					   navigationCandidate->selectivity);
+
+	if (checkIndexOnly(scratch->index))
+		rsb->setIndexOnly();
+
+	return rsb;
+}
+
+bool Retrieval::checkIndexOnly(const index_desc* idx) const
+{
+	// Check whether the navigational scan may restore the record from the index key
+	// instead of fetching it from the data page (if that page is all visible).
+	// It's possible if the index key is decodable and all the referenced fields
+	// are index segments. Record versions and locks require the real record.
+
+	const auto tail = &csb->csb_rpt[stream];
+
+	if ((tail->csb_flags & (csb_update | csb_record_version)) || optimizer->hasWriteLock())
+		return false;
+
+	if (!BTR_decodable(tdbb, relation(tdbb), idx))
+		return false;
+
+	UInt32Bitmap::Accessor accessor(tail->csb_fields);
+
+	if (accessor.getFirst())
+	{
+		do
+		{
+			const auto id = accessor.current();
+			bool found = false;
+
+			for (USHORT i = 0; i < idx->idx_count; i++)
+			{
+				if (idx->idx_rpt[i].idx_field == id)
+				{
+					found = true;
+					break;
+				}
+			}
+
+			if (!found)
+				return false;
+
+		} while (accessor.getNext());
+	}
+
+	return true;
 }
 
 void Retrieval::analyzeNavigation(const InversionCandidateList& inversions)
@@ -463,8 +528,13 @@ void Retrieval::analyzeNavigation(const InversionCandidateList& inversions)
 		// check to see if the fields in the sort match the fields in the index
 		// in the exact same order
 
+		// Skip scan cannot be navigational, so don't count its matched segments
+
 		unsigned equalSegments = 0;
-		for (unsigned i = 0; i < MIN(indexScratch.lowerCount, indexScratch.upperCount); i++)
+		const unsigned matchedCount = indexScratch.useSkipScan ? 0 :
+			MIN(indexScratch.lowerCount, indexScratch.upperCount);
+
+		for (unsigned i = 0; i < matchedCount; i++)
 		{
 			const auto& segment = indexScratch.segments[i];
 
@@ -593,7 +663,7 @@ void Retrieval::analyzeNavigation(const InversionCandidateList& inversions)
 
 		for (const auto inversion : inversions)
 		{
-			if (inversion->scratch == &indexScratch)
+			if (inversion->scratch == &indexScratch && !indexScratch.useSkipScan)
 			{
 				candidate = inversion;
 				break;
@@ -949,6 +1019,76 @@ bool Retrieval::checkIndexExpression(const index_desc* idx, ValueExprNode* node)
 		node->containsStream(stream, true);
 }
 
+
+//
+// Estimate the leading segment selectivity using the value distribution histogram.
+// Only literal bounds can be looked up, negative result means no estimation.
+//
+
+double Retrieval::getHistogramSelectivity(const IndexScratch& scratch,
+										  const IndexScratchSegment& segment) const
+{
+	const auto histogram = scratch.histogram.getPtr();
+
+	if (!histogram || histogram->isEmpty())
+		return -1;
+
+	const auto makeKey = [&](const ValueExprNode* value, IndexHistogram::Key& key)
+	{
+		const auto literal = nodeAs<LiteralNode>(value);
+
+		if (!literal || literal->litDesc.isNull())
+			return false;
+
+		temporary_key temp;
+		temp.key_length = 0;
+
+		try
+		{
+			BTR_make_leading_key(tdbb, scratch.index, &literal->litDesc, segment.scale, &temp);
+		}
+		catch (const Exception&)
+		{
+			// Conversion errors are reported at runtime, if ever
+			return false;
+		}
+
+		IndexHistogram::makeKey(temp.key_data, temp.key_length, 1, key);
+		return true;
+	};
+
+	IndexHistogram::Key lower, upper;
+
+	switch (segment.scanType)
+	{
+		case segmentScanEqual:
+			if (makeKey(segment.lowerValue, lower))
+				return histogram->getEqualSelectivity(lower);
+			break;
+
+		case segmentScanBetween:
+			if (makeKey(segment.lowerValue, lower) && makeKey(segment.upperValue, upper))
+				return histogram->getRangeSelectivity(&lower, &upper);
+			break;
+
+		case segmentScanGreater:
+			if (makeKey(segment.lowerValue, lower))
+				return histogram->getRangeSelectivity(&lower, nullptr);
+			break;
+
+		case segmentScanLess:
+			if (makeKey(segment.upperValue, upper))
+				return histogram->getRangeSelectivity(nullptr, &upper);
+			break;
+
+		default:
+			break;
+	}
+
+	return -1;
+}
+
+
 void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 									   IndexScratchList& fromIndexScratches,
 									   unsigned scope) const
@@ -969,24 +1109,64 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 		scratch.usePartialKey = false;
 		scratch.useMultiStartingKeys = false;
 		scratch.useRootListScan = false;
+		scratch.useSkipScan = false;
 
 		const auto idx = scratch.index;
 
-		if (scratch.candidate)
+		// If the leading segment is not matched but the next one is, the index
+		// may be still used by walking the distinct values of the leading segment
+		// and probing the trailing segments for every such value. Estimating its
+		// cost requires the leading segment selectivity to be known.
+
+		if (!scratch.candidate && idx->idx_count > 1 &&
+			!(idx->idx_flags & (idx_descending | idx_expression)) &&
+			idx->idx_rpt[0].idx_selectivity > 0)
+		{
+			const auto scanType = scratch.segments[1].scanType;
+
+			scratch.useSkipScan = (scanType != segmentScanNone &&
+				scanType != segmentScanMissing &&
+				scanType != segmentScanEquivalent &&
+				scanType != segmentScanList);
+		}
+
+		if (scratch.candidate || scratch.useSkipScan)
 		{
 			matches.assign(scratch.matches);
 			scratch.selectivity = MAXIMUM_SELECTIVITY;
 
 			bool unique = false;
 			unsigned listCount = 0;
+			unsigned firstSegment = 0;
+
+			if (scratch.useSkipScan)
+			{
+				// Leading segment is matched by the scan itself
+				scratch.lowerCount = scratch.upperCount = 1;
+				scratch.selectivity = idx->idx_rpt[0].idx_selectivity;
+				firstSegment = 1;
+			}
+
 			auto maxSelectivity = scratch.selectivity;
+			double histogramSelectivity = -1;
+			double skewFactor = 1;
 
-			for (unsigned j = 0; j < scratch.segments.getCount(); j++)
+			for (unsigned j = firstSegment; j < scratch.segments.getCount(); j++)
 			{
 				const auto& segment = scratch.segments[j];
 
 				auto scanType = segment.scanType;
 
+				// Skip scan makes the keys for the leading segment values found in the index,
+				// so it cannot be combined with lists and it doesn't look for NULLs
+				if (scratch.useSkipScan &&
+					(scanType == segmentScanMissing ||
+					 scanType == segmentScanEquivalent ||
+					 scanType == segmentScanList))
+				{
+					break;
+				}
+
 				if (segment.scope == scope)
 					scratch.scopeCandidate = true;
 
@@ -1025,6 +1205,21 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 				if (useDefaultSelectivity)
 					selectivity = MAX(scratch.selectivity * DEFAULT_SELECTIVITY, minSelectivity);
 
+				// The histogram describes skewed data better than the average selectivity does.
+				// Compound selectivities of the next segments are assumed to be skewed the same way.
+				if (j == 0 && !useDefaultSelectivity && !scratch.usePartialKey)
+				{
+					histogramSelectivity = getHistogramSelectivity(scratch, segment);
+
+					if (histogramSelectivity >= 0)
+					{
+						histogramSelectivity = MIN(MAX(histogramSelectivity, minSelectivity), MAXIMUM_SELECTIVITY);
+						skewFactor = histogramSelectivity / selectivity;
+					}
+				}
+				else if (histogramSelectivity >= 0 && !useDefaultSelectivity)
+					selectivity = MAX(MIN(selectivity * skewFactor, scratch.selectivity), minSelectivity);
+
 				if (scanType == segmentScanList)
 				{
 					if (listCount) // we cannot have more than one list matched to an index
@@ -1050,7 +1245,8 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 					scratch.nonFullMatchedSegments = idx->idx_count - (j + 1);
 					// Add matches for this segment to the main matches list
 					matches.join(segment.matches);
-					scratch.selectivity = selectivity;
+					scratch.selectivity = (j == 0 && histogramSelectivity >= 0) ?
+						histogramSelectivity : selectivity;
 
 					// An equality scan for any unique index cannot retrieve more
 					// than one row. The same is true for an equivalence scan for
@@ -1061,7 +1257,7 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 						(scanType == segmentScanEquivalent && (idx->idx_flags & idx_primary)) ||
 						(scanType == segmentScanMissing && (idx->idx_flags & idx_primary));
 
-					if (uniqueMatch && ((j + 1) == idx->idx_count))
+					if (uniqueMatch && ((j + 1) == idx->idx_count) && !scratch.useSkipScan)
 					{
 						// We have found a full equal matching index and it's unique,
 						// so we can stop looking further, because this is the best
@@ -1127,6 +1323,11 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 						// than a full match.
 						const double diffSelectivity = scratch.selectivity - selectivity;
 						selectivity += (diffSelectivity * factor);
+
+						// Range of the leading segment values is estimated by the histogram
+						if (j == 0 && histogramSelectivity >= 0)
+							selectivity = histogramSelectivity;
+
 						fb_assert(selectivity <= scratch.selectivity);
 						scratch.selectivity = selectivity;
 
@@ -1138,6 +1339,14 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 				}
 			}
 
+			if (scratch.useSkipScan && scratch.useMultiStartingKeys)
+			{
+				// Multiple keys per trailing value are not supported by skip scan
+				scratch.useSkipScan = false;
+				scratch.scopeCandidate = false;
+				scratch.lowerCount = scratch.upperCount = 0;
+			}
+
 			if (scratch.scopeCandidate)
 			{
 				double selectivity = scratch.selectivity;
@@ -1146,6 +1355,21 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 				// Calculate the cost (only index pages) for this index
 				auto cost = DEFAULT_INDEX_COST + selectivity * scratch.cardinality;
 
+				if (scratch.useSkipScan)
+				{
+					// Segment selectivities are compound ones, so the fraction of every
+					// leading value group matched by the trailing segments is their ratio.
+					// Every distinct leading value costs two index lookups: one to find
+					// the value and another one to probe the trailing segments range.
+
+					const double leadSelectivity = idx->idx_rpt[0].idx_selectivity;
+					const double cardinality = csb->csb_rpt[stream].csb_cardinality;
+					const double distinctCount = MAX(MIN(1 / leadSelectivity, cardinality), 1);
+
+					selectivity = MIN(selectivity / leadSelectivity, MAXIMUM_SELECTIVITY);
+					cost = DEFAULT_INDEX_COST * 2 * distinctCount + selectivity * scratch.cardinality;
+				}
+
 				if (listCount)
 				{
 					// Adjust selectivity based on the list items count
@@ -1170,7 +1394,8 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 				invCandidate->selectivity = idx->idx_fraction * selectivity;
 				invCandidate->cost = cost;
 				invCandidate->nonFullMatchedSegments = scratch.nonFullMatchedSegments;
-				invCandidate->matchedSegments = MAX(scratch.lowerCount, scratch.upperCount);
+				invCandidate->matchedSegments = MAX(scratch.lowerCount, scratch.upperCount) -
+					(scratch.useSkipScan ? 1 : 0);
 				invCandidate->indexes = 1;
 				invCandidate->scratch = &scratch;
 				invCandidate->matches.join(matches);
@@ -1366,6 +1591,12 @@ InversionNode* Retrieval::makeIndexScanNode(IndexScratch* indexScratch) const
 		retrieval->irb_generic |= irb_root_list_scan;
 	}
 
+	if (indexScratch->useSkipScan)
+	{
+		fb_assert(!retrieval->irb_list && !(idx->idx_flags & idx_descending));
+		retrieval->irb_generic |= irb_skip_scan;
+	}
+
 	// Check to see if this is really an equality retrieval
 	if (retrieval->irb_lower_count == retrieval->irb_upper_count)
 	{
@@ -79,6 +79,7 @@ inline constexpr USHORT FIL_readonly		= 4;	// file opened in readonly mode
 inline constexpr USHORT FIL_sh_write		= 8;	// file opened in shared write mode
 inline constexpr USHORT FIL_no_fast_extend	= 16;	// file not supports fast extending
 inline constexpr USHORT FIL_raw_device		= 32;	// file is raw device
+inline constexpr USHORT FIL_io_uring		= 64;	// batched reads are submitted using io_uring
 
 // Physical IO trace events
 
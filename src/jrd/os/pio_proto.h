@@ -36,6 +36,7 @@ namespace Ods {
 	struct pag;
 }
 
+void	PIO_advise_read(Jrd::thread_db*, Jrd::jrd_file*, const ULONG*, FB_SIZE_T);
 void	PIO_close(Jrd::jrd_file*);
 Jrd::jrd_file*	PIO_create(Jrd::thread_db*, const Firebird::PathName&,
 							const bool, const bool);
@@ -50,6 +51,7 @@ USHORT	PIO_init_data(Jrd::thread_db* tdbb, Jrd::jrd_file* file, Jrd::FbStatusVec
 Jrd::jrd_file*	PIO_open(Jrd::thread_db*, const Firebird::PathName&,
 						 const Firebird::PathName&);
 bool	PIO_read(Jrd::thread_db*, Jrd::jrd_file*, Jrd::BufferDesc*, Ods::pag*, Jrd::FbStatusVector*);
+bool	PIO_read_batch(Jrd::thread_db*, Jrd::jrd_file*, Jrd::BufferDesc**, FB_SIZE_T, Jrd::FbStatusVector*);
 
 #ifdef SUPERSERVER_V2
 bool	PIO_read_ahead(Jrd::thread_db*, SLONG, SCHAR*, SLONG,
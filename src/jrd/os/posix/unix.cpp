@@ -49,6 +49,14 @@
 #include <linux/falloc.h>
 #endif
 
+#if defined(LINUX) && defined(HAVE_LINUX_IO_URING_H)
+#define USE_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include <atomic>
+#endif
+
 #ifdef SUPPORT_RAW_DEVICES
 #include <sys/ioctl.h>
 
@@ -132,6 +140,7 @@ using namespace Firebird;
 
 static const mode_t MASK = 0660;
 
+static bool read_page(jrd_file*, BufferDesc*, Ods::pag*, SLONG, FbStatusVector*);
 static bool seek_file(jrd_file*, BufferDesc*, FB_UINT64*, FbStatusVector*);
 static jrd_file* setup_file(Database*, const PathName&, int, USHORT);
 static void lockDatabaseFile(int& desc, const bool shareMode, const bool temporary,
@@ -150,6 +159,216 @@ static int	openFile(const Firebird::PathName&, const bool, const bool, const boo
 static void	maybeCloseFile(int&);
 
 
+#ifdef USE_IO_URING
+
+namespace
+{
+	// Minimal io_uring submission/completion ring used to read a batch of
+	// pages concurrently. Raw system calls are used to not depend on liburing.
+	// Every thread owns its private ring, therefore no locking is needed.
+
+	class IoUring
+	{
+	public:
+		static const unsigned RING_ENTRIES = 64;
+
+		IoUring();
+		~IoUring();
+
+		bool isValid() const
+		{
+			return valid;
+		}
+
+		void prepareRead(int fd, void* buffer, unsigned length, FB_UINT64 offset, unsigned tag);
+		void cancelPrepared(unsigned count);
+		int submitAndWait(unsigned submit, unsigned wait);
+		bool getCompletion(unsigned* tag, int* result);
+		void waitCompletions(unsigned count);
+
+		static IoUring* getThreadRing();
+
+	private:
+		int ring_fd;
+		bool valid;
+
+		void* sq_ring;
+		size_t sq_ring_size;
+		void* cq_ring;
+		size_t cq_ring_size;
+		io_uring_sqe* sqes;
+		size_t sqes_size;
+
+		unsigned* sq_tail;
+		unsigned* sq_mask;
+		unsigned* sq_array;
+		unsigned* cq_head;
+		unsigned* cq_tail;
+		unsigned* cq_mask;
+		io_uring_cqe* cqes;
+
+		static std::atomic<bool> unavailable;
+	};
+
+	std::atomic<bool> IoUring::unavailable = false;
+
+	IoUring::IoUring()
+		: ring_fd(-1), valid(false), sq_ring(MAP_FAILED), sq_ring_size(0), cq_ring(MAP_FAILED), cq_ring_size(0),
+		  sqes((io_uring_sqe*) MAP_FAILED), sqes_size(0)
+	{
+		io_uring_params params;
+		memset(&params, 0, sizeof(params));
+
+		ring_fd = (int) syscall(__NR_io_uring_setup, RING_ENTRIES, &params);
+		if (ring_fd < 0)
+			return;
+
+		sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+		if (params.features & IORING_FEAT_SINGLE_MMAP)
+			sq_ring_size = cq_ring_size = MAX(sq_ring_size, cq_ring_size);
+
+		sq_ring = mmap(NULL, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ring_fd, IORING_OFF_SQ_RING);
+
+		if (sq_ring == MAP_FAILED)
+			return;
+
+		if (params.features & IORING_FEAT_SINGLE_MMAP)
+			cq_ring = sq_ring;
+		else
+		{
+			cq_ring = mmap(NULL, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+				ring_fd, IORING_OFF_CQ_RING);
+		}
+
+		sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+		sqes = (io_uring_sqe*) mmap(NULL, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+			ring_fd, IORING_OFF_SQES);
+
+		if (cq_ring == MAP_FAILED || sqes == MAP_FAILED)
+			return;
+
+		char* const sq = (char*) sq_ring;
+		sq_tail = (unsigned*) (sq + params.sq_off.tail);
+		sq_mask = (unsigned*) (sq + params.sq_off.ring_mask);
+		sq_array = (unsigned*) (sq + params.sq_off.array);
+
+		char* const cq = (char*) cq_ring;
+		cq_head = (unsigned*) (cq + params.cq_off.head);
+		cq_tail = (unsigned*) (cq + params.cq_off.tail);
+		cq_mask = (unsigned*) (cq + params.cq_off.ring_mask);
+		cqes = (io_uring_cqe*) (cq + params.cq_off.cqes);
+
+		valid = true;
+	}
+
+	IoUring::~IoUring()
+	{
+		if (sqes != MAP_FAILED)
+			munmap(sqes, sqes_size);
+		if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+			munmap(cq_ring, cq_ring_size);
+		if (sq_ring != MAP_FAILED)
+			munmap(sq_ring, sq_ring_size);
+		if (ring_fd >= 0)
+			close(ring_fd);
+	}
+
+	void IoUring::prepareRead(int fd, void* buffer, unsigned length, FB_UINT64 offset, unsigned tag)
+	{
+		// Caller guarantees that no more than RING_ENTRIES requests are outstanding
+
+		const unsigned tail = *sq_tail;
+		const unsigned index = tail & *sq_mask;
+
+		io_uring_sqe* const sqe = &sqes[index];
+		memset(sqe, 0, sizeof(io_uring_sqe));
+		sqe->opcode = IORING_OP_READ;
+		sqe->fd = fd;
+		sqe->addr = (U_IPTR) buffer;
+		sqe->len = length;
+		sqe->off = offset;
+		sqe->user_data = tag;
+
+		sq_array[index] = index;
+		__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+	}
+
+	void IoUring::cancelPrepared(unsigned count)
+	{
+		// Requests not submitted yet are still owned by us (no SQ polling
+		// thread is used), take them back to not submit them with the next batch
+
+		__atomic_store_n(sq_tail, *sq_tail - count, __ATOMIC_RELEASE);
+	}
+
+	int IoUring::submitAndWait(unsigned submit, unsigned wait)
+	{
+		return (int) syscall(__NR_io_uring_enter, ring_fd, submit, wait, IORING_ENTER_GETEVENTS, NULL, 0);
+	}
+
+	bool IoUring::getCompletion(unsigned* tag, int* result)
+	{
+		const unsigned head = *cq_head;
+		if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+			return false;
+
+		const io_uring_cqe* const cqe = &cqes[head & *cq_mask];
+		*tag = (unsigned) cqe->user_data;
+		*result = cqe->res;
+
+		__atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+		return true;
+	}
+
+	void IoUring::waitCompletions(unsigned count)
+	{
+		// Reap completions of the submitted requests, the kernel could write
+		// into their buffers until then
+
+		while (true)
+		{
+			unsigned tag;
+			int result;
+			while (count && getCompletion(&tag, &result))
+				count--;
+
+			if (!count)
+				break;
+
+			if (submitAndWait(0, 1) < 0 && !SYSCALL_INTERRUPTED(errno))
+				ERR_bugcheck_msg("cannot wait for completion of io_uring requests");
+		}
+	}
+
+	IoUring* IoUring::getThreadRing()
+	{
+		static thread_local AutoPtr<IoUring> threadRing;
+
+		if (!threadRing && !unavailable)
+		{
+			AutoPtr<IoUring> ring(FB_NEW_POOL(*getDefaultMemoryPool()) IoUring);
+
+			if (ring->isValid())
+				threadRing = ring.release();
+			else
+			{
+				// Kernel is too old or io_uring is disabled, don't try again
+				const int error = errno;
+				unavailable = true;
+				gds__log("io_uring is not available (errno %d), synchronous page I/O is used", error);
+			}
+		}
+
+		return threadRing;
+	}
+}	// anonymous namespace
+
+#endif // USE_IO_URING
+
+
 void PIO_close(jrd_file* file)
 {
 /**************************************
@@ -763,10 +982,32 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
  *	Read a data page.  Oh wow.
  *
  **************************************/
-	int i;
-	SINT64 bytes;
-	FB_UINT64 offset;
+	if (file->fil_desc == -1)
+		return unix_error("read", file, isc_io_read_err, status_vector);
+
+	Database* const dbb = tdbb->getDatabase();
+
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
 
+	return read_page(file, bdb, page, dbb->dbb_page_size, status_vector);
+}
+
+
+bool PIO_read_batch(thread_db* tdbb, jrd_file* file, BufferDesc** bdbs, FB_SIZE_T count,
+	FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a set of pages into the buffers of given descriptors.
+ *	When io_uring is in use all reads of the batch are issued
+ *	at once, otherwise pages are read one by one.
+ *
+ **************************************/
 	if (file->fil_desc == -1)
 		return unix_error("read", file, isc_io_read_err, status_vector);
 
@@ -775,31 +1016,128 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
 
 	const SLONG size = dbb->dbb_page_size;
+	FB_SIZE_T done = 0;
 
-	for (i = 0; i < IO_RETRY; i++)
+#ifdef USE_IO_URING
+	IoUring* const ring = (file->fil_flags & FIL_io_uring) ? IoUring::getThreadRing() : NULL;
+
+	while (ring && done < count)
 	{
-		if (!seek_file(file, bdb, &offset, status_vector))
-			return false;
+		const FB_SIZE_T chunk = MIN(count - done, IoUring::RING_ENTRIES);
+		BufferDesc** const chunkBdbs = bdbs + done;
 
-		if ((bytes = os_utils::pread(file->fil_desc, page, size, LSEEK_OFFSET_CAST offset)) == size)
+		// Compute all offsets before the ring is touched, a failure
+		// must not leave requests staged in the ring
+
+		HalfStaticArray<FB_UINT64, IoUring::RING_ENTRIES> offsets;
+		offsets.grow(chunk);
+
+		for (FB_SIZE_T i = 0; i < chunk; i++)
 		{
-			// os_utils::posix_fadvise(file->desc, offset, size, POSIX_FADV_NOREUSE);
-			return true;
+			if (!seek_file(file, chunkBdbs[i], &offsets[i], status_vector))
+				return false;
 		}
 
-		// pread() returned error
-		if (bytes < 0 && !SYSCALL_INTERRUPTED(errno))
-			return unix_error("read", file, isc_io_read_err, status_vector);
+		for (FB_SIZE_T i = 0; i < chunk; i++)
+			ring->prepareRead(file->fil_desc, chunkBdbs[i]->bdb_buffer, size, offsets[i], i);
 
-		// pread() returned not enough bytes
-		if (bytes >= 0)
+		// Wait for all requests of the chunk, buffers must not be touched
+		// while the kernel still could write into them
+
+		HalfStaticArray<bool, IoUring::RING_ENTRIES> completed;
+		completed.grow(chunk);
+		memset(completed.begin(), 0, chunk * sizeof(bool));
+
+		FB_SIZE_T toSubmit = chunk, pending = chunk;
+
+		while (pending)
 		{
-			if (!block_size_error(file, offset + bytes, status_vector))
+			const int rc = ring->submitAndWait(toSubmit, 1);
+
+			if (rc < 0)
+			{
+				if (SYSCALL_INTERRUPTED(errno))
+					continue;
+
+				// Don't return while the submitted reads still could write into the buffers
+
+				const int error = errno;
+
+				ring->cancelPrepared(toSubmit);
+				ring->waitCompletions(pending - toSubmit);
+
+				errno = error;
+				return unix_error("io_uring_enter", file, isc_io_read_err, status_vector);
+			}
+
+			toSubmit -= MIN((FB_SIZE_T) rc, toSubmit);
+
+			unsigned tag;
+			int result;
+			while (ring->getCompletion(&tag, &result))
+			{
+				fb_assert(tag < chunk && !completed[tag]);
+				completed[tag] = (result == size);
+				pending--;
+			}
+		}
+
+		// Short reads and errors are retried synchronously, it also
+		// reports the error the same way as the single page read does
+
+		for (FB_SIZE_T i = 0; i < chunk; i++)
+		{
+			if (!completed[i] && !read_page(file, chunkBdbs[i], chunkBdbs[i]->bdb_buffer, size, status_vector))
 				return false;
 		}
+
+		done += chunk;
 	}
+#endif
 
-	return unix_error("read_retry", file, isc_io_read_err, status_vector);
+	for (; done < count; done++)
+	{
+		if (!read_page(file, bdbs[done], bdbs[done]->bdb_buffer, size, status_vector))
+			return false;
+	}
+
+	return true;
+}
+
+
+void PIO_advise_read(thread_db* tdbb, jrd_file* file, const ULONG* pages, FB_SIZE_T count)
+{
+/**************************************
+ *
+ *	P I O _ a d v i s e _ r e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Tell the OS that given pages are going to be read soon,
+ *	so it could start reading them into the file system cache.
+ *	Runs of adjacent pages are advised by single call.
+ *
+ **************************************/
+#ifdef POSIX_FADV_WILLNEED
+	if (file->fil_desc == -1 || (file->fil_flags & FIL_no_fs_cache))
+		return;
+
+	const FB_UINT64 size = tdbb->getDatabase()->dbb_page_size;
+
+	for (FB_SIZE_T i = 0; i < count; )
+	{
+		FB_SIZE_T n = 1;
+		while (i + n < count && pages[i + n] == pages[i] + n)
+			n++;
+
+		const FB_UINT64 offset = (FB_UINT64) pages[i] * size;
+		if (offset == (FB_UINT64) LSEEK_OFFSET_CAST offset)
+			os_utils::posix_fadvise(file->fil_desc, offset, n * size, POSIX_FADV_WILLNEED);
+
+		i += n;
+	}
+#endif
 }
 
 
@@ -847,6 +1185,49 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+static bool read_page(jrd_file* file, BufferDesc* bdb, Ods::pag* page, SLONG size,
+					  FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	r e a d _ p a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a single page, retrying on interrupts and short reads.
+ *
+ **************************************/
+	SINT64 bytes;
+	FB_UINT64 offset;
+
+	for (int i = 0; i < IO_RETRY; i++)
+	{
+		if (!seek_file(file, bdb, &offset, status_vector))
+			return false;
+
+		if ((bytes = os_utils::pread(file->fil_desc, page, size, LSEEK_OFFSET_CAST offset)) == size)
+		{
+			// os_utils::posix_fadvise(file->desc, offset, size, POSIX_FADV_NOREUSE);
+			return true;
+		}
+
+		// pread() returned error
+		if (bytes < 0 && !SYSCALL_INTERRUPTED(errno))
+			return unix_error("read", file, isc_io_read_err, status_vector);
+
+		// pread() returned not enough bytes
+		if (bytes >= 0)
+		{
+			if (!block_size_error(file, offset + bytes, status_vector))
+				return false;
+		}
+	}
+
+	return unix_error("read_retry", file, isc_io_read_err, status_vector);
+}
+
+
 static bool seek_file(jrd_file* file, BufferDesc* bdb, FB_UINT64* offset,
 					  FbStatusVector* status_vector)
 {
@@ -947,6 +1328,11 @@ static jrd_file* setup_file(Database* dbb, const PathName& file_name, int desc,
  **************************************/
 	jrd_file* file = NULL;
 
+#ifdef USE_IO_URING
+	if (NoCaseString(dbb->dbb_config->getIOEngine()) == IOEngineIoUring)
+		flags |= FIL_io_uring;
+#endif
+
 	try
 	{
 		file = FB_NEW_RPT(*dbb->dbb_permanent, file_name.length() + 1) jrd_file();
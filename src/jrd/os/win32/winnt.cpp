@@ -572,6 +572,45 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_read_batch(thread_db* tdbb, jrd_file* file, BufferDesc** bdbs, FB_SIZE_T count,
+	FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ b a t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a set of pages into the buffers of given descriptors.
+ *
+ **************************************/
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		if (!PIO_read(tdbb, file, bdbs[i], bdbs[i]->bdb_buffer, status_vector))
+			return false;
+	}
+
+	return true;
+}
+
+
+void PIO_advise_read(thread_db*, jrd_file*, const ULONG*, FB_SIZE_T)
+{
+/**************************************
+ *
+ *	P I O _ a d v i s e _ r e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Tell the OS that given pages are going to be read soon.
+ *	Nothing to do here, Windows has its own read-ahead logic.
+ *
+ **************************************/
+}
+
+
 #ifdef SUPERSERVER_V2
 bool PIO_read_ahead(thread_db*	tdbb,
 				   SLONG	start_page,
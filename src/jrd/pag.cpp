@@ -1212,6 +1212,11 @@ void PAG_init(thread_db* tdbb)
 	dbb->dbb_prefetch_sequence = PREFETCH_MAX_TRANSFER / dbb->dbb_page_size;
 	dbb->dbb_prefetch_pages = dbb->dbb_prefetch_sequence * 2;
 #endif
+
+	// Sequential scans request the next read-ahead when half of the pages
+	// read ahead before are consumed, so the scan doesn't wait for them.
+	dbb->dbb_read_ahead_pages = READ_AHEAD_MAX_TRANSFER / dbb->dbb_page_size;
+	dbb->dbb_read_ahead_sequence = MAX(dbb->dbb_read_ahead_pages / 2, 1);
 }
 
 
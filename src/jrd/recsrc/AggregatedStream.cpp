@@ -18,12 +18,16 @@
  */
 
 #include "firebird.h"
+#include "../common/classes/Aligner.h"
+#include "../common/classes/Hash.h"
 #include "../jrd/jrd.h"
+#include "../jrd/intl.h"
 #include "../dsql/Nodes.h"
 #include "../dsql/ExprNodes.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/exe_proto.h"
+#include "../jrd/intl_proto.h"
 #include "../jrd/mov_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/Attachment.h"
@@ -377,13 +381,557 @@ template class Jrd::BaseAggWinStream<WindowedStream::WindowStream, BaseBufferedS
 
 // ------------------------------
 
+// Hash aggregation keeps the state of every group in memory, so the records
+// may be consumed in any order. Memory is reserved from the temporary cache
+// in chunks. When the reservation fails, no more groups are added to the table
+// and the records of the other groups go to the sort that is aggregated in the
+// usual way after the groups of the hash table are returned.
+
+static constexpr double HASH_GROUP_RATIO = 0.1;			// max expected groups per input record
+static constexpr double HASH_MEMORY_SHARE = 0.5;		// max part of the temp cache to be used
+static constexpr ULONG HASH_CHUNK_SIZE = 1024 * 1024;	// memory is reserved and allocated in chunks
+static constexpr ULONG HASH_MIN_BUCKETS = 1024;			// initial size of the bucket directory
+
+class AggregatedStream::HashTable final : public PermanentStorage
+{
+public:
+	struct Group
+	{
+		Group* next;
+		ULONG hash;
+		// followed by the key, saved aggregate states and the record image
+	};
+
+	HashTable(MemoryPool& pool, Database* dbb, const Array<ULONG>& offsets,
+			  ULONG keyLength, ULONG recordLength)
+		: PermanentStorage(pool),
+		  m_dbb(dbb),
+		  m_offsets(offsets),
+		  m_keyLength(keyLength),
+		  m_recordLength(recordLength),
+		  m_chunks(pool),
+		  m_buckets(pool),
+		  m_keyBuffer(pool)
+	{
+		m_limit = (FB_UINT64) (dbb->dbb_config->getTempCacheLimit() * HASH_MEMORY_SHARE);
+		m_groupSize = FB_ALIGN(sizeof(Group) + m_keyLength +
+			m_offsets.getCount() * sizeof(impure_value_ex) + m_recordLength, FB_ALIGNMENT);
+		m_chunkSize = MAX(HASH_CHUNK_SIZE, m_groupSize);
+		m_keyBuffer.getBuffer(m_keyLength);
+	}
+
+	~HashTable()
+	{
+		for (auto chunk : m_chunks)
+			delete[] chunk;
+
+		if (m_reserved)
+			m_dbb->decTempCacheUsage(m_reserved);
+	}
+
+	UCHAR* getKeyBuffer()
+	{
+		return m_keyBuffer.begin();
+	}
+
+	ULONG getCount() const noexcept
+	{
+		return m_count;
+	}
+
+	Group* getCurrent() const noexcept
+	{
+		return m_current;
+	}
+
+	void setCurrent(Group* group) noexcept
+	{
+		m_current = group;
+	}
+
+	Group* getGroup(ULONG n) const
+	{
+		const ULONG perChunk = m_chunkSize / m_groupSize;
+		return (Group*) (m_chunks[n / perChunk] + (n % perChunk) * m_groupSize);
+	}
+
+	Group* find(ULONG hash, const UCHAR* key) const
+	{
+		if (m_buckets.isEmpty())
+			return nullptr;
+
+		for (Group* group = m_buckets[hash & (m_buckets.getCount() - 1)]; group; group = group->next)
+		{
+			if (group->hash == hash && !memcmp(getKey(group), key, m_keyLength))
+				return group;
+		}
+
+		return nullptr;
+	}
+
+	Group* add(ULONG hash, const UCHAR* key);
+
+	// Move the aggregate state between the request and the group
+	void save(Request* request, Record* record);
+	void restore(Request* request, Record* record, Group* group);
+	void reset(Request* request);
+
+	void release(Request* request);
+
+private:
+	const UCHAR* getKey(const Group* group) const
+	{
+		return reinterpret_cast<const UCHAR*>(group + 1);
+	}
+
+	UCHAR* getKey(Group* group) const
+	{
+		return reinterpret_cast<UCHAR*>(group + 1);
+	}
+
+	impure_value_ex* getStates(Group* group) const
+	{
+		return reinterpret_cast<impure_value_ex*>(getKey(group) + m_keyLength);
+	}
+
+	UCHAR* getRecord(Group* group) const
+	{
+		return reinterpret_cast<UCHAR*>(getStates(group) + m_offsets.getCount());
+	}
+
+	bool reserve(FB_SIZE_T size)
+	{
+		if (m_reserved + size > m_limit || !m_dbb->incTempCacheUsage(size))
+			return false;
+
+		m_reserved += size;
+		return true;
+	}
+
+	void rehash(ULONG count);
+
+	Database* const m_dbb;
+	const Array<ULONG>& m_offsets;
+	const ULONG m_keyLength;
+	const ULONG m_recordLength;
+	ULONG m_groupSize = 0;
+	ULONG m_chunkSize = 0;
+	FB_UINT64 m_limit = 0;
+	FB_UINT64 m_reserved = 0;
+	ULONG m_count = 0;
+	bool m_full = false;
+
+	Array<UCHAR*> m_chunks;
+	ULONG m_chunkUsed = 0;
+	Array<Group*> m_buckets;
+	Array<UCHAR> m_keyBuffer;
+	Group* m_current = nullptr;		// group whose state is in the request
+};
+
+AggregatedStream::HashTable::Group* AggregatedStream::HashTable::add(ULONG hash, const UCHAR* key)
+{
+	if (m_full)
+		return nullptr;
+
+	// The initial directory is mandatory, groups can't be linked without it
+
+	if (m_buckets.isEmpty())
+	{
+		if (!reserve(HASH_MIN_BUCKETS * sizeof(Group*)))
+		{
+			m_full = true;
+			return nullptr;
+		}
+
+		rehash(HASH_MIN_BUCKETS);
+	}
+
+	if (m_chunks.isEmpty() || m_chunkUsed + m_groupSize > m_chunkSize)
+	{
+		if (!reserve(m_chunkSize))
+		{
+			m_full = true;
+			return nullptr;
+		}
+
+		m_chunks.add(FB_NEW_POOL(getPool()) UCHAR[m_chunkSize]);
+		m_chunkUsed = 0;
+	}
+
+	// Keep the buckets short, but don't fail just because the directory can't grow
+
+	if (m_count >= m_buckets.getCount())
+	{
+		const ULONG count = m_buckets.getCount() * 2;
+
+		if (reserve((count - m_buckets.getCount()) * sizeof(Group*)))
+			rehash(count);
+	}
+
+	Group* const group = (Group*) (m_chunks.back() + m_chunkUsed);
+	m_chunkUsed += m_groupSize;
+	m_count++;
+
+	memcpy(getKey(group), key, m_keyLength);
+	group->hash = hash;
+
+	Group** const bucket = &m_buckets[hash & (m_buckets.getCount() - 1)];
+	group->next = *bucket;
+	*bucket = group;
+
+	return group;
+}
+
+void AggregatedStream::HashTable::rehash(ULONG count)
+{
+	m_buckets.resize(count, nullptr);
+	memset(m_buckets.begin(), 0, count * sizeof(Group*));
+
+	for (ULONG n = 0; n < m_count; n++)
+	{
+		Group* const group = getGroup(n);
+		Group** const bucket = &m_buckets[group->hash & (count - 1)];
+		group->next = *bucket;
+		*bucket = group;
+	}
+}
+
+void AggregatedStream::HashTable::save(Request* request, Record* record)
+{
+	if (!m_current)
+		return;
+
+	impure_value_ex* state = getStates(m_current);
+
+	for (const auto offset : m_offsets)
+		memcpy(state++, request->getImpure<impure_value_ex>(offset), sizeof(impure_value_ex));
+
+	record->copyDataTo(getRecord(m_current));
+}
+
+void AggregatedStream::HashTable::restore(Request* request, Record* record, Group* group)
+{
+	const impure_value_ex* state = getStates(group);
+
+	for (const auto offset : m_offsets)
+		memcpy(request->getImpure<impure_value_ex>(offset), state++, sizeof(impure_value_ex));
+
+	record->copyDataFrom(getRecord(group));
+	m_current = group;
+}
+
+// Detach the request from the current group, so that a new group can be initialized.
+// Strings of the aggregate states are owned by the groups.
+void AggregatedStream::HashTable::reset(Request* request)
+{
+	for (const auto offset : m_offsets)
+		request->getImpure<impure_value_ex>(offset)->vlu_string = nullptr;
+
+	m_current = nullptr;
+}
+
+// Free the strings owned by the groups. The state of the current group
+// is in the request, its saved copy may be outdated.
+void AggregatedStream::HashTable::release(Request* request)
+{
+	for (ULONG n = 0; n < m_count; n++)
+	{
+		Group* const group = getGroup(n);
+
+		if (group == m_current)
+			continue;
+
+		impure_value_ex* state = getStates(group);
+
+		for (FB_SIZE_T i = 0; i < m_offsets.getCount(); i++, state++)
+			delete state->vlu_string;
+	}
+
+	for (const auto offset : m_offsets)
+	{
+		impure_value_ex* const state = request->getImpure<impure_value_ex>(offset);
+		delete state->vlu_string;
+		state->vlu_string = nullptr;
+	}
+
+	m_current = nullptr;
+}
+
 AggregatedStream::AggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
 			const NestValueArray* group, MapNode* map, RecordSource* next)
-	: BaseAggWinStream(tdbb, csb, stream, group, map, !group, next)
+	: BaseAggWinStream(tdbb, csb, stream, group, map, !group, next),
+	  m_keyDescs(csb->csb_pool),
+	  m_keyLengths(csb->csb_pool),
+	  m_stateOffsets(csb->csb_pool)
 {
 	fb_assert(map);
 }
 
+// Check whether the groups may be aggregated using a hash table rather than
+// by sorting the input. The sort is still used for groups that don't fit memory.
+bool AggregatedStream::setupHashing(thread_db* tdbb, CompilerScratch* csb, SortedStream* sort)
+{
+	fb_assert(m_group && sort);
+
+	for (const auto& source : m_groupMap->sourceList)
+	{
+		const AggNode* const aggNode = nodeAs<AggNode>(source);
+
+		if (!aggNode)
+			continue;
+
+		if (aggNode->distinct || aggNode->sort ||
+			!(aggNode->getCapabilities() & AggNode::CAP_RELOCATABLE_STATE))
+		{
+			m_stateOffsets.clear();
+			return false;
+		}
+
+		aggNode->getStateOffsets(m_stateOffsets);
+	}
+
+	ULONG keyLength = 0;
+
+	for (const auto& node : *m_group)
+	{
+		dsc desc;
+		const_cast<ValueExprNode*>(node.getObject())->getDesc(tdbb, csb, &desc);
+
+		if (desc.isBlob())
+		{
+			m_keyDescs.clear();
+			m_keyLengths.clear();
+			m_stateOffsets.clear();
+			return false;
+		}
+
+		USHORT length = desc.isText() ? desc.getStringLength() : desc.dsc_length;
+
+		if (IS_INTL_DATA(&desc))
+			length = INTL_key_length(tdbb, INTL_INDEX_TYPE(&desc), length);
+		else if (desc.isTime())
+			length = sizeof(ISC_TIME);
+		else if (desc.isTimeStamp())
+			length = sizeof(ISC_TIMESTAMP);
+		else if (desc.dsc_dtype == dtype_dec64)
+			length = Decimal64::getKeyLength();
+		else if (desc.dsc_dtype == dtype_dec128)
+			length = Decimal128::getKeyLength();
+
+		desc.dsc_address = nullptr;
+		m_keyDescs.add(desc);
+		m_keyLengths.add(length);
+
+		// Every key starts with the NULL indicator
+		keyLength += 1 + length;
+	}
+
+	// Hashing pays off if there are notably less groups than records
+	// and the expected groups fit the memory
+
+	const double groupSize = sizeof(HashTable::Group) + keyLength +
+		m_stateOffsets.getCount() * sizeof(impure_value_ex) + m_format->fmt_length;
+	const double memoryLimit =
+		tdbb->getDatabase()->dbb_config->getTempCacheLimit() * HASH_MEMORY_SHARE;
+
+	if (m_cardinality > m_next->getCardinality() * HASH_GROUP_RATIO ||
+		m_cardinality * groupSize > memoryLimit)
+	{
+		m_keyDescs.clear();
+		m_keyLengths.clear();
+		m_stateOffsets.clear();
+		return false;
+	}
+
+	m_keyLength = keyLength;
+	m_hashSort = sort;
+	m_hashSort->setInterceptor(this);
+
+	return true;
+}
+
+void AggregatedStream::internalOpen(thread_db* tdbb) const
+{
+	if (m_hashSort)
+	{
+		Request* const request = tdbb->getRequest();
+		Impure* const impure = request->getImpure<Impure>(m_impure);
+
+		// Get rid of the old hash table if this request has been used already
+		releaseHashTable(request);
+
+		// Aggregate states are going to be owned by the groups
+		for (const auto offset : m_stateOffsets)
+		{
+			impure_value_ex* const state = request->getImpure<impure_value_ex>(offset);
+			delete state->vlu_string;
+			state->vlu_string = nullptr;
+		}
+
+		impure->irsb_hash_table = FB_NEW_POOL(*tdbb->getDefaultPool())
+			HashTable(*tdbb->getDefaultPool(), tdbb->getDatabase(), m_stateOffsets,
+					  m_keyLength, m_format->fmt_length);
+		impure->irsb_hash_position = 0;
+	}
+
+	// The input records are passed to intercept() while the sort is being filled
+	BaseAggWinStream::internalOpen(tdbb);
+}
+
+void AggregatedStream::close(thread_db* tdbb) const
+{
+	BaseAggWinStream::close(tdbb);
+
+	if (m_hashSort)
+		releaseHashTable(tdbb->getRequest());
+}
+
+// Aggregate the current input record into its group of the hash table.
+// Return false if the group is not there and cannot be added.
+bool AggregatedStream::intercept(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+	HashTable* const table = impure->irsb_hash_table;
+	Record* const record = request->req_rpb[m_stream].rpb_record;
+
+	UCHAR* const key = table->getKeyBuffer();
+	const ULONG hash = makeKey(tdbb, request, key);
+
+	HashTable::Group* group = table->find(hash, key);
+
+	if (group)
+	{
+		if (group != table->getCurrent())
+		{
+			table->save(request, record);
+			table->restore(request, record, group);
+		}
+	}
+	else
+	{
+		// Once a group is refused, it must go to the sort as a whole,
+		// so the table never accepts new groups after that
+
+		if (!(group = table->add(hash, key)))
+			return false;
+
+		table->save(request, record);
+		table->reset(request);
+		aggInit(tdbb, request, m_groupMap);
+		table->setCurrent(group);
+	}
+
+	aggPass(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+
+	return true;
+}
+
+ULONG AggregatedStream::makeKey(thread_db* tdbb, Request* request, UCHAR* keyBuffer) const
+{
+	memset(keyBuffer, 0, m_keyLength);
+
+	UCHAR* keyPtr = keyBuffer;
+
+	for (FB_SIZE_T i = 0; i < m_group->getCount(); i++)
+	{
+		dsc* desc = EVL_expr(tdbb, request, (*m_group)[i]);
+		const dsc& keyDesc = m_keyDescs[i];
+		const USHORT keyLength = m_keyLengths[i];
+
+		if (!desc)
+		{
+			keyPtr += 1 + keyLength;
+			continue;
+		}
+
+		*keyPtr++ = 1;
+
+		if (keyDesc.isText())
+		{
+			dsc to;
+			to.makeText(keyLength, keyDesc.getTextType(), keyPtr);
+
+			if (IS_INTL_DATA(&keyDesc))
+			{
+				// Convert the INTL string into the binary comparable form
+				INTL_string_to_key(tdbb, INTL_INDEX_TYPE(&keyDesc), desc, &to, INTL_KEY_UNIQUE);
+			}
+			else
+			{
+				// This call ensures that the padding bytes are appended
+				MOV_move(tdbb, desc, &to, true);
+			}
+		}
+		else
+		{
+			// Expressions may return values of different types,
+			// bring them to the declared one to get comparable keys
+
+			SINT64 buffer[4];
+			dsc temp;
+
+			if (desc->dsc_dtype != keyDesc.dsc_dtype || desc->dsc_scale != keyDesc.dsc_scale)
+			{
+				fb_assert(keyDesc.dsc_length <= sizeof(buffer));
+				temp = keyDesc;
+				temp.dsc_address = (UCHAR*) buffer;
+				MOV_move(tdbb, desc, &temp);
+				desc = &temp;
+			}
+
+			const auto* const data = desc->dsc_address;
+
+			if (desc->isDecFloat())
+			{
+				// Values inside our key buffer are not aligned,
+				// so ensure we satisfy our platform's alignment rules
+				OutAligner<ULONG, MAX_DEC_KEY_LONGS> key(keyPtr, keyLength);
+
+				if (desc->dsc_dtype == dtype_dec64)
+					((Decimal64*) data)->makeKey(key);
+				else
+					((Decimal128*) data)->makeKey(key);
+			}
+			else if (desc->dsc_dtype == dtype_real && *(float*) data == 0)
+			{
+				fb_assert(keyLength == sizeof(float));
+				memset(keyPtr, 0, keyLength); // positive zero in binary
+			}
+			else if (desc->dsc_dtype == dtype_double && *(double*) data == 0)
+			{
+				fb_assert(keyLength == sizeof(double));
+				memset(keyPtr, 0, keyLength); // positive zero in binary
+			}
+			else
+			{
+				// Note: for date/time with time zone, we copy only the UTC part.
+				fb_assert(keyLength <= desc->dsc_length);
+				memcpy(keyPtr, data, keyLength);
+			}
+		}
+
+		keyPtr += keyLength;
+	}
+
+	fb_assert(keyPtr - keyBuffer == m_keyLength);
+
+	return InternalHash::hash(m_keyLength, keyBuffer);
+}
+
+void AggregatedStream::releaseHashTable(Request* request) const
+{
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (impure->irsb_hash_table)
+	{
+		impure->irsb_hash_table->release(request);
+
+		delete impure->irsb_hash_table;
+		impure->irsb_hash_table = nullptr;
+	}
+}
+
 void AggregatedStream::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
 {
 	m_next->getLegacyPlan(tdbb, plan, level);
@@ -393,7 +941,7 @@ void AggregatedStream::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, un
 {
 	planEntry.className = "AggregatedStream";
 
-	planEntry.lines.add().text = "Aggregate";
+	planEntry.lines.add().text = m_hashSort ? "Hash Aggregate" : "Aggregate";
 	printOptInfo(planEntry.lines);
 
 	if (recurse)
@@ -409,7 +957,7 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 
 	Request* const request = tdbb->getRequest();
 	record_param* const rpb = &request->req_rpb[m_stream];
-	Impure* const impure = getImpure(request);
+	Impure* const impure = request->getImpure<Impure>(m_impure);
 
 	if (!(impure->irsb_flags & irsb_open))
 	{
@@ -417,6 +965,32 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 		return false;
 	}
 
+	if (m_hashSort)
+	{
+		// Return the groups of the hash table first,
+		// then aggregate the overflow records from the sort
+
+		HashTable* const table = impure->irsb_hash_table;
+
+		if (table)
+		{
+			if (!impure->irsb_hash_position)
+				table->save(request, rpb->rpb_record);
+
+			if (impure->irsb_hash_position < table->getCount())
+			{
+				const auto group = table->getGroup(impure->irsb_hash_position++);
+				table->restore(request, rpb->rpb_record, group);
+				aggExecute(tdbb, request, m_groupMap->sourceList, m_groupMap->targetList);
+
+				rpb->rpb_number.setValid(true);
+				return true;
+			}
+
+			releaseHashTable(request);
+		}
+	}
+
 	if (!evaluateGroup(tdbb))
 	{
 		rpb->rpb_number.setValid(false);
@@ -22,6 +22,7 @@
 #include "../jrd/btr.h"
 #include "../jrd/req.h"
 #include "../jrd/cmp_proto.h"
+#include "../jrd/dpm_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/vio_proto.h"
 #include "../jrd/rlck_proto.h"
@@ -54,6 +55,8 @@ void BitmapTableScan::internalOpen(thread_db* tdbb) const
 
 	impure->irsb_flags = irsb_open;
 	impure->irsb_bitmap = EVL_bitmap(tdbb, m_inversion, NULL);
+	impure->irsb_prefetch_sequence = 0;
+	impure->irsb_prefetch_trigger = 0;
 
 	record_param* const rpb = &request->req_rpb[m_stream];
 	RLCK_reserve_relation(tdbb, request->req_transaction, m_relation(), false);
@@ -109,8 +112,10 @@ bool BitmapTableScan::internalGetRecord(thread_db* tdbb) const
 		do
 		{
 			rpb->rpb_number.setValue(bitmap->current());
+			readAhead(tdbb, impure, rpb, bitmap);
 
-			if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool))
+			if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool) &&
+				checkFilter(tdbb))
 			{
 				rpb->rpb_number.setValid(true);
 				return true;
@@ -122,6 +127,42 @@ bool BitmapTableScan::internalGetRecord(thread_db* tdbb) const
 	return false;
 }
 
+void BitmapTableScan::readAhead(thread_db* tdbb, Impure* impure,
+								record_param* rpb, RecordBitmap* bitmap) const
+{
+	// Records are fetched in the data page order, but the pages may be scattered
+	// over the relation. Look ahead in the bitmap for the next distinct data pages
+	// and read them by single batch, again when a half of them is processed.
+
+	const Database* const dbb = tdbb->getDatabase();
+	const ULONG sequence = rpb->rpb_number.getValue() / dbb->dbb_max_records;
+
+	if (sequence < impure->irsb_prefetch_trigger)
+		return;
+
+	ULONG sequences[READ_AHEAD_MAX_PAGES];
+	FB_SIZE_T count = 0;
+
+	RecordBitmap::Accessor accessor(bitmap);
+	ULONG next = MAX(sequence, impure->irsb_prefetch_sequence);
+
+	while (count < dbb->dbb_read_ahead_pages &&
+		accessor.locate(locGreatEqual, (FB_UINT64) next * dbb->dbb_max_records))
+	{
+		sequences[count++] = next = accessor.current() / dbb->dbb_max_records;
+		next++;
+	}
+
+	impure->irsb_prefetch_sequence = next;
+	impure->irsb_prefetch_trigger = (count == dbb->dbb_read_ahead_pages) ?
+		sequences[count / 2] : MAX_ULONG;
+
+	// Single page is fetched by the regular way
+
+	if (count > 1)
+		DPM_read_ahead(tdbb, rpb, sequences, count);
+}
+
 void BitmapTableScan::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
 {
 	if (!level)
@@ -60,7 +60,7 @@ void FullTableScan::internalOpen(thread_db* tdbb) const
 	RLCK_reserve_relation(tdbb, request->req_transaction, m_relation(), false);
 
 	record_param* const rpb = &request->req_rpb[m_stream];
-	rpb->getWindow(tdbb).win_flags = 0;
+	rpb->getWindow(tdbb).win_flags = WIN_read_ahead;
 
 	// Unless this is the only attachment, limit the cache flushing
 	// effect of large sequential scans on the page working sets of
@@ -81,7 +81,7 @@ void FullTableScan::internalOpen(thread_db* tdbb) const
 
 		if (attachment->isGbak() || DPM_data_pages(tdbb, m_relation()) > bcb->bcb_count)
 		{
-			rpb->getWindow(tdbb).win_flags = WIN_large_scan;
+			rpb->getWindow(tdbb).win_flags |= WIN_large_scan;
 			rpb->rpb_org_scans = m_relation()->rel_scan_count++;
 		}
 	}
@@ -148,10 +148,13 @@ bool FullTableScan::internalGetRecord(thread_db* tdbb) const
 
 	const RecordNumber* upper = impure->irsb_upper.isValid() ? &impure->irsb_upper : nullptr;
 
-	if (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, upper))
+	while (VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all, upper))
 	{
-		rpb->rpb_number.setValid(true);
-		return true;
+		if (checkFilter(tdbb))
+		{
+			rpb->rpb_number.setValid(true);
+			return true;
+		}
 	}
 
 	rpb->rpb_number.setValid(false);
@@ -23,6 +23,8 @@
 #include "firebird.h"
 #include "../common/classes/Aligner.h"
 #include "../common/classes/Hash.h"
+#include "../common/StatusHolder.h"
+#include "../common/Task.h"
 #include "../jrd/jrd.h"
 #include "../jrd/req.h"
 #include "../jrd/intl.h"
@@ -43,210 +45,621 @@ using namespace Jrd;
 // Data access: hash join
 // ----------------------
 
-// NS: FIXME - Why use static hash table here??? Hash table shall support dynamic resizing
-static constexpr ULONG HASH_SIZE = 1009;
-static constexpr ULONG BUCKET_PREALLOCATE_SIZE = 32;	// 256 bytes per bucket
+// The hash table is radix partitioned: the high bits of the hash value select
+// a partition, the next bits select a bucket inside the partition. The number
+// of partitions is derived from the optimizer estimation while the number of
+// buckets is derived from the actual number of rows, so the buckets are kept
+// short regardless of the estimation quality. Partitions are built in parallel
+// if the attachment is allowed to use parallel workers.
+
+static constexpr ULONG PARTITION_SIZE = 16384;			// expected rows per partition
+static constexpr ULONG MAX_PARTITION_BITS = 10;			// up to 1024 partitions per stream
+static constexpr ULONG MAX_TABLE_BITS = 24;				// up to 16M buckets per stream
+static constexpr ULONG BUCKET_LOAD = 2;					// average rows per bucket
+static constexpr ULONG SMALL_BUCKET_SIZE = 16;			// insertion sort is used for smaller buckets
+static constexpr ULONG PARALLEL_BUILD_THRESHOLD = 65536;	// min rows to build partitions in parallel
+
+// Bloom filter over the join keys of the smallest inner stream is pushed down
+// into the scan of the leading stream, so the records without a match are
+// rejected before the upper level booleans are evaluated for them.
+// Eight bits per row and three probes give about 3% of false positives.
+
+static constexpr ULONG FILTER_BITS_PER_ROW = 8;
+static constexpr ULONG MIN_FILTER_BITS = 6;				// 64 bits
+static constexpr ULONG MAX_FILTER_BITS = 26;			// up to 8MB filter
+static constexpr ULONG FILTER_SEEDS[] = {0x9e3779b1, 0x85ebca77, 0xc2b2ae3d};
+
+static const char* const SCRATCH = "fb_hash_";
 
 unsigned HashJoin::maxCapacity() noexcept
 {
-	// Binary search across 1000 collisions is computationally similar to
-	// linear search across 10 collisions. We use this number as a rough
-	// estimation of whether the lookup performance is likely to be acceptable.
-	return HASH_SIZE * 1000;
+	// Lookup cost does not depend on the table size until all the directory
+	// bits are used up, after that the buckets become longer with every row
+	return (1u << MAX_TABLE_BITS) * BUCKET_LOAD;
 }
 
 
 class HashJoin::HashTable final : public PermanentStorage
 {
-	class CollisionList
+	struct Entry
 	{
-		static constexpr FB_SIZE_T INVALID_ITERATOR = FB_SIZE_T(~0);
-
-		struct Entry
-		{
-			Entry() noexcept
-				: hash(0), position(0)
-			{}
-
-			Entry(ULONG h, ULONG pos) noexcept
-				: hash(h), position(pos)
-			{}
-
-			static const ULONG generate(const Entry& item) noexcept
-			{
-				return item.hash;
-			}
-
-			ULONG hash;
-			ULONG position;
-		};
+		ULONG hash;
+		ULONG position;
+	};
 
+	class Partition
+	{
 	public:
-		CollisionList(MemoryPool& pool)
-			: m_collisions(pool, BUCKET_PREALLOCATE_SIZE),
-			  m_iterator(INVALID_ITERATOR)
-		{
-			m_collisions.setSortMode(FB_ARRAY_SORT_MANUAL);
-		}
+		explicit Partition(MemoryPool& pool)
+			: m_entries(pool), m_directory(pool), m_offset(0), m_spilled(false)
+		{}
 
-		void sort()
+		void add(ULONG hash, ULONG position)
 		{
-			m_collisions.sort();
+			Entry& entry = m_entries.add();
+			entry.hash = hash;
+			entry.position = position;
 		}
 
 		ULONG getCount() const noexcept
 		{
-			return (ULONG) m_collisions.getCount();
+			return m_directory.hasData() ? m_directory.back() : (ULONG) m_entries.getCount();
 		}
 
-		void add(ULONG hash, ULONG position)
+		FB_SIZE_T getSize() const noexcept
 		{
-			m_collisions.add(Entry(hash, position));
+			return m_entries.getCount() * sizeof(Entry);
 		}
 
-		bool locate(ULONG hash)
+		const Array<Entry>& getEntries() const noexcept
 		{
-			if (m_collisions.find(hash, m_iterator))
-				return true;
-
-			m_iterator = INVALID_ITERATOR;
-			return false;
+			return m_entries;
 		}
 
-		bool iterate(ULONG hash, ULONG& position) noexcept
-		{
-			if (m_iterator >= m_collisions.getCount())
-				return false;
+		void build(MemoryPool& pool, ULONG partitionBits, ULONG bucketBits);
+		void spill(TempSpace* space);
+		const Entry* locate(ULONG bucket, ULONG& count, Array<Entry>& buffer, TempSpace* space) const;
 
-			const Entry& collision = m_collisions[m_iterator++];
+	private:
+		Array<Entry> m_entries;		// ordered by bucket and by hash inside the bucket
+		Array<ULONG> m_directory;	// first entry of every bucket followed by the total count
+		offset_t m_offset;			// location of entries in the temp space
+		bool m_spilled;
+	};
 
-			if (hash != collision.hash)
-			{
-				m_iterator = INVALID_ITERATOR;
-				return false;
-			}
+	class Stream
+	{
+	public:
+		explicit Stream(MemoryPool& pool)
+			: m_partitions(pool), m_buffer(pool)
+		{}
 
-			position = collision.position;
-			return true;
+		~Stream()
+		{
+			for (auto partition : m_partitions)
+				delete partition;
 		}
 
-	private:
-		SortedArray<Entry, EmptyStorage<Entry>, ULONG, Entry> m_collisions;
-		FB_SIZE_T m_iterator;
+		ULONG m_partitionBits = 0;
+		ULONG m_bucketBits = 0;
+		ULONG m_count = 0;
+		Array<Partition*> m_partitions;
+
+		// Current bucket and iteration position inside it
+		Array<Entry> m_buffer;		// bucket entries read from the temp space
+		const Entry* m_bucket = nullptr;
+		ULONG m_bucketCount = 0;
+		ULONG m_first = 0;
+		ULONG m_iterator = 0;
 	};
 
+	class BuildTask;
+
 public:
-	HashTable(MemoryPool& pool, ULONG streamCount, ULONG tableSize = HASH_SIZE)
-		: PermanentStorage(pool), m_streamCount(streamCount),
-		  m_tableSize(tableSize), m_slot(0)
+	HashTable(MemoryPool& pool, ULONG streamCount)
+		: PermanentStorage(pool), m_streams(pool), m_filter(pool), m_filterShift(0),
+		  m_dbb(nullptr), m_cacheUsage(0)
 	{
-		m_collisions = FB_NEW_POOL(pool) CollisionList*[streamCount * tableSize];
-		memset(m_collisions, 0, streamCount * tableSize * sizeof(CollisionList*));
+		for (ULONG i = 0; i < streamCount; i++)
+			m_streams.add(FB_NEW_POOL(pool) Stream(pool));
 	}
 
 	~HashTable()
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
-			delete m_collisions[i];
+		for (auto stream : m_streams)
+			delete stream;
 
-		delete[] m_collisions;
+		if (m_cacheUsage)
+			m_dbb->decTempCacheUsage(m_cacheUsage);
 	}
 
-	void put(ULONG stream, ULONG hash, ULONG position)
+	void prepare(ULONG stream, double cardinality)
 	{
-		const ULONG slot = hash % m_tableSize;
+		fb_assert(stream < m_streams.getCount());
 
-		fb_assert(stream < m_streamCount);
-		fb_assert(slot < m_tableSize);
+		Stream* const str = m_streams[stream];
+		fb_assert(str->m_partitions.isEmpty());
 
-		CollisionList* collisions = m_collisions[stream * m_tableSize + slot];
-
-		if (!collisions)
+		while (str->m_partitionBits < MAX_PARTITION_BITS &&
+			((double) PARTITION_SIZE * (1u << str->m_partitionBits)) < cardinality)
 		{
-			collisions = FB_NEW_POOL(getPool()) CollisionList(getPool());
-			m_collisions[stream * m_tableSize + slot] = collisions;
+			str->m_partitionBits++;
 		}
 
-		collisions->add(hash, position);
+		const ULONG count = 1u << str->m_partitionBits;
+		for (ULONG i = 0; i < count; i++)
+			str->m_partitions.add(FB_NEW_POOL(getPool()) Partition(getPool()));
 	}
 
-	bool setup(ULONG hash)
+	void put(ULONG stream, ULONG hash, ULONG position)
 	{
-		const ULONG slot = hash % m_tableSize;
+		fb_assert(stream < m_streams.getCount());
+
+		Stream* const str = m_streams[stream];
+		str->m_partitions[getPartition(str, hash)]->add(hash, position);
+		str->m_count++;
+	}
 
-		for (ULONG i = 0; i < m_streamCount; i++)
+	bool setup(ULONG hash)
+	{
+		for (auto str : m_streams)
 		{
-			CollisionList* const collisions = m_collisions[i * m_tableSize + slot];
+			const Partition* const partition = str->m_partitions[getPartition(str, hash)];
+
+			ULONG count;
+			const Entry* const bucket =
+				partition->locate(getBucket(str, hash), count, str->m_buffer, m_space);
+
+			// Find the first entry with the given hash
 
-			if (!collisions)
+			ULONG lowBound = 0, highBound = count;
+			while (highBound > lowBound)
+			{
+				const ULONG temp = (highBound + lowBound) >> 1;
+				if (hash > bucket[temp].hash)
+					lowBound = temp + 1;
+				else
+					highBound = temp;
+			}
+
+			if (lowBound == count || bucket[lowBound].hash != hash)
 				return false;
 
-			if (!collisions->locate(hash))
+			str->m_bucket = bucket;
+			str->m_bucketCount = count;
+			str->m_first = str->m_iterator = lowBound;
+		}
+
+		return true;
+	}
+
+	bool check(ULONG hash) const noexcept
+	{
+		if (m_filter.isEmpty())
+			return true;
+
+		for (const auto seed : FILTER_SEEDS)
+		{
+			const ULONG bit = (hash * seed) >> m_filterShift;
+
+			if (!(m_filter[bit / 32] & (1u << (bit % 32))))
 				return false;
 		}
 
-		m_slot = slot;
 		return true;
 	}
 
 	void reset(ULONG stream, ULONG hash)
 	{
-		fb_assert(stream < m_streamCount);
+		fb_assert(stream < m_streams.getCount());
 
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		collisions->locate(hash);
+		Stream* const str = m_streams[stream];
+		fb_assert(str->m_bucket && str->m_bucket[str->m_first].hash == hash);
+
+		str->m_iterator = str->m_first;
 	}
 
 	bool iterate(ULONG stream, ULONG hash, ULONG& position) noexcept
 	{
-		fb_assert(stream < m_streamCount);
+		fb_assert(stream < m_streams.getCount());
+
+		Stream* const str = m_streams[stream];
 
-		CollisionList* const collisions = m_collisions[stream * m_tableSize + m_slot];
-		return collisions->iterate(hash, position);
+		if (str->m_iterator >= str->m_bucketCount)
+			return false;
+
+		const Entry& entry = str->m_bucket[str->m_iterator];
+
+		if (entry.hash != hash)
+		{
+			str->m_iterator = str->m_bucketCount;
+			return false;
+		}
+
+		str->m_iterator++;
+		position = entry.position;
+		return true;
 	}
 
-	void sort()
+	void build(thread_db* tdbb);
+
+private:
+	void buildFilter();
+
+	static ULONG getPartition(const Stream* stream, ULONG hash) noexcept
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
+		return stream->m_partitionBits ? hash >> (32 - stream->m_partitionBits) : 0;
+	}
+
+	static ULONG getBucket(const Stream* stream, ULONG hash) noexcept
+	{
+		return stream->m_bucketBits ?
+			(hash << stream->m_partitionBits) >> (32 - stream->m_bucketBits) : 0;
+	}
+
+	HalfStaticArray<Stream*, 4> m_streams;
+	Array<ULONG> m_filter;			// bloom filter over the smallest stream
+	ULONG m_filterShift;
+	AutoPtr<TempSpace> m_space;		// partitions which didn't fit the temp cache
+	Database* m_dbb;
+	FB_SIZE_T m_cacheUsage;			// memory accounted in the temp cache
+};
+
+
+// Builds partitions of the hash table using parallel workers
+
+class HashJoin::HashTable::BuildTask final : public Task
+{
+	class Item final : public Task::WorkItem
+	{
+	public:
+		explicit Item(BuildTask* task)
+			: Task::WorkItem(task)
+		{}
+
+		Stream* m_stream = nullptr;
+		Partition* m_partition = nullptr;
+	};
+
+public:
+	BuildTask(MemoryPool& pool, HashTable* table, int workers)
+		: m_pool(pool), m_table(table), m_items(pool), m_workers(workers),
+		  m_stream(0), m_partition(0), m_stop(false)
+	{}
+
+	~BuildTask()
+	{
+		for (auto item : m_items)
+			delete item;
+	}
+
+	bool handler(WorkItem& _item) override
+	{
+		Item* const item = static_cast<Item*>(&_item);
+
+		try
 		{
-			if (const auto collisions = m_collisions[i])
-				collisions->sort();
+			item->m_partition->build(m_pool, item->m_stream->m_partitionBits,
+				item->m_stream->m_bucketBits);
+			return true;
 		}
+		catch (const Exception& ex)
+		{
+			FbLocalStatus status;
+			ex.stuffException(&status);
 
-#ifdef PRINT_HASH_TABLE
-		FB_UINT64 total = 0;
-		ULONG min = MAX_ULONG, max = 0, count = 0;
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			if (m_status.isSuccess())
+				m_status.save(&status);
+			m_stop = true;
+		}
+
+		return false;
+	}
+
+	bool getWorkItem(WorkItem** pItem) override
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
 
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
+		while (!m_stop && m_stream < m_table->m_streams.getCount())
 		{
-			CollisionList* const collisions = m_collisions[i];
-			if (!collisions)
+			Stream* const stream = m_table->m_streams[m_stream];
+
+			if (m_partition < stream->m_partitions.getCount())
+			{
+				Item* item = static_cast<Item*>(*pItem);
+				if (!item)
+				{
+					item = FB_NEW_POOL(m_pool) Item(this);
+					m_items.add(item);
+					*pItem = item;
+				}
+
+				item->m_stream = stream;
+				item->m_partition = stream->m_partitions[m_partition++];
+				return true;
+			}
+
+			m_stream++;
+			m_partition = 0;
+		}
+
+		return false;
+	}
+
+	bool getResult(IStatus* status) override
+	{
+		if (status)
+		{
+			status->init();
+			status->setErrors(m_status.getErrors());
+		}
+
+		return m_status.isSuccess();
+	}
+
+	int getMaxWorkers() override
+	{
+		return m_workers;
+	}
+
+private:
+	MemoryPool& m_pool;
+	HashTable* const m_table;
+	Mutex m_mutex;
+	HalfStaticArray<Item*, 8> m_items;
+	StatusHolder m_status;
+	const int m_workers;
+	ULONG m_stream;
+	ULONG m_partition;
+	bool m_stop;
+};
+
+
+void HashJoin::HashTable::Partition::build(MemoryPool& pool, ULONG partitionBits, ULONG bucketBits)
+{
+	const ULONG bucketCount = 1u << bucketBits;
+	const ULONG count = (ULONG) m_entries.getCount();
+
+	m_directory.resize(bucketCount + 1, 0);
+
+	if (!count)
+		return;
+
+	const ULONG shift = 32 - bucketBits;
+	const auto getBucket = [partitionBits, bucketBits, shift] (ULONG hash)
+	{
+		return bucketBits ? (hash << partitionBits) >> shift : 0;
+	};
+
+	// Distribute entries between buckets preserving their order
+
+	for (const auto& entry : m_entries)
+		m_directory[getBucket(entry.hash) + 1]++;
+
+	for (ULONG i = 1; i <= bucketCount; i++)
+		m_directory[i] += m_directory[i - 1];
+
+	Array<ULONG> fill(pool);
+	fill.assign(m_directory.begin(), bucketCount);
+
+	Array<Entry> sorted(pool);
+	Entry* const target = sorted.getBuffer(count);
+
+	for (const auto& entry : m_entries)
+		target[fill[getBucket(entry.hash)]++] = entry;
+
+	// Order every bucket by hash, the original order of equal hashes is preserved
+
+	for (ULONG i = 0; i < bucketCount; i++)
+	{
+		Entry* const bucket = target + m_directory[i];
+		const ULONG length = m_directory[i + 1] - m_directory[i];
+
+		if (length <= 1)
+			continue;
+
+		if (length <= SMALL_BUCKET_SIZE)
+		{
+			for (ULONG j = 1; j < length; j++)
+			{
+				const Entry entry = bucket[j];
+
+				ULONG k = j;
+				for (; k && bucket[k - 1].hash > entry.hash; k--)
+					bucket[k] = bucket[k - 1];
+
+				bucket[k] = entry;
+			}
+		}
+		else
+		{
+			qsort(bucket, length, sizeof(Entry), [] (const void* a, const void* b) {
+				const Entry* const first = static_cast<const Entry*>(a);
+				const Entry* const second = static_cast<const Entry*>(b);
+
+				if (first->hash != second->hash)
+					return first->hash > second->hash ? 1 : -1;
+
+				if (first->position != second->position)
+					return first->position > second->position ? 1 : -1;
+
+				return 0;
+			});
+		}
+	}
+
+	memcpy(m_entries.begin(), target, count * sizeof(Entry));
+}
+
+void HashJoin::HashTable::Partition::spill(TempSpace* space)
+{
+	fb_assert(!m_spilled);
+
+	m_offset = space->getSize();
+	space->write(m_offset, m_entries.begin(), getSize());
+
+	m_entries.free();
+	m_spilled = true;
+}
+
+const HashJoin::HashTable::Entry* HashJoin::HashTable::Partition::locate(ULONG bucket,
+	ULONG& count, Array<Entry>& buffer, TempSpace* space) const
+{
+	fb_assert(bucket + 1 < m_directory.getCount());
+
+	const ULONG first = m_directory[bucket];
+	count = m_directory[bucket + 1] - first;
+
+	if (!m_spilled || !count)
+		return m_entries.begin() + first;
+
+	// Read the only bucket we need from the temp space
+
+	Entry* const entries = buffer.getBuffer(count, false);
+	space->read(m_offset + (offset_t) first * sizeof(Entry), entries, count * sizeof(Entry));
+	return entries;
+}
+
+void HashJoin::HashTable::build(thread_db* tdbb)
+{
+	Database* const dbb = tdbb->getDatabase();
+	Attachment* const attachment = tdbb->getAttachment();
+
+	// Now the actual number of rows is known, size the bucket directories
+
+	ULONG total = 0, partitions = 0;
+
+	for (auto str : m_streams)
+	{
+		ULONG tableBits = 0;
+		while (tableBits < MAX_TABLE_BITS && (1u << tableBits) * BUCKET_LOAD < str->m_count)
+			tableBits++;
+
+		str->m_bucketBits = (tableBits > str->m_partitionBits) ? tableBits - str->m_partitionBits : 0;
+
+		total += str->m_count;
+		partitions += str->m_partitions.getCount();
+	}
+
+	const int workers = MIN(attachment->att_parallel_workers, (int) partitions);
+
+	if (workers > 1 && total >= PARALLEL_BUILD_THRESHOLD)
+	{
+		BuildTask task(getPool(), this, workers);
+
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+
+		Coordinator coord(dbb->dbb_permanent);
+		coord.runSync(&task);
+
+		FbLocalStatus status;
+		if (!task.getResult(&status))
+			status.raise();
+	}
+	else
+	{
+		for (auto str : m_streams)
+		{
+			for (auto partition : str->m_partitions)
+				partition->build(getPool(), str->m_partitionBits, str->m_bucketBits);
+		}
+	}
+
+	buildFilter();
+
+	// Partitions share the memory limit with other temporary data.
+	// Those which don't fit it are moved into the temp space.
+
+	m_dbb = dbb;
+
+	for (auto str : m_streams)
+	{
+		for (auto partition : str->m_partitions)
+		{
+			const FB_SIZE_T size = partition->getSize();
+
+			if (!size)
+				continue;
+
+			if (dbb->incTempCacheUsage(size))
+			{
+				m_cacheUsage += size;
 				continue;
+			}
 
-			const auto cnt = collisions->getCount();
+			if (!m_space)
+				m_space = FB_NEW_POOL(getPool()) TempSpace(getPool(), SCRATCH, false);
+
+			partition->spill(m_space);
+		}
+	}
+
+#ifdef PRINT_HASH_TABLE
+	for (auto str : m_streams)
+	{
+		ULONG min = MAX_ULONG, max = 0, spilled = 0;
+
+		for (auto partition : str->m_partitions)
+		{
+			const auto cnt = partition->getCount();
 
 			if (cnt < min)
 				min = cnt;
 			if (cnt > max)
 				max = cnt;
-			total += cnt;
-			count++;
+			if (!partition->getSize() && cnt)
+				spilled++;
 		}
 
-		if (count)
-		{
-			printf("Hash table size %u, count %u, buckets %u, min %u, max %u, avg %u\n",
-				   m_tableSize, (ULONG) total, count, min, max, (ULONG) (total / count));
-		}
+		printf("Hash table rows %u, partitions %u (min %u, max %u, spilled %u), buckets per partition %u\n",
+			   str->m_count, (ULONG) str->m_partitions.getCount(), min, max, spilled,
+			   1u << str->m_bucketBits);
+	}
 #endif
+}
+
+
+void HashJoin::HashTable::buildFilter()
+{
+	// Every leading record must have a match in all the inner streams,
+	// so the smallest one is the most selective
+
+	const Stream* smallest = nullptr;
+
+	for (const auto str : m_streams)
+	{
+		if (!smallest || str->m_count < smallest->m_count)
+			smallest = str;
 	}
 
-private:
-	const ULONG m_streamCount;
-	const ULONG m_tableSize;
-	CollisionList** m_collisions;
-	ULONG m_slot;
-};
+	if (!smallest)
+		return;
+
+	ULONG bits = MIN_FILTER_BITS;
+	while (bits < MAX_FILTER_BITS && (1u << bits) / FILTER_BITS_PER_ROW < smallest->m_count)
+		bits++;
+
+	// Too big filter is not worth its memory, records are checked by the hash table anyway
+
+	if ((1u << bits) / FILTER_BITS_PER_ROW < smallest->m_count)
+		return;
+
+	m_filterShift = 32 - bits;
+	m_filter.resize(1u << (bits - 5), 0);
+
+	for (const auto partition : smallest->m_partitions)
+	{
+		for (const auto& entry : partition->getEntries())
+		{
+			for (const auto seed : FILTER_SEEDS)
+			{
+				const ULONG bit = (entry.hash * seed) >> m_filterShift;
+				m_filter[bit / 32] |= 1u << (bit % 32);
+			}
+		}
+	}
+}
 
 
 HashJoin::HashJoin(thread_db* tdbb, CompilerScratch* csb, JoinType joinType,
@@ -359,6 +772,32 @@ void HashJoin::init(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 	}
 
 	m_cardinality *= selectivity;
+
+	// Leading records without a match are useless for inner and semi joins.
+	// Push the hash table filter down into the leading stream if its keys
+	// are plain fields of a single stream, they cannot fail being evaluated
+	// earlier than the booleans placed between the join and the table scan.
+
+	if (m_joinType == JoinType::INNER || m_joinType == JoinType::SEMI)
+	{
+		std::optional<StreamType> stream;
+
+		for (const auto key : *m_leader.keys)
+		{
+			const auto field = nodeAs<FieldNode>(key);
+
+			if (!field || (stream.has_value() && field->fieldStream != stream.value()))
+			{
+				stream.reset();
+				break;
+			}
+
+			stream = field->fieldStream;
+		}
+
+		if (stream.has_value())
+			m_leader.source->pushFilter(this, stream.value());
+	}
 }
 
 void HashJoin::internalOpen(thread_db* tdbb) const
@@ -374,6 +813,8 @@ void HashJoin::internalOpen(thread_db* tdbb) const
 	delete[] impure->irsb_leader_buffer;
 	impure->irsb_leader_buffer = nullptr;
 
+	impure->irsb_leader_hashed = false;
+
 	m_leader.source->open(tdbb);
 }
 
@@ -445,6 +886,7 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 					// hash the join condition values and populate hash tables.
 
 					m_subs[i].buffer->open(tdbb);
+					impure->irsb_hash_table->prepare(i, m_subs[i].buffer->getCardinality());
 
 					ULONG counter = 0;
 					const auto keyBuffer = buffer.getBuffer(m_subs[i].totalKeyLength, false);
@@ -456,13 +898,19 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 					}
 				}
 
-				impure->irsb_hash_table->sort();
+				impure->irsb_hash_table->build(tdbb);
 			}
 
-			// Compute and hash the comparison keys
+			// Compute and hash the comparison keys, unless it's already done
+			// by the filter pushed down into the leading stream
 
-			impure->irsb_leader_hash =
-				computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+			if (impure->irsb_leader_hashed)
+				impure->irsb_leader_hashed = false;
+			else
+			{
+				impure->irsb_leader_hash =
+					computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+			}
 
 			// Ensure the every inner stream having matches for this hash slot.
 			// Setup the hash table for the iteration through collisions.
@@ -533,6 +981,27 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 	return true;
 }
 
+bool HashJoin::checkRecord(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	// Records read before the hash table is built are passed as is
+
+	if (!(impure->irsb_flags & irsb_open) || !impure->irsb_hash_table)
+		return true;
+
+	// The leading stream is either the table scan or the filter above it,
+	// so the record which passes the check is the next one returned to us
+	// and its hash may be reused
+
+	impure->irsb_leader_hash =
+		computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+	impure->irsb_leader_hashed = true;
+
+	return impure->irsb_hash_table->check(impure->irsb_leader_hash);
+}
+
 void HashJoin::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
 {
 	level++;
@@ -634,7 +1103,18 @@ ULONG HashJoin::computeHash(thread_db* tdbb,
 
 	fb_assert(keyPtr - keyBuffer == sub.totalKeyLength);
 
-	return InternalHash::hash(sub.totalKeyLength, keyBuffer);
+	ULONG hash = InternalHash::hash(sub.totalKeyLength, keyBuffer);
+
+	// The hash table is addressed by the high bits of the hash value,
+	// so mix them well (MurmurHash3 finalizer)
+
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6b;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35;
+	hash ^= hash >> 16;
+
+	return hash;
 }
 
 bool HashJoin::fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) const
@@ -25,6 +25,7 @@
 #include "../jrd/btr_proto.h"
 #include "../jrd/cch_proto.h"
 #include "../jrd/cmp_proto.h"
+#include "../jrd/dpm_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/met_proto.h"
 #include "../jrd/vio_proto.h"
@@ -67,6 +68,8 @@ void IndexTableScan::internalOpen(thread_db* tdbb) const
 	Impure* const impure = request->getImpure<Impure>(m_impure);
 
 	impure->irsb_flags = irsb_first | irsb_open;
+	impure->irsb_visible_page = MAX_ULONG;
+	impure->irsb_visible_epoch = 0;
 
 	record_param* const rpb = &request->req_rpb[m_stream];
 	RLCK_reserve_relation(tdbb, request->req_transaction, m_relation(), false);
@@ -252,6 +255,11 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 			{
 				page = (Ods::btree_page*) CCH_HANDOFF(tdbb, &window, page->btr_sibling, LCK_read, pag_index);
 				nextPointer = page->btr_nodes + page->btr_jump_size;
+
+				// Let the next leaf page be read while this one is processed
+				if (page->btr_sibling)
+					CCH_read_ahead(tdbb, window.win_page.getPageSpaceID(), &page->btr_sibling, 1);
+
 				continue;
 			}
 
@@ -332,6 +340,33 @@ bool IndexTableScan::internalGetRecord(thread_db* tdbb) const
 
 			CCH_RELEASE(tdbb, &window);
 
+			// If all record versions at the data page are visible to everyone,
+			// the referenced fields may be restored from the index key itself.
+			// Transaction number of such a record is unknown and set to zero.
+
+			if (m_indexOnly && isAllVisible(tdbb, impure, rpb))
+			{
+				const Format* const format = m_relation(tdbb)->currentFormat(tdbb);
+				Record* const record = VIO_record(tdbb, rpb, format, request->req_pool);
+				record->nullify();
+
+				rpb->rpb_format_number = format->fmt_version;
+				rpb->rpb_address = record->getData();
+				rpb->rpb_length = format->fmt_length;
+				rpb->rpb_transaction_nr = 0;
+
+				if (BTR_decode_key(tdbb, idx, key.key_data, key.key_length, record))
+				{
+					tdbb->bumpStats(RecordStatType::IDX_READS, m_relation()->getId());
+
+					RBM_SET(tdbb->getDefaultPool(), &impure->irsb_nav_records_visited,
+							rpb->rpb_number.getValue());
+
+					rpb->rpb_number.setValid(true);
+					return true;
+				}
+			}
+
 			if (VIO_get(tdbb, rpb, request->req_transaction, request->req_pool))
 			{
 				if (const auto result = recordKey.compose(rpb->rpb_record))
@@ -636,6 +671,33 @@ UCHAR* IndexTableScan::getStreamPosition(thread_db* tdbb, Impure* impure, win* w
 	return page->btr_nodes + page->btr_jump_size;
 }
 
+bool IndexTableScan::isAllVisible(thread_db* tdbb, Impure* impure, record_param* rpb) const
+{
+	// Index keys are ordered, so adjacent keys usually point to the same data page.
+	// Remember the last page found all visible and skip the pointer page fetch
+	// while no "all visible" bit of the relation has been reset since then.
+
+	if (rpb->rpb_number.getValue() < 0)
+		return false;
+
+	const Database* const dbb = tdbb->getDatabase();
+	const ULONG epoch = getPermanent(rpb->rpb_relation)->rel_visibility_epoch;
+	const ULONG dpSequence = (ULONG) (rpb->rpb_number.getValue() / dbb->dbb_max_records);
+
+	if (impure->irsb_visible_page == dpSequence && impure->irsb_visible_epoch == epoch)
+		return true;
+
+	// Epoch is read before the bit, so a reset racing with the check
+	// will make the remembered page stale rather than hidden
+
+	if (!DPM_all_visible(tdbb, rpb))
+		return false;
+
+	impure->irsb_visible_page = dpSequence;
+	impure->irsb_visible_epoch = epoch;
+	return true;
+}
+
 UCHAR* IndexTableScan::openStream(thread_db* tdbb, Impure* impure, win* window) const
 {
 	temporary_key* lower = impure->irsb_nav_current_lower;
@@ -0,0 +1,877 @@
+/*
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  The Original Code was created by the Firebird Project
+ *  for the Firebird Open Source RDBMS project.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/tra.h"
+#include "../jrd/met.h"
+#include "../common/classes/ClumpletWriter.h"
+#include "../common/classes/condition.h"
+#include "../common/StatusHolder.h"
+#include "../jrd/cch_proto.h"
+#include "../jrd/cmp_proto.h"
+#include "../jrd/dpm_proto.h"
+#include "../jrd/evl_proto.h"
+#include "../jrd/vio_proto.h"
+#include "../jrd/tra_proto.h"
+#include "../jrd/rlck_proto.h"
+#include "../jrd/Attachment.h"
+#include "../common/Task.h"
+#include "../jrd/WorkerAttachment.h"
+
+#include "RecordSource.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace Jrd
+{
+
+// Records of a relation read by parallel workers. Every worker scans whole
+// pointer pages using its own worker attachment and a read-only transaction
+// sharing the snapshot of the user transaction. Records are passed to the
+// request thread by batches, so the scan runs ahead of the request while the
+// request evaluates booleans and aggregates.
+
+class ParallelScan : public Task
+{
+	static const FB_SIZE_T BATCH_RECORDS = 512;		// max records per batch
+	static const FB_SIZE_T BATCH_DATA = 256 * 1024;	// max record data per batch, bytes
+
+	struct Entry
+	{
+		SINT64 number;
+		TraNumber transaction;
+		ULONG page;
+		ULONG f_page;
+		ULONG b_page;
+		USHORT line;
+		USHORT f_line;
+		USHORT b_line;
+		USHORT flags;
+		USHORT format;
+		ULONG offset;	// record data offset in the batch buffer
+		ULONG length;	// record data length
+	};
+
+	class Batch
+	{
+	public:
+		explicit Batch(MemoryPool& pool)
+			: entries(pool), data(pool), position(0)
+		{}
+
+		bool isFull() const
+		{
+			return entries.getCount() >= BATCH_RECORDS || data.getCount() >= BATCH_DATA;
+		}
+
+		void clear()
+		{
+			entries.clear();
+			data.clear();
+			position = 0;
+		}
+
+		Array<Entry> entries;
+		Array<UCHAR> data;
+		FB_SIZE_T position;
+	};
+
+public:
+	ParallelScan(thread_db* tdbb, MemoryPool& pool, const record_param* rpb,
+				 const ClumpletWriter& tpb, bool largeScan);
+	virtual ~ParallelScan();
+
+	static ParallelScan* create(thread_db* tdbb, const record_param* rpb, bool largeScan);
+
+	bool getRecord(thread_db* tdbb, record_param* rpb, MemoryPool* pool);
+	void stop(thread_db* tdbb);
+
+	bool handler(WorkItem& _item);
+	bool getWorkItem(WorkItem** pItem);
+
+	bool getResult(IStatus* status)
+	{
+		if (status)
+		{
+			status->init();
+			status->setErrors(m_status.getErrors());
+		}
+
+		return m_status.isSuccess();
+	}
+
+	int getMaxWorkers()
+	{
+		return MIN(m_items.getCount(), m_countPP);
+	}
+
+private:
+	class Item : public Task::WorkItem
+	{
+	public:
+		Item(ParallelScan* task) : Task::WorkItem(task),
+			m_inuse(false),
+			m_tra(NULL)
+		{}
+
+		virtual ~Item()
+		{
+			if (!m_attStable)
+				return;
+
+			Attachment* att = NULL;
+			{
+				AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+				att = m_attStable->getHandle();
+				if (!att)
+					return;
+				fb_assert(att->att_use_count > 0);
+			}
+
+			FbLocalStatus status;
+			if (m_tra)
+			{
+				BackgroundContextHolder tdbb(att->att_database, att, &status, FB_FUNCTION);
+				TRA_commit(tdbb, m_tra, false);
+			}
+			WorkerAttachment::releaseAttachment(&status, m_attStable);
+		}
+
+		ParallelScan* getScanTask() const
+		{
+			return reinterpret_cast<ParallelScan*> (m_task);
+		}
+
+		bool init(thread_db* tdbb)
+		{
+			FbStatusVector* status = tdbb->tdbb_status_vector;
+			ParallelScan* const task = getScanTask();
+
+			Attachment* att = NULL;
+
+			if (!m_attStable.hasData())
+				m_attStable = WorkerAttachment::getAttachment(status, task->m_dbb);
+
+			if (m_attStable)
+				att = m_attStable->getHandle();
+
+			if (!att)
+			{
+				if (!status->hasData())
+					Arg::Gds(isc_bad_db_handle).copyTo(status);
+
+				return false;
+			}
+
+			tdbb->setDatabase(att->att_database);
+			tdbb->setAttachment(att);
+
+			if (!m_tra)
+			{
+				try
+				{
+					WorkerContextHolder holder(tdbb, FB_FUNCTION);
+					m_tra = TRA_start(tdbb, task->m_tpb.getCount(), task->m_tpb.begin());
+				}
+				catch (const Exception& ex)
+				{
+					ex.stuffException(tdbb->tdbb_status_vector);
+					return false;
+				}
+			}
+
+			tdbb->setTransaction(m_tra);
+
+			return true;
+		}
+
+		bool m_inuse;
+		RefPtr<StableAttachmentPart> m_attStable;
+		jrd_tra* m_tra;
+	};
+
+	static THREAD_ENTRY_DECLARE runScan(THREAD_ENTRY_PARAM arg);
+
+	bool getPointerPage(ULONG* sequence);
+	bool getOwnRecord(thread_db* tdbb, record_param* rpb, MemoryPool* pool);
+	Batch* getFreeBatch();
+	bool putBatch(thread_db* tdbb, Batch* batch);
+	Batch* getBatch(thread_db* tdbb);
+	void finish();
+
+	void setError(IStatus* status, bool stopTask)
+	{
+		const bool copyStatus = (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS);
+		if (!copyStatus && (!stopTask || m_stop))
+			return;
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+		if (m_status.isSuccess() && copyStatus)
+			m_status.save(status);
+		if (stopTask)
+		{
+			m_stop = true;
+			m_freeCond.notifyAll();
+		}
+	}
+
+	MemoryPool& m_pool;
+	Database* m_dbb;
+	const USHORT m_relationId;
+	const bool m_noData;
+	const bool m_largeScan;
+	Array<UCHAR> m_tpb;
+
+	Mutex m_mutex;
+	Condition m_readyCond;			// signalled when batch is ready or scan is finished
+	Condition m_freeCond;			// signalled when there is a room for the next batch
+	HalfStaticArray<Item*, 8> m_items;
+	Array<Batch*> m_ready;			// batches filled by workers, in order of arrival
+	Array<Batch*> m_free;			// batches consumed by the request
+	Batch* m_current;				// batch the request is reading from
+	FB_SIZE_T m_maxReady;
+	StatusHolder m_status;
+	Thread m_thread;
+	volatile bool m_stop;
+	bool m_finished;
+	bool m_ownScan;					// request reads pointer page left by workers
+	const ULONG m_countPP;
+	ULONG m_nextPP;
+};
+
+
+ParallelScan::ParallelScan(thread_db* tdbb, MemoryPool& pool, const record_param* rpb,
+						   const ClumpletWriter& tpb, bool largeScan)
+	: Task(),
+	  m_pool(pool),
+	  m_dbb(tdbb->getDatabase()),
+	  m_relationId(rpb->rpb_relation->getId()),
+	  m_noData(rpb->rpb_stream_flags & RPB_s_no_data),
+	  m_largeScan(largeScan),
+	  m_tpb(pool),
+	  m_items(pool),
+	  m_ready(pool),
+	  m_free(pool),
+	  m_current(NULL),
+	  m_maxReady(0),
+	  m_stop(false),
+	  m_finished(false),
+	  m_ownScan(false),
+	  m_countPP(DPM_pointer_pages(tdbb, rpb->rpb_relation)),
+	  m_nextPP(0)
+{
+	m_tpb.add(tpb.getBuffer(), tpb.getBufferLength());
+
+	const int workers = tdbb->getAttachment()->att_parallel_workers;
+
+	for (int i = 0; i < workers; i++)
+		m_items.add(FB_NEW_POOL(m_pool) Item(this));
+
+	// Let every worker have one batch queued while filling the next one
+	m_maxReady = m_items.getCount();
+}
+
+ParallelScan::~ParallelScan()
+{
+	for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		delete *p;
+
+	for (Batch** p = m_ready.begin(); p < m_ready.end(); p++)
+		delete *p;
+
+	for (Batch** p = m_free.begin(); p < m_free.end(); p++)
+		delete *p;
+
+	delete m_current;
+}
+
+ParallelScan* ParallelScan::create(thread_db* tdbb, const record_param* rpb, bool largeScan)
+{
+/**************************************
+ *
+ *	c r e a t e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Start parallel scan of the stream relation, if possible.
+ *	Return NULL if relation should be scanned by the request itself.
+ *
+ **************************************/
+	Attachment* const attachment = tdbb->getAttachment();
+	Request* const request = tdbb->getRequest();
+	jrd_tra* const transaction = request->req_transaction;
+
+	if (attachment->att_parallel_workers <= 1)
+		return NULL;
+
+	// Positioned updates and record locks need the record to be fetched
+	// by the request itself
+
+	if (rpb->rpb_stream_flags & (RPB_s_update | RPB_s_skipLocked | RPB_s_unstable))
+		return NULL;
+
+	// Worker transactions can't see our own changes
+
+	if ((transaction->tra_flags & (TRA_system | TRA_write)) || transaction->tra_commit_sub_trans)
+		return NULL;
+
+	// Workers use a snapshot transaction started at the same snapshot
+	// as the transaction or, for read consistency, as the statement
+
+	CommitNumber snapshot = transaction->tra_snapshot_number;
+
+	if (transaction->tra_flags & TRA_read_committed)
+	{
+		if (!(transaction->tra_flags & TRA_read_consistency))
+			return NULL;
+
+		const Request* const snapshotRequest = request->req_snapshot.m_owner;
+		if (!snapshotRequest || (snapshotRequest->req_flags & req_update_conflict))
+			return NULL;
+
+		snapshot = snapshotRequest->req_snapshot.m_number;
+	}
+
+	if (!snapshot)
+		return NULL;
+
+	// Don't bother for small relations
+
+	if (DPM_pointer_pages(tdbb, rpb->rpb_relation) < 2)
+		return NULL;
+
+	ClumpletWriter tpb(ClumpletReader::Tpb, MAX_DPB_SIZE, isc_tpb_version3);
+	tpb.insertTag(isc_tpb_concurrency);
+	tpb.insertTag(isc_tpb_read);
+	if (transaction->tra_flags & TRA_ignore_limbo)
+		tpb.insertTag(isc_tpb_ignore_limbo);
+	tpb.insertBigInt(isc_tpb_at_snapshot_number, snapshot);
+
+	MemoryPool& pool = *getDefaultMemoryPool();
+	AutoPtr<ParallelScan> scan(FB_NEW_POOL(pool) ParallelScan(tdbb, pool, rpb, tpb, largeScan));
+
+	Thread::start(runScan, scan, THREAD_medium, &scan->m_thread);
+
+	return scan.release();
+}
+
+THREAD_ENTRY_DECLARE ParallelScan::runScan(THREAD_ENTRY_PARAM arg)
+{
+	ParallelScan* const scan = static_cast<ParallelScan*>(arg);
+
+	try
+	{
+		Coordinator coord(scan->m_dbb->dbb_permanent);
+		coord.runSync(scan);
+	}
+	catch (const Exception& ex)
+	{
+		FbLocalStatus status;
+		ex.stuffException(&status);
+		scan->setError(&status, true);
+	}
+
+	scan->finish();
+	return 0;
+}
+
+void ParallelScan::finish()
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	// Pointer pages not taken by workers, e.g. when no worker
+	// attachment was free, are read by the request itself
+
+	m_finished = true;
+	m_readyCond.notifyAll();
+}
+
+void ParallelScan::stop(thread_db* tdbb)
+{
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		m_stop = true;
+		m_freeCond.notifyAll();
+	}
+
+	EngineCheckout cout(tdbb, FB_FUNCTION);
+
+	m_thread.waitForCompletion();
+
+	// Worker transactions are committed and worker attachments
+	// are released here, so our attachment should not be locked
+
+	for (Item** p = m_items.begin(); p < m_items.end(); p++)
+		delete *p;
+
+	m_items.clear();
+}
+
+bool ParallelScan::getWorkItem(WorkItem** pItem)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	// Every worker handles single item which reads pointer pages until
+	// none left, so the worker is done when asks for the next item
+
+	if (*pItem || m_stop)
+		return false;
+
+	for (Item** p = m_items.begin(); p < m_items.end(); p++)
+	{
+		if (!(*p)->m_inuse)
+		{
+			(*p)->m_inuse = true;
+			*pItem = *p;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool ParallelScan::getPointerPage(ULONG* sequence)
+{
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (m_stop || m_nextPP >= m_countPP)
+		return false;
+
+	*sequence = m_nextPP++;
+	return true;
+}
+
+bool ParallelScan::handler(WorkItem& _item)
+{
+	Item* item = reinterpret_cast<Item*>(&_item);
+
+	ThreadContextHolder tdbb(NULL);
+
+	// Pages are assigned to started workers only, pages left
+	// are read by the request after all workers are finished
+
+	if (!item->init(tdbb))
+		return false;
+
+	WorkerContextHolder wrkHolder(tdbb, FB_FUNCTION);
+
+	record_param rpb;
+	jrd_rel* relation = NULL;
+	Batch* batch = NULL;
+
+	try
+	{
+		Database* const dbb = tdbb->getDatabase();
+		jrd_tra* const transaction = tdbb->getTransaction();
+
+		relation = MetadataCache::getVersioned<Cached::Relation>(tdbb, m_relationId, CacheFlag::AUTOCREATE);
+		fb_assert(relation);
+
+		rpb.rpb_relation = relation;
+		rpb.rpb_record = NULL;
+		rpb.rpb_stream_flags = m_noData ? RPB_s_no_data : 0;
+		rpb.getWindow(tdbb).win_flags = WIN_read_ahead;
+
+		if (m_largeScan)
+		{
+			rpb.getWindow(tdbb).win_flags |= WIN_large_scan;
+			rpb.rpb_org_scans = getPermanent(relation)->rel_scan_count++;
+		}
+
+		ULONG sequence;
+		while (getPointerPage(&sequence))
+		{
+			rpb.rpb_number.compose(dbb->dbb_max_records, dbb->dbb_dp_per_pp, 0, 0, sequence);
+			rpb.rpb_number.decrement();
+
+			while (!m_stop &&
+				VIO_next_record(tdbb, &rpb, transaction, transaction->tra_pool, DPM_next_pointer_page))
+			{
+				if (!batch)
+					batch = getFreeBatch();
+
+				Entry& entry = batch->entries.add();
+				entry.number = rpb.rpb_number.getValue();
+				entry.transaction = rpb.rpb_transaction_nr;
+				entry.page = rpb.rpb_page;
+				entry.line = rpb.rpb_line;
+				entry.f_page = rpb.rpb_f_page;
+				entry.f_line = rpb.rpb_f_line;
+				entry.b_page = rpb.rpb_b_page;
+				entry.b_line = rpb.rpb_b_line;
+				entry.flags = rpb.rpb_flags;
+				entry.format = rpb.rpb_format_number;
+				entry.offset = batch->data.getCount();
+				entry.length = 0;
+
+				if (!m_noData)
+				{
+					const Record* const record = rpb.rpb_record;
+
+					entry.format = record->getFormat()->fmt_version;
+					entry.length = record->getLength();
+
+					batch->data.grow(entry.offset + entry.length);
+					record->copyDataTo(batch->data.begin() + entry.offset);
+				}
+
+				if (batch->isFull())
+				{
+					Batch* const full = batch;
+					batch = NULL;
+
+					if (!putBatch(tdbb, full))
+						break;
+				}
+
+				JRD_reschedule(tdbb);
+			}
+		}
+
+		if (batch)
+		{
+			Batch* const last = batch;
+			batch = NULL;
+
+			if (last->entries.hasData())
+				putBatch(tdbb, last);
+			else
+			{
+				MutexLockGuard guard(m_mutex, FB_FUNCTION);
+				m_free.push(last);
+			}
+		}
+
+		delete rpb.rpb_record;
+
+		if (m_largeScan)
+			--getPermanent(relation)->rel_scan_count;
+
+		return !m_stop;
+	}
+	catch (const Exception& ex)
+	{
+		ex.stuffException(tdbb->tdbb_status_vector);
+
+		delete batch;
+		delete rpb.rpb_record;
+
+		if (relation && m_largeScan && getPermanent(relation)->rel_scan_count)
+			--getPermanent(relation)->rel_scan_count;
+	}
+
+	setError(tdbb->tdbb_status_vector, true);
+	return false;
+}
+
+bool ParallelScan::getOwnRecord(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
+{
+/**************************************
+ *
+ *	g e t O w n R e c o r d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read the pointer pages left by workers using the request's own
+ *	attachment, as the first item of IndexCreateTask is handled.
+ *	Request transaction sees the same snapshot as workers do.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	jrd_tra* const transaction = tdbb->getRequest()->req_transaction;
+
+	while (true)
+	{
+		if (!m_ownScan)
+		{
+			ULONG sequence;
+			if (!getPointerPage(&sequence))
+				return false;
+
+			rpb->rpb_number.compose(dbb->dbb_max_records, dbb->dbb_dp_per_pp, 0, 0, sequence);
+			rpb->rpb_number.decrement();
+			m_ownScan = true;
+		}
+
+		if (VIO_next_record(tdbb, rpb, transaction, pool, DPM_next_pointer_page))
+			return true;
+
+		m_ownScan = false;
+	}
+}
+
+ParallelScan::Batch* ParallelScan::getFreeBatch()
+{
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_free.hasData())
+		{
+			Batch* const batch = m_free.pop();
+			batch->clear();
+			return batch;
+		}
+	}
+
+	return FB_NEW_POOL(m_pool) Batch(m_pool);
+}
+
+bool ParallelScan::putBatch(thread_db* tdbb, Batch* batch)
+{
+	EngineCheckout cout(tdbb, FB_FUNCTION);
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	while (!m_stop && m_ready.getCount() >= m_maxReady)
+		m_freeCond.wait(m_mutex);
+
+	if (m_stop)
+	{
+		m_free.push(batch);
+		return false;
+	}
+
+	m_ready.add(batch);
+	m_readyCond.notifyOne();
+
+	return true;
+}
+
+ParallelScan::Batch* ParallelScan::getBatch(thread_db* tdbb)
+{
+	EngineCheckout cout(tdbb, FB_FUNCTION);
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (m_current)
+	{
+		m_free.push(m_current);
+		m_current = NULL;
+	}
+
+	while (!m_ready.hasData() && !m_finished)
+		m_readyCond.wait(m_mutex);
+
+	if (!m_ready.hasData())
+		return NULL;
+
+	Batch* const batch = m_ready.front();
+	m_ready.remove((FB_SIZE_T) 0);
+	m_freeCond.notifyOne();
+
+	return batch;
+}
+
+bool ParallelScan::getRecord(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
+{
+/**************************************
+ *
+ *	g e t R e c o r d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Get the next record read by workers into the stream.
+ *
+ **************************************/
+	while (!m_current || m_current->position >= m_current->entries.getCount())
+	{
+		if (m_ownScan)
+			return getOwnRecord(tdbb, rpb, pool);
+
+		m_current = getBatch(tdbb);
+
+		if (!m_current)
+		{
+			FbLocalStatus status;
+			if (!getResult(&status))
+				status.raise();
+
+			return getOwnRecord(tdbb, rpb, pool);
+		}
+	}
+
+	const Entry& entry = m_current->entries[m_current->position++];
+
+	rpb->rpb_number.setValue(entry.number);
+	rpb->rpb_transaction_nr = entry.transaction;
+	rpb->rpb_page = entry.page;
+	rpb->rpb_line = entry.line;
+	rpb->rpb_f_page = entry.f_page;
+	rpb->rpb_f_line = entry.f_line;
+	rpb->rpb_b_page = entry.b_page;
+	rpb->rpb_b_line = entry.b_line;
+	rpb->rpb_flags = entry.flags;
+	rpb->rpb_format_number = entry.format;
+	rpb->rpb_runtime_flags &= ~RPB_CLEAR_FLAGS;
+	rpb->rpb_address = NULL;
+	rpb->rpb_length = 0;
+
+	if (!m_noData)
+	{
+		Record* const record = VIO_record(tdbb, rpb, NULL, pool);
+		fb_assert(record->getLength() == entry.length);
+
+		record->copyDataFrom(m_current->data.begin() + entry.offset);
+		record->setTransactionNumber(entry.transaction);
+	}
+
+	tdbb->bumpStats(RecordStatType::SEQ_READS, rpb->rpb_relation->getId());
+	return true;
+}
+
+} // namespace Jrd
+
+
+// ---------------------------------------------------
+// Data access: complete table scan by parallel workers
+// ---------------------------------------------------
+
+ParallelTableScan::ParallelTableScan(CompilerScratch* csb, const string& alias,
+									 StreamType stream, Rsc::Rel relation)
+	: RecordStream(csb, stream),
+	  m_alias(csb->csb_pool, alias),
+	  m_relation(relation)
+{
+	m_impure = csb->allocImpure<Impure>();
+	m_cardinality = csb->csb_rpt[stream].csb_cardinality;
+}
+
+void ParallelTableScan::internalOpen(thread_db* tdbb) const
+{
+	Database* const dbb = tdbb->getDatabase();
+	Attachment* const attachment = tdbb->getAttachment();
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	impure->irsb_flags = irsb_open;
+	impure->irsb_scan = NULL;
+
+	RLCK_reserve_relation(tdbb, request->req_transaction, m_relation(), false);
+
+	record_param* const rpb = &request->req_rpb[m_stream];
+	rpb->getWindow(tdbb).win_flags = WIN_read_ahead;
+	rpb->rpb_number.setValue(BOF_NUMBER);
+
+	// Limit the cache flushing effect of large sequential scans
+	// the same way as the full table scan does
+
+	bool largeScan = false;
+
+	if (attachment && (attachment != dbb->dbb_attachments || attachment->att_next))
+	{
+		BufferControl* const bcb = dbb->dbb_bcb;
+		largeScan = attachment->isGbak() || DPM_data_pages(tdbb, m_relation()) > bcb->bcb_count;
+	}
+
+	impure->irsb_scan = ParallelScan::create(tdbb, rpb, largeScan);
+
+	if (!impure->irsb_scan && largeScan)
+	{
+		rpb->getWindow(tdbb).win_flags |= WIN_large_scan;
+		rpb->rpb_org_scans = m_relation()->rel_scan_count++;
+	}
+}
+
+void ParallelTableScan::close(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+
+	invalidateRecords(request);
+
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (impure->irsb_flags & irsb_open)
+	{
+		impure->irsb_flags &= ~irsb_open;
+
+		if (impure->irsb_scan)
+		{
+			impure->irsb_scan->stop(tdbb);
+			delete impure->irsb_scan;
+			impure->irsb_scan = NULL;
+		}
+
+		record_param* const rpb = &request->req_rpb[m_stream];
+		if ((rpb->getWindow(tdbb).win_flags & WIN_large_scan) &&
+			m_relation()->rel_scan_count)
+		{
+			m_relation()->rel_scan_count--;
+		}
+	}
+}
+
+bool ParallelTableScan::internalGetRecord(thread_db* tdbb) const
+{
+	JRD_reschedule(tdbb);
+
+	Request* const request = tdbb->getRequest();
+	record_param* const rpb = &request->req_rpb[m_stream];
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open))
+	{
+		rpb->rpb_number.setValid(false);
+		return false;
+	}
+
+	const bool found = impure->irsb_scan ?
+		impure->irsb_scan->getRecord(tdbb, rpb, request->req_pool) :
+		VIO_next_record(tdbb, rpb, request->req_transaction, request->req_pool, DPM_next_all);
+
+	rpb->rpb_number.setValid(found);
+	return found;
+}
+
+void ParallelTableScan::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
+{
+	if (!level)
+		plan += "(";
+
+	plan += printName(tdbb, m_alias) + " NATURAL";
+
+	if (!level)
+		plan += ")";
+}
+
+void ParallelTableScan::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const
+{
+	planEntry.className = "ParallelTableScan";
+
+	// Workers are assigned when the scan is opened, it may still be read
+	// by the request alone, thus the plan doesn't claim it's parallel
+
+	planEntry.lines.add().text = "Table " +
+		printName(tdbb, m_relation()->getName().toQuotedString(), m_alias) +
+		" Full Scan (parallel workers allowed)";
+	printOptInfo(planEntry.lines);
+
+	planEntry.objectType = m_relation()->getObjectType();
+	planEntry.objectName = m_relation()->getName();
+
+	if (m_alias.hasData() && m_alias != string(m_relation()->getName().object))
+		planEntry.alias = m_alias;
+}
@@ -204,6 +204,7 @@ void RecordSource::printInversion(thread_db* tdbb, const InversionNode* inversio
 
 				const bool fullscan = (maxSegs == 0);
 				const bool list = (retrieval->irb_list != nullptr);
+				const bool skip = (retrieval->irb_generic & irb_skip_scan);
 
 				string bounds;
 				if (!unique && !fullscan)
@@ -237,7 +238,7 @@ void RecordSource::printInversion(thread_db* tdbb, const InversionNode* inversio
 				}
 
 				plan->text = "Index " + printName(tdbb, indexName.toQuotedString()) +
-					(fullscan ? " Full" : unique ? " Unique" : list ? " List" : " Range") + " Scan" + bounds;
+					(fullscan ? " Full" : unique ? " Unique" : list ? " List" : skip ? " Skip" : " Range") + " Scan" + bounds;
 			}
 			else
 				plan->text = printName(tdbb, indexName.toQuotedString());
@@ -52,6 +52,7 @@ namespace Jrd
 	class BaseBufferedStream;
 	class BufferedStream;
 	class PlanEntry;
+	class ParallelScan;
 
 	enum class JoinType { INNER, OUTER, SEMI, ANTI };
 
@@ -133,6 +134,15 @@ namespace Jrd
 		unsigned level = 0;
 	};
 
+	// Cheap check pushed down from a join into the scan of its probe stream.
+	// It may reject records which cannot find a match before they're returned
+	// to the upper levels. False positives are allowed, false negatives are not.
+	class RuntimeFilter
+	{
+	public:
+		virtual bool checkRecord(thread_db* tdbb) const = 0;
+	};
+
 	// Abstract base class for record sources.
 	class RecordSource : public AccessPath
 	{
@@ -154,6 +164,10 @@ namespace Jrd
 			fb_assert(false);
 		}
 
+		virtual void pushFilter(const RuntimeFilter* /*filter*/, StreamType /*stream*/)
+		{
+		}
+
 		static bool rejectDuplicate(const UCHAR* /*data1*/, const UCHAR* /*data2*/, void* /*userArg*/)
 		{
 			return true;
@@ -222,8 +236,20 @@ namespace Jrd
 		}
 
 	protected:
+		bool checkFilter(thread_db* tdbb) const
+		{
+			return !m_filter || m_filter->checkRecord(tdbb);
+		}
+
+		void setFilter(const RuntimeFilter* filter, StreamType stream)
+		{
+			if (stream == m_stream && !m_filter)
+				m_filter = filter;
+		}
+
 		const StreamType m_stream;
 		mutable const Format* m_format;
+		const RuntimeFilter* m_filter = nullptr;
 	};
 
 
@@ -244,6 +270,11 @@ namespace Jrd
 
 		void close(thread_db* tdbb) const override;
 
+		void pushFilter(const RuntimeFilter* filter, StreamType stream) override
+		{
+			setFilter(filter, stream);
+		}
+
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
 	protected:
@@ -257,11 +288,38 @@ namespace Jrd
 		Firebird::Array<DbKeyRangeNode*> m_dbkeyRanges;
 	};
 
+	class ParallelTableScan final : public RecordStream
+	{
+		struct Impure : public RecordSource::Impure
+		{
+			ParallelScan* irsb_scan;
+		};
+
+	public:
+		ParallelTableScan(CompilerScratch* csb, const Firebird::string& alias,
+						  StreamType stream, Rsc::Rel relation);
+
+		void close(thread_db* tdbb) const override;
+
+		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
+
+	protected:
+		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
+		void internalOpen(thread_db* tdbb) const override;
+		bool internalGetRecord(thread_db* tdbb) const override;
+
+	private:
+		const Firebird::string m_alias;
+		const Rsc::Rel m_relation;
+	};
+
 	class BitmapTableScan final : public RecordStream
 	{
 		struct Impure : public RecordSource::Impure
 		{
 			RecordBitmap** irsb_bitmap;
+			ULONG irsb_prefetch_sequence;	// next data page sequence to read ahead
+			ULONG irsb_prefetch_trigger;	// data page sequence to read ahead again at
 		};
 
 	public:
@@ -271,6 +329,11 @@ namespace Jrd
 
 		void close(thread_db* tdbb) const override;
 
+		void pushFilter(const RuntimeFilter* filter, StreamType stream) override
+		{
+			setFilter(filter, stream);
+		}
+
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
 	protected:
@@ -279,6 +342,8 @@ namespace Jrd
 		bool internalGetRecord(thread_db* tdbb) const override;
 
 	private:
+		void readAhead(thread_db* tdbb, Impure* impure, record_param* rpb, RecordBitmap* bitmap) const;
+
 		const Firebird::string m_alias;
 		const Rsc::Rel m_relation;
 		NestConst<InversionNode> const m_inversion;
@@ -299,6 +364,8 @@ namespace Jrd
 			temporary_key* irsb_nav_current_lower;		// current lower key
 			temporary_key* irsb_nav_current_upper;		// current upper key
 			IndexScanListIterator* irsb_iterator;		// key list iterator
+			ULONG irsb_visible_page;					// data page sequence known to be all visible
+			ULONG irsb_visible_epoch;					// relation visibility epoch of the above
 			USHORT irsb_nav_offset;						// page offset of current index node
 			USHORT irsb_nav_upper_length;				// length of upper key value
 			USHORT irsb_nav_length;						// length of expanded key
@@ -322,6 +389,11 @@ namespace Jrd
 			m_condition = condition;
 		}
 
+		void setIndexOnly()
+		{
+			m_indexOnly = true;
+		}
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -333,6 +405,7 @@ namespace Jrd
 		void advanceStream(thread_db* tdbb, Impure* impure, win* window) const;
 		UCHAR* getPosition(thread_db* tdbb, Impure* impure, win* window) const;
 		UCHAR* getStreamPosition(thread_db* tdbb, Impure* impure, win* window) const;
+		bool isAllVisible(thread_db* tdbb, Impure* impure, record_param* rpb) const;
 		UCHAR* openStream(thread_db* tdbb, Impure* impure, win* window) const;
 		void setPage(thread_db* tdbb, Impure* impure, win* window) const;
 		void setPosition(thread_db* tdbb, Impure* impure, record_param*,
@@ -346,6 +419,7 @@ namespace Jrd
 		NestConst<BoolExprNode> m_condition;
 		const FB_SIZE_T m_length;
 		FB_SIZE_T m_offset;
+		bool m_indexOnly = false;
 	};
 
 	class ExternalTableScan final : public RecordStream
@@ -600,6 +674,11 @@ namespace Jrd
 		bool isDependent(const StreamList& streams) const override;
 		void nullRecords(thread_db* tdbb) const override;
 
+		void pushFilter(const RuntimeFilter* filter, StreamType stream) override
+		{
+			m_next->pushFilter(filter, stream);
+		}
+
 		void setAnyBoolean(BoolExprNode* anyBoolean, bool ansiAny, bool ansiNot) override
 		{
 			fb_assert(!m_anyBoolean);
@@ -704,6 +783,13 @@ namespace Jrd
 			Firebird::Array<Item> items;
 		};
 
+		// Consumer that may take the input records over instead of sorting them
+		class Interceptor
+		{
+		public:
+			virtual bool intercept(thread_db* tdbb) const = 0;
+		};
+
 		SortedStream(CompilerScratch* csb, RecordSource* next, SortMap* map);
 
 		void close(thread_db* tdbb) const override;
@@ -735,6 +821,11 @@ namespace Jrd
 			return m_map->keyLength;
 		}
 
+		void setInterceptor(const Interceptor* interceptor)
+		{
+			m_interceptor = interceptor;
+		}
+
 		bool compareKeys(const UCHAR* p, const UCHAR* q) const;
 
 		UCHAR* getData(thread_db* tdbb) const;
@@ -763,6 +854,7 @@ namespace Jrd
 
 		NestConst<RecordSource> m_next;
 		const SortMap* const m_map;
+		const Interceptor* m_interceptor = nullptr;
 	};
 
 	// Make moves in a window without going out of partition boundaries.
@@ -959,18 +1051,44 @@ namespace Jrd
 		bool m_oneRowWhenEmpty;
 	};
 
-	class AggregatedStream final : public BaseAggWinStream<AggregatedStream, RecordSource>
+	class AggregatedStream final : public BaseAggWinStream<AggregatedStream, RecordSource>,
+		public SortedStream::Interceptor
 	{
+		class HashTable;
+
+	public:
+		struct Impure final : public BaseAggWinStream::Impure
+		{
+			HashTable* irsb_hash_table;
+			ULONG irsb_hash_position;
+		};
+
 	public:
 		AggregatedStream(thread_db* tdbb, CompilerScratch* csb, StreamType stream,
 			const NestValueArray* group, MapNode* map, RecordSource* next);
 
 	public:
+		void close(thread_db* tdbb) const override;
+
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool setupHashing(thread_db* tdbb, CompilerScratch* csb, SortedStream* sort);
+		bool intercept(thread_db* tdbb) const override;
+
 	protected:
+		void internalOpen(thread_db* tdbb) const override;
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		bool internalGetRecord(thread_db* tdbb) const override;
+
+	private:
+		ULONG makeKey(thread_db* tdbb, Request* request, UCHAR* keyBuffer) const;
+		void releaseHashTable(Request* request) const;
+
+		SortedStream* m_hashSort = nullptr;		// overflow sort, set if hash aggregation is used
+		Firebird::Array<dsc> m_keyDescs;
+		Firebird::Array<USHORT> m_keyLengths;
+		Firebird::Array<ULONG> m_stateOffsets;
+		ULONG m_keyLength = 0;
 	};
 
 	class WindowedStream : public RecordSource
@@ -1341,7 +1459,7 @@ namespace Jrd
 		const StreamList m_checkStreams;
 	};
 
-	class HashJoin final : public Join<RecordSource>
+	class HashJoin final : public Join<RecordSource>, public RuntimeFilter
 	{
 		class HashTable;
 
@@ -1363,6 +1481,7 @@ namespace Jrd
 			HashTable* irsb_hash_table;
 			UCHAR* irsb_leader_buffer;
 			ULONG irsb_leader_hash;
+			bool irsb_leader_hashed;	// hash is already computed by the pushed down filter
 		};
 
 	public:
@@ -1377,6 +1496,8 @@ namespace Jrd
 		void close(thread_db* tdbb) const override;
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
+		bool checkRecord(thread_db* tdbb) const override;
+
 		static unsigned maxCapacity() noexcept;
 
 	protected:
@@ -208,6 +208,11 @@ Sort* SortedStream::init(thread_db* tdbb) const
 
 	while (m_next->getRecord(tdbb))
 	{
+		// Let the interceptor process the record if it can
+
+		if (m_interceptor && m_interceptor->intercept(tdbb))
+			continue;
+
 		// "Put" a record to sort. Actually, get the address of a place
 		// to build a record.
 
@@ -491,7 +496,7 @@ void SortedStream::mapData(thread_db* tdbb, Request* request, UCHAR* data) const
 
 		if (VIO_chase_record_version(tdbb, &temp, transaction, tdbb->getDefaultPool(), false, false))
 		{
-			if (!(temp.rpb_runtime_flags & RPB_undo_data))
+			if (!(temp.rpb_runtime_flags & RPB_DATA_FLAGS))
 				VIO_data(tdbb, &temp, tdbb->getDefaultPool());
 
 			tempRecord = temp.rpb_record;
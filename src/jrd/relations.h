@@ -109,6 +109,7 @@ RELATION(nam_indices, rel_indices, ODS_8_0, rel_persistent)
 	FIELD(f_idx_foreign_schema, nam_foreign_sch_name, fld_sch_name, 1, ODS_14_0)
 	FIELD(f_idx_format, nam_fmt, fld_format, 1, ODS_14_0)
 	FIELD(f_idx_pkg_name, nam_pkg_name, fld_pkg_name, 1, ODS_14_0)
+	FIELD(f_idx_histogram, nam_histogram, fld_blob, 1, ODS_14_0)
 END_RELATION
 
 // Relation 5 (RDB$RELATION_FIELDS)
@@ -542,6 +543,8 @@ RELATION(nam_mon_database, rel_mon_database, ODS_11_1, rel_virtual)
 	FIELD(f_mon_db_na, nam_mon_na, fld_att_id, 0, ODS_13_0)
 	FIELD(f_mon_db_ns, nam_mon_ns, fld_stmt_id, 0, ODS_13_0)
 	FIELD(f_mon_db_repl_mode, nam_mon_repl_mode, fld_repl_mode, 0, ODS_13_0)
+	FIELD(f_mon_db_gc_pending, nam_mon_gc_pending_pages, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_db_gc_processed, nam_mon_gc_processed_pages, fld_counter, 0, ODS_14_0)
 END_RELATION
 
 // Relation 34 (MON$ATTACHMENTS)
@@ -634,6 +637,8 @@ RELATION(nam_mon_io_stats, rel_mon_io_stats, ODS_11_1, rel_virtual)
 	FIELD(f_mon_io_page_writes, nam_mon_page_writes, fld_counter, 0, ODS_11_1)
 	FIELD(f_mon_io_page_fetches, nam_mon_page_fetches, fld_counter, 0, ODS_11_1)
 	FIELD(f_mon_io_page_marks, nam_mon_page_marks, fld_counter, 0, ODS_11_1)
+	FIELD(f_mon_io_cache_hits, nam_mon_cache_hits, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_io_cache_misses, nam_mon_cache_misses, fld_counter, 0, ODS_14_0)
 END_RELATION
 
 // Relation 39 (MON$RECORD_STATS)
@@ -154,6 +154,7 @@ inline constexpr USHORT rpb_gc_active	= 256;		// garbage collecting dead record
 inline constexpr USHORT rpb_uk_modified	= 512;		// record key field values are changed
 inline constexpr USHORT rpb_long_tranum	= 1024;		// transaction number is 64-bit
 inline constexpr USHORT rpb_not_packed	= 2048;		// record (or delta) is stored "as is"
+inline constexpr USHORT rpb_block_packed	= 4096;		// record is compressed by the block compressor
 
 // Stream flags
 
@@ -171,9 +172,11 @@ inline constexpr USHORT RPB_undo_read		= 0x04;	// read was performed using the u
 inline constexpr USHORT RPB_undo_deleted	= 0x08;	// read was performed using the undo log, primary version is deleted
 inline constexpr USHORT RPB_just_deleted	= 0x10;	// record was just deleted by us
 inline constexpr USHORT RPB_uk_updated		= 0x20;	// set by IDX_modify if it insert key into any primary or unique index
+inline constexpr USHORT RPB_cached_data		= 0x40;	// data got from the relation's version cache
 
 inline constexpr USHORT RPB_UNDO_FLAGS	= (RPB_undo_data | RPB_undo_read | RPB_undo_deleted);
-inline constexpr USHORT RPB_CLEAR_FLAGS	= (RPB_UNDO_FLAGS | RPB_just_deleted | RPB_uk_updated);
+inline constexpr USHORT RPB_DATA_FLAGS	= (RPB_undo_data | RPB_cached_data);	// data page is released, record is filled
+inline constexpr USHORT RPB_CLEAR_FLAGS	= (RPB_UNDO_FLAGS | RPB_cached_data | RPB_just_deleted | RPB_uk_updated);
 
 // List of active blobs controlled by request
 
@@ -31,11 +31,13 @@
 #include "firebird.h"
 #include <errno.h>
 #include <string.h>
+#include <atomic>
 #include "../jrd/jrd.h"
 #include "../jrd/sort.h"
 #include "iberror.h"
 #include "../jrd/intl.h"
 #include "../common/TimeZoneUtil.h"
+#include "../common/Task.h"
 #include "../common/gdsassert.h"
 #include "../jrd/req.h"
 #include "../jrd/val.h"
@@ -64,6 +66,13 @@
 
 constexpr USHORT RUN_GROUP			= 8;
 constexpr USHORT MAX_MERGE_LEVEL	= 2;
+constexpr ULONG MIN_SEGMENT_RECORDS	= 1024;	// smallest part of a run sorted by its own thread
+constexpr ULONG RADIX_MIN_RECORDS	= 1024;	// less records are sorted by comparison
+constexpr ULONG RADIX_MAX_KEY_LONGS	= 4;	// longer keys are sorted by quick()
+constexpr ULONG RADIX_MIN_GROUP		= 16;	// blocks of prefixes sorted by insertion
+constexpr unsigned RADIX_BITS		= 11;
+constexpr unsigned RADIX_BUCKETS	= 1 << RADIX_BITS;
+constexpr unsigned RADIX_DIGITS		= (64 + RADIX_BITS - 1) / RADIX_BITS;
 
 using namespace Jrd;
 using namespace Firebird;
@@ -147,9 +156,238 @@ namespace
 		*a = *b;
 		*b = temp;
 	}
+
+	// Radix sort works with the array of key prefixes to avoid
+	// touching the records during its passes
+
+	struct RadixEntry
+	{
+		FB_UINT64 prefix;
+		SORTP* record;
+	};
+
+	inline FB_UINT64 radixPrefix(const SORTP* key, ULONG word, ULONG keyLongs) noexcept
+	{
+		const FB_UINT64 high = key[word];
+		return (high << 32) | ((word + 1 < keyLongs) ? key[word + 1] : 0);
+	}
+
+	// Small arrays of entries are ordered by insertion sort of short
+	// blocks merged bottom-up. Returns either entries or temp, whichever
+	// has the result.
+
+	RadixEntry* mergeSort(RadixEntry* entries, RadixEntry* temp, ULONG count) noexcept
+	{
+		for (ULONG start = 0; start < count; start += RADIX_MIN_GROUP)
+		{
+			RadixEntry* const block = entries + start;
+			const RadixEntry* const end = block + MIN(RADIX_MIN_GROUP, count - start);
+
+			for (RadixEntry* i = block + 1; i < end; i++)
+			{
+				const RadixEntry entry = *i;
+				RadixEntry* j = i;
+
+				for (; j > block && (j - 1)->prefix > entry.prefix; j--)
+					*j = *(j - 1);
+
+				*j = entry;
+			}
+		}
+
+		for (ULONG width = RADIX_MIN_GROUP; width < count; width *= 2)
+		{
+			for (ULONG start = 0; start < count; start += 2 * width)
+			{
+				const RadixEntry* a = entries + start;
+				const RadixEntry* const aEnd = entries + MIN(start + width, count);
+				const RadixEntry* b = aEnd;
+				const RadixEntry* const bEnd = entries + MIN(start + 2 * width, count);
+				RadixEntry* out = temp + start;
+
+				while (a < aEnd && b < bEnd)
+					*out++ = (b->prefix < a->prefix) ? *b++ : *a++;
+
+				while (a < aEnd)
+					*out++ = *a++;
+
+				while (b < bEnd)
+					*out++ = *b++;
+			}
+
+			RadixEntry* const sorted = temp;
+			temp = entries;
+			entries = sorted;
+		}
+
+		return entries;
+	}
+
+	// LSD radix sort of the entries by their prefixes. Digits equal for all
+	// entries are skipped, this makes short and sparse keys cheap. Returns
+	// either entries or temp, whichever has the result.
+
+	RadixEntry* radixPass(RadixEntry* entries, RadixEntry* temp, ULONG count) noexcept
+	{
+		if (count < RADIX_MIN_RECORDS)
+			return mergeSort(entries, temp, count);
+
+		ULONG counts[RADIX_DIGITS][RADIX_BUCKETS];
+		memset(counts, 0, sizeof(counts));
+
+		for (const RadixEntry* entry = entries; entry < entries + count; entry++)
+		{
+			const FB_UINT64 prefix = entry->prefix;
+
+			for (unsigned digit = 0; digit < RADIX_DIGITS; digit++)
+				counts[digit][(prefix >> (digit * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+		}
+
+		for (unsigned digit = 0; digit < RADIX_DIGITS; digit++)
+		{
+			const unsigned shift = digit * RADIX_BITS;
+			ULONG* const offsets = counts[digit];
+
+			if (offsets[(entries->prefix >> shift) & (RADIX_BUCKETS - 1)] == count)
+				continue;
+
+			ULONG offset = 0;
+			for (unsigned i = 0; i < RADIX_BUCKETS; i++)
+			{
+				const ULONG n = offsets[i];
+				offsets[i] = offset;
+				offset += n;
+			}
+
+			for (const RadixEntry* entry = entries; entry < entries + count; entry++)
+				temp[offsets[(entry->prefix >> shift) & (RADIX_BUCKETS - 1)]++] = *entry;
+
+			RadixEntry* const sorted = temp;
+			temp = entries;
+			entries = sorted;
+		}
+
+		return entries;
+	}
+
+	inline ULONG segmentStart(ULONG count, USHORT segments, USHORT segment) noexcept
+	{
+		return (ULONG) ((FB_UINT64) count * segment / segments);
+	}
 } // namespace
 
 
+// Sorts the record pointers of a run by several threads. The pointers are split
+// into segments, every segment is sorted in its own guarded copy and then moved
+// back in place, so the run becomes a sequence of separately ordered segments.
+
+class Sort::SortSegments final : public Task
+{
+public:
+	SortSegments(MemoryPool& pool, SORTP** pointers, ULONG count, USHORT segments,
+				 ULONG longs, ULONG keyLongs)
+		: m_pool(pool),
+		  m_items(pool),
+		  m_temp(pool),
+		  m_pointers(pointers),
+		  m_count(count),
+		  m_longs(longs),
+		  m_keyLongs(keyLongs),
+		  m_next(0)
+	{
+		m_temp.getBuffer(count + 2 * segments);
+
+		for (USHORT i = 0; i < segments; i++)
+			m_items.add(FB_NEW_POOL(pool) Item(this, i));
+	}
+
+	~SortSegments()
+	{
+		for (Item** p = m_items.begin(); p < m_items.end(); p++)
+			delete *p;
+	}
+
+	bool handler(WorkItem& _item);
+
+	bool getWorkItem(WorkItem** pItem)
+	{
+		const USHORT next = m_next++;
+
+		if (next >= m_items.getCount())
+			return false;
+
+		*pItem = m_items[next];
+		return true;
+	}
+
+	bool getResult(IStatus* status)
+	{
+		if (status)
+			status->init();
+
+		return true;
+	}
+
+	int getMaxWorkers()
+	{
+		return m_items.getCount();
+	}
+
+private:
+	class Item : public Task::WorkItem
+	{
+	public:
+		Item(SortSegments* task, USHORT segment)
+			: Task::WorkItem(task),
+			  m_segment(segment)
+		{}
+
+		const USHORT m_segment;
+	};
+
+	MemoryPool& m_pool;
+	HalfStaticArray<Item*, RUN_GROUP> m_items;
+	Array<SORTP*> m_temp;
+	SORTP** const m_pointers;
+	const ULONG m_count;
+	const ULONG m_longs;
+	const ULONG m_keyLongs;
+	std::atomic<USHORT> m_next;
+};
+
+
+bool Sort::SortSegments::handler(WorkItem& _item)
+{
+	const Item* const item = static_cast<Item*>(&_item);
+	const USHORT segments = m_items.getCount();
+
+	const ULONG start = segmentStart(m_count, segments, item->m_segment);
+	const ULONG count = segmentStart(m_count, segments, item->m_segment + 1) - start;
+
+	// Every segment gets its own copy of the pointers with the low and high
+	// guard keys around, as required by quick()
+
+	SORTP** const pointers = m_pointers + start;
+	SORTP** const temp = m_temp.begin() + start + 2 * item->m_segment;
+
+	temp[0] = reinterpret_cast<SORTP*>(low_key);
+	memcpy(temp + 1, pointers, count * sizeof(SORTP*));
+	temp[count + 1] = reinterpret_cast<SORTP*>(high_key);
+
+	sortPointers(m_pool, temp + 1, count, m_longs, m_keyLongs);
+
+	// Move the ordered pointers back and make the records point to their new slots
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		pointers[i] = temp[i + 1];
+		((SORTP***) pointers[i])[BACK_OFFSET] = pointers + i;
+	}
+
+	return true;
+}
+
+
 Sort::Sort(Database* dbb,
 		   SortOwner* owner,
 		   ULONG record_length,
@@ -163,6 +401,7 @@ Sort::Sort(Database* dbb,
 	  m_last_record(NULL), m_next_pointer(NULL), m_records(0),
 	  m_runs(NULL), m_merge(NULL), m_free_runs(NULL),
 	  m_flags(0), m_merge_pool(NULL),
+	  m_workers(0), m_coordinator(NULL),
 	  m_description(m_owner->getPool(), keys)
 {
 /**************************************
@@ -293,6 +532,8 @@ Sort::~Sort()
 	}
 
 	delete[] m_merge_pool;
+
+	delete m_coordinator;
 }
 
 
@@ -363,19 +604,7 @@ void Sort::put(thread_db* tdbb, ULONG** record_address)
 			(UCHAR*) NEXT_RECORD(record) <= (UCHAR*) (m_next_pointer + 1))
 		{
 			putRun(tdbb);
-			while (true)
-			{
-				run_control* run = m_runs;
-				const USHORT depth = run->run_depth;
-				if (depth == MAX_MERGE_LEVEL)
-					break;
-				USHORT count = 1;
-				while ((run = run->run_next) && run->run_depth == depth)
-					count++;
-				if (count < RUN_GROUP)
-					break;
-				mergeRuns(count);
-			}
+			mergeRunGroups();
 			init();
 			record = m_last_record;
 		}
@@ -440,6 +669,12 @@ void Sort::sort(thread_db* tdbb)
 
 		putRun(tdbb);
 
+		// Runs sorted by several threads come in groups, merge the full ones
+		// to keep the count of low depth runs within the mergeRuns() limits
+
+		if (m_workers > 1)
+			mergeRunGroups();
+
 		CHECK_FILE(NULL);
 
 		// Merge runs of low depth to free memory part of temp space
@@ -1388,11 +1623,13 @@ void Sort::init()
 	// read\write scratch file by bigger chunks
 	// At this point we already allocated some memory for temp space so
 	// growing sort buffer space is not a big compared to that
+	// When runs are sorted by several threads, grow it after the first run
+	// and give every thread the share of the usual big buffer
 
 	if (m_size_memory <= m_max_alloc_size && m_runs &&
-		m_runs->run_depth == MAX_MERGE_LEVEL)
+		(m_runs->run_depth == MAX_MERGE_LEVEL || m_workers > 1))
 	{
-		const ULONG mem_size = m_max_alloc_size * RUN_GROUP;
+		const ULONG mem_size = m_max_alloc_size * RUN_GROUP * MAX(m_workers, 1);
 
 		try
 		{
@@ -1406,8 +1643,11 @@ void Sort::init()
 			m_end_memory = m_memory + m_size_memory;
 			m_first_pointer = (sort_record**) m_memory;
 
-			for (run_control *run = m_runs; run; run = run->run_next)
-				run->run_depth--;
+			if (m_runs->run_depth == MAX_MERGE_LEVEL)
+			{
+				for (run_control *run = m_runs; run; run = run->run_next)
+					run->run_depth--;
+			}
 		}
 		catch (const BadAlloc&)
 		{} // no-op
@@ -1513,6 +1753,30 @@ ULONG Sort::allocate(ULONG n, ULONG chunkSize, bool useFreeSpace)
 }
 
 
+void Sort::mergeRunGroups()
+{
+/**************************************
+ *
+ * Merge the runs at the head of the list while there are
+ * at least RUN_GROUP runs of the same depth.
+ *
+ **************************************/
+	while (true)
+	{
+		run_control* run = m_runs;
+		const USHORT depth = run->run_depth;
+		if (depth == MAX_MERGE_LEVEL)
+			break;
+		USHORT count = 1;
+		while ((run = run->run_next) && run->run_depth == depth)
+			count++;
+		if (count < RUN_GROUP)
+			break;
+		mergeRuns(count);
+	}
+}
+
+
 void Sort::mergeRuns(USHORT n)
 {
 /**************************************
@@ -2014,6 +2278,46 @@ void Sort::putRun(thread_db* tdbb)
  * may disappear, the number of records in the run may be less than
  * were sorted.
  *
+ **************************************/
+	// Number of threads allowed to sort the run is taken from the attachment
+	// when the sort overflows its buffer the first time
+
+	if (!m_workers)
+	{
+		const Attachment* const attachment = tdbb->getAttachment();
+
+		m_workers = 1;
+		if (attachment && attachment->att_parallel_workers > 1)
+			m_workers = MIN(attachment->att_parallel_workers, RUN_GROUP);
+	}
+
+	newRun();
+
+	// Do the in-core sort. The first phase a duplicate handling we be performed
+	// in "sort". Big enough buffer is sorted by several threads, every one
+	// producing its own run.
+
+	const ULONG count = m_next_pointer - m_first_pointer - 1;
+	const USHORT segments = (count >= m_workers * MIN_SEGMENT_RECORDS) ? m_workers : 1;
+
+	sortBuffer(tdbb, segments);
+
+	// Re-arrange records in physical order so they can be dumped in a single write
+	// operation
+
+	orderAndSave(tdbb);
+
+	if (segments > 1)
+		splitRun(segments);
+}
+
+
+run_control* Sort::newRun()
+{
+/**************************************
+ *
+ * Get a run control block and put it at the head of the run list.
+ *
  **************************************/
 	run_control* run = m_free_runs;
 
@@ -2030,26 +2334,18 @@ void Sort::putRun(thread_db* tdbb)
 	run->run_header.rmh_type = RMH_TYPE_RUN;
 	run->run_depth = 0;
 
-	// Do the in-core sort. The first phase a duplicate handling we be performed
-	// in "sort".
-
-	sortBuffer(tdbb);
-
-	// Re-arrange records in physical order so they can be dumped in a single write
-	// operation
-
-	orderAndSave(tdbb);
+	return run;
 }
 
 
-void Sort::sortBuffer(thread_db* tdbb)
+void Sort::sortBuffer(thread_db* tdbb, USHORT segments)
 {
 /**************************************
  *
- * Set up for and call quick sort.  Quicksort, by design, doesn't
- * order partitions of length 2, so make a pass thru the data to
- * straighten out pairs.  While we at it, if duplicate handling has
- * been requested, detect and handle them.
+ * Sort the record pointers.  If several segments are requested,
+ * every segment is sorted on its own by a separate thread, so the
+ * buffer becomes a sequence of ordered segments.  If duplicate
+ * handling has been requested, detect and handle them.
  *
  **************************************/
 	EngineCheckout cout(tdbb, FB_FUNCTION);
@@ -2058,36 +2354,15 @@ void Sort::sortBuffer(thread_db* tdbb)
 
 	*m_next_pointer = reinterpret_cast<sort_record*>(high_key);
 
-	// Next, call QuickSort. Keep in mind that the first pointer is the
-	// low key and not a record.
+	// Keep in mind that the first pointer is the low key and not a record
 
 	SORTP** j = (SORTP**) (m_first_pointer) + 1;
 	const ULONG n = (SORTP**) (m_next_pointer) - j;	// calculate # of records
 
-	quick(n, j, m_longs);
-
-	// Scream through and correct any out of order pairs
-	// hvlad: don't compare user keys against high_key
-	while (j < (SORTP**) m_next_pointer - 1)
-	{
-		SORTP** i = j;
-		j++;
-		if (**i >= **j)
-		{
-			const SORTP* p = *i;
-			const SORTP* q = *j;
-			ULONG tl = m_longs - 1;
-			while (tl && *p == *q)
-			{
-				p++;
-				q++;
-				tl--;
-			}
-			if (tl && *p > *q) {
-				swap(i, j);
-			}
-		}
-	}
+	if (segments > 1)
+		sortSegments(segments);
+	else
+		sortPointers(m_owner->getPool(), j, n, m_longs, m_key_length);
 
 	// If duplicate handling hasn't been requested, we're done
 
@@ -2135,6 +2410,155 @@ void Sort::sortBuffer(thread_db* tdbb)
 }
 
 
+void Sort::quickSort(SORTP** pointers, ULONG count, ULONG longs) noexcept
+{
+/**************************************
+ *
+ * Call quick sort for the array of record pointers guarded by the
+ * low and high keys.  Quicksort, by design, doesn't order partitions
+ * of length 2, so make a pass thru the data to straighten out pairs.
+ *
+ **************************************/
+	quick(count, pointers, longs);
+
+	// Scream through and correct any out of order pairs
+	// hvlad: don't compare user keys against high_key
+	SORTP** j = pointers;
+	while (j < pointers + count - 1)
+	{
+		SORTP** i = j;
+		j++;
+		if (**i >= **j)
+		{
+			const SORTP* p = *i;
+			const SORTP* q = *j;
+			ULONG tl = longs - 1;
+			while (tl && *p == *q)
+			{
+				p++;
+				q++;
+				tl--;
+			}
+			if (tl && *p > *q) {
+				swap(i, j);
+			}
+		}
+	}
+}
+
+
+bool Sort::radixSort(MemoryPool& pool, SORTP** pointers, ULONG count, ULONG keyLongs)
+{
+/**************************************
+ *
+ * Sort the array of record pointers by radix sort of the
+ * normalized keys.  The first two key longwords are copied
+ * into the prefix array and sorted by LSD radix passes, so
+ * records are not touched while sorting.  Longer keys are
+ * resolved within the groups of equal prefixes by the next
+ * two longwords.  Return false if keys are too long or the
+ * memory for the prefix array is not available.
+ *
+ **************************************/
+	if (keyLongs > RADIX_MAX_KEY_LONGS || !count)
+		return false;
+
+	Array<RadixEntry> buffer(pool);
+	RadixEntry* entries;
+
+	try
+	{
+		entries = buffer.getBuffer(count * 2, false);
+	}
+	catch (const BadAlloc&)
+	{
+		return false;
+	}
+
+	RadixEntry* const temp = entries + count;
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		entries[i].prefix = radixPrefix(pointers[i], 0, keyLongs);
+		entries[i].record = pointers[i];
+	}
+
+	entries = radixPass(entries, temp, count);
+
+	if (keyLongs > 2)
+	{
+		RadixEntry* const other = (entries == temp) ? temp - count : temp;
+		const RadixEntry* const end = entries + count;
+
+		for (RadixEntry* group = entries; group < end; )
+		{
+			RadixEntry* next = group + 1;
+			while (next < end && next->prefix == group->prefix)
+				next++;
+
+			const ULONG size = next - group;
+
+			if (size > 1)
+			{
+				for (RadixEntry* entry = group; entry < next; entry++)
+					entry->prefix = radixPrefix(entry->record, 2, keyLongs);
+
+				RadixEntry* const sorted = radixPass(group, other + (group - entries), size);
+
+				if (sorted != group)
+					memcpy(group, sorted, size * sizeof(RadixEntry));
+			}
+
+			group = next;
+		}
+	}
+
+	// Put the pointers in order and make the records point to their new slots
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		pointers[i] = entries[i].record;
+		((SORTP***) pointers[i])[BACK_OFFSET] = pointers + i;
+	}
+
+	return true;
+}
+
+
+void Sort::sortPointers(MemoryPool& pool, SORTP** pointers, ULONG count, ULONG longs, ULONG keyLongs)
+{
+/**************************************
+ *
+ * Sort the array of record pointers guarded by the low and high
+ * keys.  Short keys of enough records are sorted by radix sort.
+ *
+ **************************************/
+	if (count < RADIX_MIN_RECORDS || !radixSort(pool, pointers, count, keyLongs))
+		quickSort(pointers, count, longs);
+}
+
+
+void Sort::sortSegments(USHORT segments)
+{
+/**************************************
+ *
+ * Sort segments of the record pointers by several threads.
+ * The threads are kept by the sort to be used for the next runs.
+ *
+ **************************************/
+	MemoryPool& pool = m_owner->getPool();
+
+	if (!m_coordinator)
+		m_coordinator = FB_NEW_POOL(pool) Coordinator(&pool);
+
+	SORTP** const pointers = (SORTP**) (m_first_pointer) + 1;
+	const ULONG count = (SORTP**) (m_next_pointer) - pointers;
+
+	SortSegments task(pool, pointers, count, segments, m_longs, m_key_length);
+	m_coordinator->runSync(&task);
+}
+
+
 void Sort::sortRunsBySeek(int n)
 {
 /**************************************
@@ -2164,6 +2588,49 @@ void Sort::sortRunsBySeek(int n)
 }
 
 
+void Sort::splitRun(USHORT segments)
+{
+/**************************************
+ *
+ * The run just saved consists of separately ordered segments
+ * written one after another.  Describe every segment by its
+ * own run, they are merged later as usual.
+ *
+ **************************************/
+	run_control* const run = m_runs;
+
+	sort_record** const pointers = m_first_pointer + 1; // 1st ptr is low key
+	const ULONG count = m_next_pointer - pointers;
+	const ULONG key_length = (m_longs - SIZEOF_SR_BCKPTR_IN_LONGS) * sizeof(ULONG);
+
+	FB_UINT64 seek = run->run_seek;
+	[[maybe_unused]] const FB_UINT64 runEnd = run->run_seek + run->run_size;
+
+	for (USHORT i = 0; i < segments; i++)
+	{
+		sort_record** ptr = pointers + segmentStart(count, segments, i);
+		sort_record** const end = pointers + segmentStart(count, segments, i + 1);
+
+		ULONG records = 0;
+		while (ptr < end)
+		{
+			if (*ptr++)
+				records++;
+		}
+
+		run_control* const segment = i ? newRun() : run;
+
+		segment->run_records = records;
+		segment->run_size = records * key_length;
+		segment->run_seek = seek;
+
+		seek += segment->run_size;
+	}
+
+	fb_assert(seek == runEnd);
+}
+
+
 /// class SortOwner
 
 UCHAR* SortOwner::allocateBuffer()
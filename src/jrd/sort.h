@@ -29,6 +29,10 @@
 #include "../jrd/TempSpace.h"
 #include "../jrd/align.h"
 
+namespace Firebird {
+class Coordinator;
+}
+
 namespace Jrd {
 
 // Forward declaration
@@ -305,7 +309,14 @@ public:
 		return seek + bytes;
 	}
 
+	// Sort the array of pointers to the normalized record keys,
+	// public to be compared by the tests
+	static void quickSort(SORTP**, ULONG, ULONG) noexcept;
+	static bool radixSort(MemoryPool&, SORTP**, ULONG, ULONG);
+
 private:
+	class SortSegments;
+
 	void allocateBuffer(MemoryPool&);
 	void releaseBuffer();
 
@@ -315,17 +326,22 @@ private:
 	ULONG allocate(ULONG, ULONG, bool);
 	void init();
 	void mergeRuns(USHORT);
+	void mergeRunGroups();
+	run_control* newRun();
 	ULONG order();
 	void orderAndSave(Jrd::thread_db*);
 	void putRun(Jrd::thread_db*);
-	void sortBuffer(Jrd::thread_db*);
+	void sortBuffer(Jrd::thread_db*, USHORT = 1);
+	void sortSegments(USHORT);
 	void sortRunsBySeek(int);
+	void splitRun(USHORT);
 
 #ifdef DEV_BUILD
 	void checkFile(const run_control*);
 #endif
 
 	static void quick(SLONG, SORTP**, ULONG) noexcept;
+	static void sortPointers(MemoryPool&, SORTP**, ULONG, ULONG, ULONG);
 
 	Database* m_dbb;							// Database
 	SortOwner* m_owner;							// Sort owner
@@ -352,6 +368,9 @@ private:
 	ULONG m_min_alloc_size;						// MIN and MAX values
 	ULONG m_max_alloc_size;						// for the run buffer size
 
+	USHORT m_workers;							// Threads sorting a run, 0 if not known yet
+	Firebird::Coordinator* m_coordinator;		// ALLOC: Worker threads sorting the runs
+
 	Firebird::Array<sort_key_def> m_description;
 };
 
@@ -25,6 +25,7 @@
 #include <string.h>
 #include "../jrd/sqz.h"
 #include "../jrd/req.h"
+#include "../jrd/Relation.h"
 #include "../jrd/err_proto.h"
 #include "../yvalve/gds_proto.h"
 
@@ -513,6 +514,298 @@ UCHAR* Compressor::unpack(ULONG inLength, const UCHAR* input,
 	return output;
 }
 
+namespace
+{
+	constexpr unsigned LZ_HASH_BITS = 12;
+	constexpr ULONG LZ_MIN_MATCH = 4;
+	constexpr ULONG LZ_MAX_OFFSET = MAX_USHORT;
+	constexpr unsigned LZ_LENGTH_MASK = 15;
+
+	inline ULONG readLong(const UCHAR* p) noexcept
+	{
+		ULONG value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	inline unsigned hashLong(ULONG value) noexcept
+	{
+		return (value * 2654435761U) >> (32 - LZ_HASH_BITS);
+	}
+
+	// Store the remainder of the length which didn't fit into the token
+
+	inline bool putLength(UCHAR*& output, const UCHAR* end, ULONG length) noexcept
+	{
+		for (; length >= MAX_UCHAR; length -= MAX_UCHAR)
+		{
+			if (output >= end)
+				return false;
+
+			*output++ = MAX_UCHAR;
+		}
+
+		if (output >= end)
+			return false;
+
+		*output++ = (UCHAR) length;
+		return true;
+	}
+
+	inline ULONG getLength(const UCHAR*& input, const UCHAR* end)
+	{
+		ULONG length = 0;
+		UCHAR c;
+
+		do
+		{
+			if (input >= end)
+				BUGCHECK(179);	// msg 179 decompression overran buffer
+
+			c = *input++;
+			length += c;
+		} while (c == MAX_UCHAR);
+
+		return length;
+	}
+
+	bool putSequence(UCHAR*& output, const UCHAR* end, const UCHAR* literals, ULONG literalsLength,
+		ULONG offset, ULONG matchLength) noexcept
+	{
+		if (output >= end)
+			return false;
+
+		UCHAR* const token = output++;
+		*token = (UCHAR) (MIN(literalsLength, LZ_LENGTH_MASK) << 4);
+
+		if (literalsLength >= LZ_LENGTH_MASK && !putLength(output, end, literalsLength - LZ_LENGTH_MASK))
+			return false;
+
+		if (literalsLength > (ULONG) (end - output))
+			return false;
+
+		memcpy(output, literals, literalsLength);
+		output += literalsLength;
+
+		if (!offset)
+			return true;
+
+		if (end - output < 2)
+			return false;
+
+		*output++ = (UCHAR) offset;
+		*output++ = (UCHAR) (offset >> 8);
+
+		*token |= (UCHAR) MIN(matchLength, LZ_LENGTH_MASK);
+
+		return matchLength < LZ_LENGTH_MASK || putLength(output, end, matchLength - LZ_LENGTH_MASK);
+	}
+}
+
+ULONG BlockCompressor::pack(ULONG inLength, const UCHAR* input, ULONG outLength, UCHAR* output)
+{
+/**************************************
+ *
+ *	Compress a string into the given area.
+ *	Return the compressed length or zero if it doesn't fit.
+ *
+ **************************************/
+	if (outLength <= sizeof(ULONG))
+		return 0;
+
+	const auto outStart = output;
+	const auto outEnd = output + outLength;
+
+	put_long(output, inLength);
+	output += sizeof(ULONG);
+
+	// Last seen positions of four byte sequences, modulo 64KB. Stale or colliding
+	// entries are harmless as the candidate match is always compared.
+
+	USHORT positions[1 << LZ_HASH_BITS];
+	memset(positions, 0, sizeof(positions));
+
+	const auto end = input + inLength;
+	const auto matchLimit = (inLength > LZ_MIN_MATCH) ? end - LZ_MIN_MATCH : input;
+	auto anchor = input;
+	auto p = input;
+
+	while (p < matchLimit)
+	{
+		const auto value = readLong(p);
+		const auto position = (ULONG) (p - input);
+		auto& slot = positions[hashLong(value)];
+		const ULONG offset = (USHORT) (position - slot);
+		slot = (USHORT) position;
+
+		if (!offset || offset > position || readLong(p - offset) != value)
+		{
+			// Skip faster through the data that doesn't compress
+			p += 1 + ((p - anchor) >> 6);
+			continue;
+		}
+
+		// Extend the match as far as possible
+
+		auto q = p + LZ_MIN_MATCH;
+		for (auto match = q - offset; q < end && *q == *match; q++, match++)
+			;
+
+		fb_assert(offset <= LZ_MAX_OFFSET);
+
+		if (!putSequence(output, outEnd, anchor, p - anchor, offset, q - p - LZ_MIN_MATCH))
+			return 0;
+
+		// Remember the position near the match end, it's likely to repeat
+
+		if (q - 2 >= input && q + 2 <= end)
+			positions[hashLong(readLong(q - 2))] = (USHORT) (q - 2 - input);
+
+		p = anchor = q;
+	}
+
+	if (anchor < end && !putSequence(output, outEnd, anchor, end - anchor, 0, 0))
+		return 0;
+
+	return output - outStart;
+}
+
+ULONG BlockCompressor::getUnpackedLength(ULONG inLength, const UCHAR* input)
+{
+/**************************************
+ *
+ *	Return the unpacked length of the block compressed string.
+ *
+ **************************************/
+	return (inLength >= sizeof(ULONG)) ? get_long(input) : 0;
+}
+
+UCHAR* BlockCompressor::unpack(ULONG inLength, const UCHAR* input,
+							   ULONG outLength, UCHAR* output)
+{
+/**************************************
+ *
+ *	Decompress a block compressed string into a buffer.
+ *	Return the address where the output stopped.
+ *
+ **************************************/
+	const auto length = getUnpackedLength(inLength, input);
+
+	if (inLength < sizeof(ULONG) || length > outLength)
+		BUGCHECK(179);	// msg 179 decompression overran buffer
+
+	const auto end = input + inLength;
+	input += sizeof(ULONG);
+
+	const auto outStart = output;
+	const auto outEnd = output + length;
+
+	while (output < outEnd)
+	{
+		if (input >= end)
+			BUGCHECK(179);	// msg 179 decompression overran buffer
+
+		const unsigned token = *input++;
+
+		ULONG literalsLength = token >> 4;
+		if (literalsLength == LZ_LENGTH_MASK)
+			literalsLength += getLength(input, end);
+
+		if (literalsLength > (ULONG) (end - input) || literalsLength > (ULONG) (outEnd - output))
+			BUGCHECK(179);	// msg 179 decompression overran buffer
+
+		memcpy(output, input, literalsLength);
+		output += literalsLength;
+		input += literalsLength;
+
+		if (output == outEnd)
+			break;
+
+		if (end - input < 2)
+			BUGCHECK(179);	// msg 179 decompression overran buffer
+
+		const ULONG offset = input[0] | (input[1] << 8);
+		input += 2;
+
+		ULONG matchLength = token & LZ_LENGTH_MASK;
+		if (matchLength == LZ_LENGTH_MASK)
+			matchLength += getLength(input, end);
+		matchLength += LZ_MIN_MATCH;
+
+		if (!offset || offset > (ULONG) (output - outStart) || matchLength > (ULONG) (outEnd - output))
+			BUGCHECK(179);	// msg 179 decompression overran buffer
+
+		const UCHAR* match = output - offset;
+
+		if (offset >= matchLength)
+		{
+			memcpy(output, match, matchLength);
+			output += matchLength;
+		}
+		else
+		{
+			// Overlapped match repeats the last bytes
+			while (matchLength--)
+				*output++ = *match++;
+		}
+	}
+
+	// Short records may be zero-padded up to the fragmented header size
+
+	while (input < end)
+	{
+		if (*input++)
+			BUGCHECK(179);	// msg 179 decompression overran buffer
+	}
+
+	return output;
+}
+
+BlockPackedRecord::BlockPackedRecord(thread_db* tdbb, record_param* rpb)
+	: m_rpb(rpb),
+	  m_buffer(*tdbb->getDefaultPool())
+{
+	rpb->rpb_flags &= ~rpb_block_packed;
+
+	// Only the primary record versions are compressed. Back versions and records
+	// which prior version is stored as the differences are left as is.
+
+	if (!rpb->rpb_relation || !rpb->rpb_relation->rel_compressed ||
+		(rpb->rpb_flags & (rpb_deleted | rpb_chained | rpb_fragment | rpb_blob | rpb_delta)) ||
+		rpb->rpb_length < BlockCompressor::MIN_LENGTH)
+	{
+		return;
+	}
+
+	// The block compression must beat the run-length one
+
+	const Compressor dcc(tdbb, rpb->rpb_length, rpb->rpb_address);
+	const auto maxLength = MIN(dcc.getPackedLength(), rpb->rpb_length) - 1;
+
+	const auto length = BlockCompressor::pack(rpb->rpb_length, rpb->rpb_address,
+		maxLength, m_buffer.getBuffer(maxLength, false));
+
+	if (!length)
+		return;
+
+	m_address = rpb->rpb_address;
+	m_length = rpb->rpb_length;
+
+	rpb->rpb_address = m_buffer.begin();
+	rpb->rpb_length = length;
+	rpb->rpb_flags |= rpb_block_packed;
+}
+
+BlockPackedRecord::~BlockPackedRecord()
+{
+	if (m_address)
+	{
+		m_rpb->rpb_address = m_address;
+		m_rpb->rpb_length = m_length;
+		m_rpb->rpb_flags &= ~rpb_block_packed;
+	}
+}
+
 ULONG Difference::apply(ULONG diffLength, ULONG outLength, UCHAR* const output)
 {
 /**************************************
@@ -30,6 +30,7 @@
 namespace Jrd
 {
 	class thread_db;
+	struct record_param;
 
 	class Compressor
 	{
@@ -66,6 +67,49 @@ namespace Jrd
 		bool m_allowUnpacked = true;
 	};
 
+	// Block compressor (LZ77 family, the sequence format is similar to LZ4) used for
+	// record images of the relations with ENABLE COMPRESSION. Unlike the run-length
+	// encoding it also shrinks repeating substrings of text, codes and numeric data.
+	//
+	//	    packed_image := <original length, 4 bytes> <sequence>...
+	//
+	//	    sequence := <token> [<literals length>] <literals> [<offset, 2 bytes> [<match length>]]
+	//
+	// The high half of token is the literals length, the low one is the match length
+	// reduced by the minimal match. Value 15 means the length continues in the following
+	// bytes, each of them is added to the length until a byte that is less than 255.
+	// The last sequence has no match.
+
+	class BlockCompressor
+	{
+	public:
+		// Shorter records are not worth compressing
+		static constexpr ULONG MIN_LENGTH = 64;
+
+		static ULONG pack(ULONG inLength, const UCHAR* input, ULONG outLength, UCHAR* output);
+
+		static ULONG getUnpackedLength(ULONG inLength, const UCHAR* input);
+		static UCHAR* unpack(ULONG inLength, const UCHAR* input,
+							 ULONG outLength, UCHAR* output);
+	};
+
+	// Replaces the record image in the record_param by its block compressed version
+	// while the record is being stored, if the relation asks for it and it pays off.
+	// The original image is restored when the object goes out of scope.
+
+	class BlockPackedRecord
+	{
+	public:
+		BlockPackedRecord(thread_db* tdbb, record_param* rpb);
+		~BlockPackedRecord();
+
+	private:
+		record_param* const m_rpb;
+		UCHAR* m_address = nullptr;
+		ULONG m_length = 0;
+		Firebird::UCharBuffer m_buffer;
+	};
+
 	class Difference
 	{
 		// Max length of generated differences string between two records
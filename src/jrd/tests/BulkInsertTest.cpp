@@ -0,0 +1,71 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/BulkInsert.h"
+#include "../jrd/blb.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(BulkInsertSuite)
+
+
+namespace
+{
+	USHORT restoreNulls(USHORT keyNulls, USHORT segments)
+	{
+		return BulkInsert::unpackKeyNulls(BulkInsert::packKeyNulls(keyNulls, segments), segments);
+	}
+
+	bool allNulls(USHORT keyNulls, USHORT segments)
+	{
+		return keyNulls == (1 << segments) - 1;
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(BulkInsertTests)
+
+BOOST_AUTO_TEST_CASE(SingleSegmentNullsTest)
+{
+	BOOST_TEST(restoreNulls(0, 1) == 0u);
+	BOOST_TEST(allNulls(restoreNulls(1, 1), 1));
+}
+
+BOOST_AUTO_TEST_CASE(CompoundUniqueNullsTest)
+{
+	// Keys of NULLs only must be recognized as such, otherwise
+	// they violate the unique index when inserted in bulk
+
+	const USHORT segments = 3;
+
+	BOOST_TEST(restoreNulls(0, segments) == 0u);
+	BOOST_TEST(allNulls(restoreNulls(0b111, segments), segments));
+
+	for (USHORT keyNulls = 1; keyNulls < 0b111; keyNulls++)
+	{
+		const USHORT restored = restoreNulls(keyNulls, segments);
+		BOOST_TEST(restored != 0u);
+		BOOST_TEST(!allNulls(restored, segments));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(SmallBlobThresholdTest)
+{
+	// Zero threshold disables storing blobs on the primary data pages,
+	// empty blobs included
+
+	BOOST_TEST(!blb::isSmall(0, 0, 0));
+	BOOST_TEST(!blb::isSmall(0, 1, 0));
+
+	BOOST_TEST(blb::isSmall(0, 0, 100));
+	BOOST_TEST(blb::isSmall(0, 100, 100));
+	BOOST_TEST(!blb::isSmall(0, 101, 100));
+	BOOST_TEST(!blb::isSmall(1, 8, 100));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// BulkInsertTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// BulkInsertSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
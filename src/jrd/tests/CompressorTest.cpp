@@ -9,6 +9,68 @@ BOOST_AUTO_TEST_SUITE(EngineSuite)
 BOOST_AUTO_TEST_SUITE(CompressorSuite)
 
 
+namespace
+{
+	// Record-like images: JSON document padded by spaces up to the declared column length
+
+	const ULONG RECORD_LENGTH = 256;
+
+	void makeRecords(Array<UCHAR>& data, ULONG count)
+	{
+		static const char* const names[] = {"Smith", "Johnson", "Williams", "Brown", "Jones"};
+		static const char* const cities[] = {"London", "New York", "Paris", "Moscow", "Prague"};
+
+		for (ULONG i = 0; i < count; i++)
+		{
+			char record[RECORD_LENGTH];
+			memset(record, ' ', sizeof(record));
+
+			const int length = snprintf(record, sizeof(record),
+				"{\"id\": %u, \"name\": \"%s\", \"city\": \"%s\", \"status\": \"active\", "
+				"\"billing\": {\"city\": \"%s\", \"status\": \"active\"}, \"amount\": %u.%02u}",
+				i, names[i % 5], cities[(i / 3) % 5], cities[(i / 3) % 5], (i * 7919) % 10000, i % 100);
+			record[length] = ' ';
+
+			data.add(reinterpret_cast<const UCHAR*>(record), sizeof(record));
+		}
+	}
+
+	void makeRandom(Array<UCHAR>& data, ULONG length)
+	{
+		ULONG seed = 1;
+
+		for (ULONG i = 0; i < length; i++)
+		{
+			seed = seed * 1103515245 + 12345;
+			data.add(UCHAR(seed >> 16));
+		}
+	}
+
+	ULONG blockPackAndUnpack(const Array<UCHAR>& data)
+	{
+		Array<UCHAR> packBuffer;
+		const ULONG packedLength = BlockCompressor::pack(data.getCount(), data.begin(),
+			data.getCount(), packBuffer.getBuffer(data.getCount(), false));
+
+		if (!packedLength)
+			return 0;
+
+		BOOST_TEST(BlockCompressor::getUnpackedLength(packedLength, packBuffer.begin()) == data.getCount());
+
+		Array<UCHAR> unpackBuffer;
+		unpackBuffer.getBuffer(data.getCount(), false);
+
+		BOOST_TEST(BlockCompressor::unpack(packedLength, packBuffer.begin(),
+			unpackBuffer.getCount(), unpackBuffer.begin()) == unpackBuffer.end());
+
+		BOOST_TEST(memcmp(data.begin(), unpackBuffer.begin(), data.getCount()) == 0);
+
+		return packedLength;
+	}
+}
+
+
+
 BOOST_AUTO_TEST_SUITE(CompressorTests)
 
 BOOST_AUTO_TEST_CASE(PackAndUnpackTest)
@@ -33,6 +95,72 @@ BOOST_AUTO_TEST_CASE(PackAndUnpackTest)
 	BOOST_TEST(memcmp(data, unpackBuffer.begin(), dataLength) == 0);
 }
 
+BOOST_AUTO_TEST_CASE(BlockPackAndUnpackTest)
+{
+	Array<UCHAR> records;
+	makeRecords(records, 100);
+	BOOST_TEST(blockPackAndUnpack(records) < records.getCount() / 3);
+
+	// Single record and long runs of the same byte
+	Array<UCHAR> record(records.begin(), RECORD_LENGTH);
+	BOOST_TEST(blockPackAndUnpack(record) > 0u);
+
+	Array<UCHAR> runs;
+	runs.resize(20000, 0);
+	runs.resize(40000, 'x');
+	BOOST_TEST(blockPackAndUnpack(runs) < 200u);
+
+	// Random data does not fit into the output of the same length
+	Array<UCHAR> random;
+	makeRandom(random, 1000);
+	BOOST_TEST(blockPackAndUnpack(random) == 0u);
+
+	// Fragments of the stored image may be padded by zeroes
+	Array<UCHAR> packBuffer;
+	const ULONG packedLength = BlockCompressor::pack(record.getCount(), record.begin(),
+		record.getCount(), packBuffer.getBuffer(record.getCount(), false));
+	packBuffer.shrink(packedLength);
+	packBuffer.resize(packedLength + 3, 0);
+
+	Array<UCHAR> unpackBuffer;
+	unpackBuffer.getBuffer(record.getCount(), false);
+
+	BOOST_TEST(BlockCompressor::unpack(packBuffer.getCount(), packBuffer.begin(),
+		unpackBuffer.getCount(), unpackBuffer.begin()) == unpackBuffer.end());
+	BOOST_TEST(memcmp(record.begin(), unpackBuffer.begin(), record.getCount()) == 0);
+}
+
+BOOST_AUTO_TEST_CASE(BlockVsRunLengthTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	Array<UCHAR> records;
+	makeRecords(records, 100);
+
+	const ULONG recordLength = RECORD_LENGTH;
+	const ULONG count = records.getCount() / recordLength;
+	ULONG rlePacked = 0, blockPacked = 0;
+
+	Array<UCHAR> packBuffer;
+	UCHAR* const buffer = packBuffer.getBuffer(recordLength, false);
+
+	// Repeated names and values within a record are what RLE can't catch
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		const UCHAR* const record = records.begin() + i * recordLength;
+
+		const Compressor dcc(pool, true, true, recordLength, record);
+		rlePacked += dcc.getPackedLength();
+
+		const ULONG length = BlockCompressor::pack(recordLength, record, recordLength, buffer);
+		BOOST_TEST(length > 0u);
+		blockPacked += length;
+	}
+
+	BOOST_TEST(blockPacked < rlePacked);
+}
+
 BOOST_AUTO_TEST_SUITE_END()	// CompressorTests
 
 
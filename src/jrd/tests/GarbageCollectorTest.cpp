@@ -0,0 +1,123 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/Synchronize.h"
+#include "../jrd/GarbageCollector.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(GarbageCollectorSuite)
+
+
+namespace
+{
+	// SyncObject needs to know the current thread, as engine threads do
+	void initThread()
+	{
+		ThreadSync::getThread("GarbageCollectorTest");
+	}
+
+	ULONG countPages(PageBitmap* bitmap)
+	{
+		ULONG count = 0;
+
+		if (bitmap->getFirst())
+		{
+			do
+			{
+				count++;
+			} while (bitmap->getNext());
+		}
+
+		delete bitmap;
+		return count;
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(GarbageCollectorTests)
+
+BOOST_AUTO_TEST_CASE(PriorityTest)
+{
+	initThread();
+
+	GarbageCollector gc(*getDefaultMemoryPool(), nullptr);
+
+	// Relation 130 has more pages, relation 140 is read more often
+	for (ULONG page = 0; page < 4; page++)
+		gc.addPage(130, page, 10);
+
+	for (ULONG i = 0; i < 6; i++)
+		gc.addPage(140, 7, 10, true);
+
+	gc.addPage(150, 1, 10);
+	gc.addPage(150, 2, 100);
+
+	BOOST_TEST(gc.getPendingPages() == 7u);
+
+	USHORT relID = 0;
+	PageBitmap* bitmap = gc.getPages(50, relID);
+	BOOST_TEST(relID == 140);
+	BOOST_TEST(countPages(bitmap) == 1u);
+
+	bitmap = gc.getPages(50, relID);
+	BOOST_TEST(relID == 130);
+	BOOST_TEST(countPages(bitmap) == 4u);
+
+	// Page of the active transaction is not taken
+	bitmap = gc.getPages(50, relID);
+	BOOST_TEST(relID == 150);
+	BOOST_TEST(countPages(bitmap) == 1u);
+	BOOST_TEST(gc.getPendingPages() == 1u);
+
+	// Relations are busy until released
+	gc.addPage(130, 5, 10);
+	BOOST_TEST(!gc.getPages(50, relID));
+
+	gc.releasePages(130, 4);
+	bitmap = gc.getPages(50, relID);
+	BOOST_TEST(relID == 130);
+	BOOST_TEST(countPages(bitmap) == 1u);
+
+	gc.releasePages(130, 1);
+	gc.releasePages(140, 1);
+	gc.releasePages(150, 1);
+	BOOST_TEST(gc.getProcessedPages() == 7u);
+
+	bitmap = gc.getPages(200, relID);
+	BOOST_TEST(relID == 150);
+	BOOST_TEST(countPages(bitmap) == 1u);
+	BOOST_TEST(gc.getPendingPages() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(RoundRobinTest)
+{
+	initThread();
+
+	GarbageCollector gc(*getDefaultMemoryPool(), nullptr);
+	USHORT relID = 0;
+
+	// Relations of the same priority are taken in turn
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (USHORT rel = 130; rel < 133; rel++)
+			gc.addPage(rel, 1, 10);
+
+		for (USHORT rel = 130; rel < 133; rel++)
+		{
+			PageBitmap* const bitmap = gc.getPages(50, relID);
+			BOOST_TEST(relID == rel);
+			BOOST_TEST(countPages(bitmap) == 1u);
+			gc.releasePages(relID, 1);
+		}
+
+		BOOST_TEST(!gc.getPages(50, relID));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// GarbageCollectorTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// GarbageCollectorSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -0,0 +1,196 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/optimizer/Histogram.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(HistogramSuite)
+
+
+namespace
+{
+	IndexHistogram::Key makeKey(ULONG value)
+	{
+		const UCHAR data[] = {
+			UCHAR(value >> 24), UCHAR(value >> 16), UCHAR(value >> 8), UCHAR(value), 0xFF
+		};
+
+		IndexHistogram::Key key;
+		IndexHistogram::makeKey(data, sizeof(data), 1, key);
+		return key;
+	}
+
+	// Half of the entries have the same value, others are unique
+
+	void buildSkewed(IndexHistogram& histogram, ULONG count)
+	{
+		histogram.add(IndexHistogram::Key());	// NULL
+
+		for (ULONG i = 0; i < count / 2; i++)
+			histogram.add(makeKey(1));
+
+		for (ULONG i = 2; i < count / 2 + 1; i++)
+			histogram.add(makeKey(i));
+
+		histogram.finish(1.0f / (count / 2 + 1));
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(HistogramTests)
+
+BOOST_AUTO_TEST_CASE(LeadingSegmentTest)
+{
+	const UCHAR compound[] = {2, 'a', 'b', 'c', 'd', 2, 'e', 0, 0, 0, 1, 'x', 'y'};
+	IndexHistogram::Key key;
+
+	IndexHistogram::makeKey(compound, sizeof(compound), 2, key);
+	BOOST_TEST(key.length == 5u);
+	BOOST_TEST(memcmp(key.data, "abcde", 5) == 0);
+
+	const UCHAR nullLeading[] = {1, 'x', 'y'};
+	IndexHistogram::makeKey(nullLeading, sizeof(nullLeading), 2, key);
+	BOOST_TEST(key.length == 0u);
+
+	const UCHAR padded[] = {'a', 'b', 0, 0};
+	IndexHistogram::makeKey(padded, sizeof(padded), 1, key);
+	BOOST_TEST(key.length == 2u);
+}
+
+BOOST_AUTO_TEST_CASE(SkewedDataTest)
+{
+	IndexHistogram histogram(*getDefaultMemoryPool());
+	const ULONG count = 100000;
+	buildSkewed(histogram, count);
+
+	// Common value is estimated exactly, rare ones are close to a single entry
+	BOOST_TEST(histogram.getEqualSelectivity(makeKey(1)) == 0.5, boost::test_tools::tolerance(0.001));
+	BOOST_TEST(histogram.getEqualSelectivity(makeKey(1000)) < 10.0 / count);
+	BOOST_TEST(histogram.getEqualSelectivity(makeKey(count)) == 0.0);
+	BOOST_TEST(histogram.getEqualSelectivity(IndexHistogram::Key()) < 0.0);
+
+	const auto lower = makeKey(2);
+	const auto upper = makeKey(count / 4 + 1);
+	BOOST_TEST(histogram.getRangeSelectivity(&lower, &upper) == 0.25, boost::test_tools::tolerance(0.02));
+	BOOST_TEST(histogram.getRangeSelectivity(nullptr, &lower) == 0.5, boost::test_tools::tolerance(0.02));
+	BOOST_TEST(histogram.getRangeSelectivity(&upper, nullptr) == 0.25, boost::test_tools::tolerance(0.02));
+}
+
+BOOST_AUTO_TEST_CASE(SerializeTest)
+{
+	IndexHistogram histogram(*getDefaultMemoryPool());
+	buildSkewed(histogram, 10000);
+
+	UCharBuffer buffer;
+	histogram.serialize(buffer);
+
+	IndexHistogram loaded(*getDefaultMemoryPool());
+	BOOST_TEST(loaded.parse(buffer.begin(), buffer.getCount()));
+	BOOST_TEST(loaded.getSelectivity() == histogram.getSelectivity());
+
+	for (const ULONG value : {1u, 100u, 4000u})
+	{
+		const auto key = makeKey(value);
+		BOOST_TEST(loaded.getEqualSelectivity(key) == histogram.getEqualSelectivity(key));
+		BOOST_TEST(loaded.getRangeSelectivity(&key, nullptr) == histogram.getRangeSelectivity(&key, nullptr));
+	}
+
+	IndexHistogram truncated(*getDefaultMemoryPool());
+	BOOST_TEST(!truncated.parse(buffer.begin(), buffer.getCount() - 1));
+}
+
+BOOST_AUTO_TEST_CASE(AppendTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	const ULONG count = 100000;
+
+	IndexHistogram whole(pool);
+	buildSkewed(whole, count);
+
+	// The same keys split into ranges, one of them splits the run of the common value
+
+	const ULONG splits[] = {1000, 30000, 50001, 77777, count - 1};
+	IndexHistogram merged(pool);
+	merged.add(IndexHistogram::Key());	// NULL
+
+	ULONG key = 0;
+	for (const auto split : splits)
+	{
+		IndexHistogram range(pool);
+
+		for (; key < split; key++)
+			range.add(makeKey(key < count / 2 ? 1 : key - count / 2 + 2));
+
+		merged.append(range);
+	}
+
+	merged.finish(1.0f / (count / 2 + 1));
+
+	BOOST_TEST(merged.getEqualSelectivity(makeKey(1)) == whole.getEqualSelectivity(makeKey(1)),
+		boost::test_tools::tolerance(0.001));
+	BOOST_TEST(merged.getEqualSelectivity(makeKey(1000)) < 10.0 / count);
+	BOOST_TEST(merged.getEqualSelectivity(makeKey(count)) == 0.0);
+
+	const auto lower = makeKey(2);
+	const auto upper = makeKey(count / 4 + 1);
+	BOOST_TEST(merged.getRangeSelectivity(&lower, &upper) == 0.25, boost::test_tools::tolerance(0.02));
+	BOOST_TEST(merged.getRangeSelectivity(&upper, nullptr) == 0.25, boost::test_tools::tolerance(0.02));
+}
+
+BOOST_AUTO_TEST_CASE(AppendSplitRunTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	// More frequent values than the histogram keeps, separated by unique ones.
+	// Ranges split the runs of frequent values, including the least kept one.
+
+	const ULONG frequent = IndexHistogram::MAX_COMMON_VALUES + 4;
+
+	Array<ULONG> values(pool);
+	for (ULONG i = 1; i <= frequent; i++)
+	{
+		for (ULONG j = 0; j < 1000 + i * 10; j++)
+			values.add(i * 1000);
+
+		for (ULONG j = 1; j <= 500; j++)
+			values.add(i * 1000 + j);
+	}
+
+	IndexHistogram whole(pool);
+	for (const auto value : values)
+		whole.add(makeKey(value));
+
+	whole.finish(1.0f / (frequent * 501));
+
+	IndexHistogram merged(pool);
+	const ULONG rangeLength = 777;
+
+	for (FB_SIZE_T pos = 0; pos < values.getCount(); pos += rangeLength)
+	{
+		IndexHistogram range(pool);
+
+		for (FB_SIZE_T i = pos; i < values.getCount() && i < pos + rangeLength; i++)
+			range.add(makeKey(values[i]));
+
+		merged.append(range);
+	}
+
+	merged.finish(1.0f / (frequent * 501));
+
+	// The most frequent values are kept with their exact counts
+
+	for (ULONG i = frequent - IndexHistogram::MAX_COMMON_VALUES + 1; i <= frequent; i++)
+	{
+		const auto key = makeKey(i * 1000);
+		BOOST_TEST(merged.getEqualSelectivity(key) == (1000.0 + i * 10) / values.getCount());
+		BOOST_TEST(merged.getEqualSelectivity(key) == whole.getEqualSelectivity(key));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// HistogramTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// HistogramSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
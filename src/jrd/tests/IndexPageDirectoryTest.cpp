@@ -0,0 +1,215 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/btn.h"
+
+using namespace Firebird;
+using namespace Jrd;
+using namespace Ods;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(IndexPageDirectorySuite)
+
+
+namespace
+{
+	constexpr ULONG PAGE_SIZE = 16384;
+
+	// Leaf page without jump nodes filled with the prefix compressed keys:
+	// 4 bytes big-endian numbers, every third one duplicated, every fifth
+	// one followed by the extra byte (as longer compound keys are)
+
+	class Page
+	{
+	public:
+		Page(MemoryPool& pool, bool endBucket)
+			: buffer(pool)
+		{
+			page = reinterpret_cast<btree_page*>(buffer.getBuffer(PAGE_SIZE));
+			memset(page, 0, PAGE_SIZE);
+
+			UCHAR* pointer = page->btr_nodes;
+			UCHAR prevKey[8];
+			USHORT prevLength = 0;
+			ULONG value = 0;
+
+			for (SINT64 number = 1; pointer < (UCHAR*) page + PAGE_SIZE - 64; number++)
+			{
+				if (number % 3)
+					value += 7;
+
+				UCHAR key[8] = {UCHAR(value >> 24), UCHAR(value >> 16), UCHAR(value >> 8), UCHAR(value), 1};
+				const USHORT length = (value % 5) ? 4 : 5;
+
+				const USHORT prefix = IndexNode::computePrefix(prevKey, prevLength, key, length);
+
+				IndexNode node;
+				node.setNode(prefix, length - prefix, RecordNumber(number));
+				node.data = key + prefix;
+				pointer = node.writeNode(pointer, true);
+
+				memcpy(prevKey, key, length);
+				prevLength = length;
+				lastValue = value;
+			}
+
+			IndexNode node;
+			if (endBucket)
+			{
+				// Key of the first node at the next page
+				const ULONG next = lastValue + 7;
+				UCHAR key[4] = {UCHAR(next >> 24), UCHAR(next >> 16), UCHAR(next >> 8), UCHAR(next)};
+				const USHORT prefix = IndexNode::computePrefix(prevKey, prevLength, key, sizeof(key));
+
+				node.setNode(prefix, sizeof(key) - prefix, RecordNumber(0), 0, true);
+				node.data = key + prefix;
+			}
+			else
+				node.setEndLevel();
+
+			pointer = node.writeNode(pointer, true);
+			page->btr_length = pointer - (UCHAR*) page;
+		}
+
+		// Sequential search, as find_node_start_point() does
+		FB_SIZE_T findNode(const UCHAR* key, USHORT length) const
+		{
+			UCHAR* pointer = page->btr_nodes;
+			UCHAR nodeKey[MAX_KEY_LENGTH];
+			FB_SIZE_T pos = 0;
+
+			IndexNode node;
+
+			while (true)
+			{
+				pointer = node.readNode(pointer, true);
+
+				if (node.isEndLevel)
+					return pos;
+
+				memcpy(nodeKey + node.prefix, node.data, node.length);
+				const USHORT nodeLength = node.prefix + node.length;
+
+				const int result = memcmp(nodeKey, key, MIN(nodeLength, length));
+				if (result > 0 || (!result && nodeLength >= length))
+					return pos;
+
+				pos++;
+
+				if (node.isEndBucket)
+					return pos;
+			}
+		}
+
+		btree_page* page;
+		ULONG lastValue = 0;
+
+	private:
+		static constexpr USHORT MAX_KEY_LENGTH = 8;
+
+		UCharBuffer buffer;
+	};
+
+	void makeKey(ULONG value, UCHAR* key)
+	{
+		key[0] = UCHAR(value >> 24);
+		key[1] = UCHAR(value >> 16);
+		key[2] = UCHAR(value >> 8);
+		key[3] = UCHAR(value);
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(IndexPageDirectoryTests)
+
+BOOST_AUTO_TEST_CASE(FindNodeTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	for (const bool endBucket : {false, true})
+	{
+		Page page(pool, endBucket);
+
+		IndexPageDirectory directory(pool);
+		BOOST_TEST(directory.build(page.page, PAGE_SIZE * 2));
+		BOOST_TEST(directory.isEndLevel(directory.getCount() - 1) == !endBucket);
+
+		// Every existing and missing value, shorter and longer keys, keys beyond the page
+		for (ULONG value = 0; value <= page.lastValue + 20; value++)
+		{
+			UCHAR key[5];
+			makeKey(value, key);
+			key[4] = 0;
+
+			for (USHORT length = 1; length <= sizeof(key); length++)
+			{
+				const FB_SIZE_T expected = page.findNode(key, length);
+				const FB_SIZE_T pos = directory.findNode(key, length);
+				BOOST_TEST(pos == expected);
+
+				if (pos && pos < directory.getCount())
+				{
+					USHORT prevLength;
+					const UCHAR* prevKey = directory.getKey(pos - 1, prevLength);
+					BOOST_TEST(directory.getPrefix(pos - 1, key, length) ==
+						IndexNode::computePrefix(prevKey, prevLength, key, length));
+				}
+			}
+		}
+
+		// Empty key matches the first node
+		BOOST_TEST(directory.findNode(nullptr, 0) == 0u);
+
+		// Node offsets point to the nodes
+		IndexNode node;
+		node.readNode(directory.getNode(page.page, 0), true);
+		BOOST_TEST(node.recordNumber.getValue() == 1);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(KeySizeLimitTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	Page page(pool, false);
+
+	IndexPageDirectory directory(pool);
+	BOOST_TEST(!directory.build(page.page, PAGE_SIZE / 4));
+
+	// Page without the END_LEVEL or END_BUCKET marker is inconsistent
+	page.page->btr_length = BTR_SIZE + 16;
+	BOOST_TEST(!directory.build(page.page, PAGE_SIZE * 2));
+}
+
+BOOST_AUTO_TEST_CASE(RandomLookupTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	Page page(pool, false);
+
+	IndexPageDirectory directory(pool);
+	BOOST_TEST(directory.build(page.page, PAGE_SIZE * 2));
+
+	// Memory accounted by the page cache covers the decoded keys and the node entries,
+	// that's a few times more than the page itself
+	BOOST_TEST(directory.getMemorySize() > PAGE_SIZE * 2);
+
+	ULONG seed = 1;
+
+	for (ULONG i = 0; i < 2000; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+
+		UCHAR key[4];
+		makeKey(seed % (page.lastValue + 1), key);
+		BOOST_TEST(directory.findNode(key, sizeof(key)) == page.findNode(key, sizeof(key)));
+	}
+
+	// Rebuild replaces the previous content
+	Page endBucketPage(pool, true);
+	BOOST_TEST(directory.build(endBucketPage.page, PAGE_SIZE * 2));
+	BOOST_TEST(!directory.isEndLevel(directory.getCount() - 1));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// IndexPageDirectoryTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// IndexPageDirectorySuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
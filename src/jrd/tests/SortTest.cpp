@@ -0,0 +1,189 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/jrd.h"
+#include "../jrd/sort.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(SortSuite)
+
+
+namespace
+{
+	// Records laid out as the sort buffer does: back pointer to the pointer
+	// slot followed by the normalized key. Pointers array is guarded by the
+	// low and high keys, as Sort::quickSort() expects.
+
+	class Records
+	{
+	public:
+		static constexpr ULONG BCKPTR_LONGS = sizeof(SORTP*) >> SHIFTLONG;
+
+		Records(MemoryPool& pool, ULONG count, ULONG keyLongs, ULONG range)
+			: longs(ROUNDUP(BCKPTR_LONGS + keyLongs, BCKPTR_LONGS)),
+			  keyLongs(keyLongs),
+			  data(pool),
+			  guards(pool),
+			  pointers(pool)
+		{
+			// Extra record at the end as pairs check reads a bit beyond the key
+
+			SORTP* const buffer = reinterpret_cast<SORTP*>(
+				data.getBuffer((count + 1) * longs / 2 + 1, false));
+
+			SORTP* const low = guards.getBuffer(longs * 2, false);
+			SORTP* const high = low + longs;
+
+			for (ULONG i = 0; i < longs; i++)
+			{
+				low[i] = 0;
+				high[i] = MAX_ULONG;
+			}
+
+			SORTP** const ptr = pointers.getBuffer(count + 2, false);
+			ptr[0] = low;
+			ptr[count + 1] = high;
+
+			ULONG seed = 12345;
+
+			for (ULONG i = 0; i < count; i++)
+			{
+				SORTP* const key = buffer + i * longs + BCKPTR_LONGS;
+
+				for (ULONG j = 0; j < keyLongs; j++)
+				{
+					seed = seed * 1103515245 + 12345;
+					key[j] = j ? seed : seed % range;
+				}
+
+				ptr[i + 1] = key;
+				((SORTP***) key)[-1] = ptr + i + 1;
+			}
+
+			memset(buffer + count * longs, 0, longs * sizeof(SORTP));
+		}
+
+		SORTP** begin()
+		{
+			return pointers.begin() + 1;
+		}
+
+		ULONG getCount() const
+		{
+			return pointers.getCount() - 2;
+		}
+
+		bool isSorted() const
+		{
+			SORTP* const* const ptr = pointers.begin() + 1;
+
+			for (ULONG i = 0; i < pointers.getCount() - 2; i++)
+			{
+				if (((SORTP* const**) ptr[i])[-1] != ptr + i)
+					return false;
+
+				if (i && compare(ptr[i - 1], ptr[i]) > 0)
+					return false;
+			}
+
+			return true;
+		}
+
+		bool hasSameKeys(const Records& other) const
+		{
+			for (ULONG i = 1; i < pointers.getCount() - 1; i++)
+			{
+				if (compare(pointers[i], other.pointers[i]) != 0)
+					return false;
+			}
+
+			return true;
+		}
+
+		const ULONG longs;
+		const ULONG keyLongs;
+
+	private:
+		int compare(const SORTP* a, const SORTP* b) const
+		{
+			for (ULONG i = 0; i < keyLongs; i++)
+			{
+				if (a[i] != b[i])
+					return a[i] < b[i] ? -1 : 1;
+			}
+
+			return 0;
+		}
+
+		Array<FB_UINT64> data;
+		Array<SORTP> guards;
+		Array<SORTP*> pointers;
+	};
+}
+
+
+BOOST_AUTO_TEST_SUITE(SortTests)
+
+BOOST_AUTO_TEST_CASE(RadixSortTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	for (ULONG keyLongs = 1; keyLongs <= 4; keyLongs++)
+	{
+		// Small range of the first key longword makes many duplicates
+
+		for (const ULONG range : {10u, MAX_ULONG})
+		{
+			Records quick(pool, 10000, keyLongs, range);
+			Records radix(pool, 10000, keyLongs, range);
+
+			Sort::quickSort(quick.begin(), quick.getCount(), quick.longs);
+			BOOST_TEST(quick.isSorted());
+
+			BOOST_TEST(Sort::radixSort(pool, radix.begin(), radix.getCount(), radix.keyLongs));
+			BOOST_TEST(radix.isSorted());
+
+			BOOST_TEST(radix.hasSameKeys(quick));
+		}
+	}
+
+	Records longKeys(pool, 100, 5, MAX_ULONG);
+	BOOST_TEST(!Sort::radixSort(pool, longKeys.begin(), longKeys.getCount(), longKeys.keyLongs));
+}
+
+BOOST_AUTO_TEST_CASE(RadixSortSmallTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	// Few records and identical keys, where the passes have almost nothing to move
+
+	for (ULONG keyLongs = 1; keyLongs <= 4; keyLongs++)
+	{
+		for (const ULONG count : {1u, 2u, 3u, 17u})
+		{
+			for (const ULONG range : {1u, 2u, MAX_ULONG})
+			{
+				Records quick(pool, count, keyLongs, range);
+				Records radix(pool, count, keyLongs, range);
+
+				Sort::quickSort(quick.begin(), quick.getCount(), quick.longs);
+
+				BOOST_TEST(Sort::radixSort(pool, radix.begin(), radix.getCount(), radix.keyLongs));
+				BOOST_TEST(radix.isSorted());
+
+				BOOST_TEST(radix.hasSameKeys(quick));
+			}
+		}
+	}
+
+	Records empty(pool, 0, 1, MAX_ULONG);
+	BOOST_TEST(!Sort::radixSort(pool, empty.begin(), empty.getCount(), empty.keyLongs));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// SortTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// SortSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
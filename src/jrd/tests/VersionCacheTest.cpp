@@ -0,0 +1,77 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/VersionCache.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(VersionCacheSuite)
+
+
+namespace
+{
+	struct Version
+	{
+		USHORT format = 0;
+		TraNumber transaction = 0;
+		Array<UCHAR> data;
+	};
+
+	bool getVersion(VersionCache& cache, SINT64 number, TraNumber head, CommitNumber snapshot,
+		Version& version)
+	{
+		return cache.get(number, head, snapshot,
+			[&version](USHORT format, TraNumber transaction, ULONG length, const UCHAR* data) {
+				version.format = format;
+				version.transaction = transaction;
+				version.data.assign(data, length);
+			});
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(VersionCacheTests)
+
+BOOST_AUTO_TEST_CASE(GetAndPutTest)
+{
+	VersionCache cache(*getDefaultMemoryPool());
+	Version version;
+
+	// Empty cache
+	BOOST_TEST(!getVersion(cache, 1, 100, 50, version));
+
+	const UCHAR data[] = "record data";
+	cache.put(1, 100, 90, 40, 3, sizeof(data), data);
+
+	BOOST_TEST(getVersion(cache, 1, 100, 50, version));
+	BOOST_TEST(version.format == 3);
+	BOOST_TEST(version.transaction == 90u);
+	BOOST_TEST(version.data.getCount() == sizeof(data));
+	BOOST_TEST(memcmp(version.data.begin(), data, sizeof(data)) == 0);
+
+	// Version committed at the snapshot is visible, later commit is not
+	BOOST_TEST(getVersion(cache, 1, 100, 40, version));
+	BOOST_TEST(!getVersion(cache, 1, 100, 39, version));
+
+	// Primary version was changed by another transaction
+	BOOST_TEST(!getVersion(cache, 1, 101, 50, version));
+
+	// Another record sharing the same slot replaces the cached one
+	cache.put(1 + VersionCache::SIZE, 200, 190, 45, 3, sizeof(data), data);
+	BOOST_TEST(!getVersion(cache, 1, 100, 50, version));
+	BOOST_TEST(getVersion(cache, 1 + VersionCache::SIZE, 200, 50, version));
+	BOOST_TEST(!getVersion(cache, 2, 200, 50, version));
+
+	// Long records are not cached
+	Array<UCHAR> longData;
+	longData.resize(VersionCache::MAX_LENGTH + 1, 'x');
+	cache.put(3, 300, 290, 45, 3, longData.getCount(), longData.begin());
+	BOOST_TEST(!getVersion(cache, 3, 300, 50, version));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// VersionCacheTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// VersionCacheSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -4269,10 +4269,12 @@ void jrd_tra::finiBulkInsert(thread_db* tdbb, bool /*commit*/)
 		// Currently, there is no way to explicitly undo bulk insert actions, while it
 		// might be implemented later if needed. Thus "commit" arg is not used for now.
 
-		tra_bulkInsert->flush(tdbb);
+		// Don't try to flush it again if flush fails, e.g. due to unique constraint violation
 
-		delete tra_bulkInsert;
+		AutoPtr<BulkInsert> bulkInsert(tra_bulkInsert);
 		tra_bulkInsert = nullptr;
+
+		bulkInsert->flush(tdbb);
 	}
 }
 
@@ -561,9 +561,11 @@ enum dfw_t : int {
 	dfw_arg_check_blr,		// check if BLR is still compilable
 	dfw_arg_new_name,		// new name
 	dfw_arg_field_not_null,	// set domain to not nullable
+	dfw_arg_parallel_workers,	// parallel workers for dfw_set_statistics, id is the workers count
 
 	dfw_db_crypt,			// change database encryption status
 	dfw_set_linger,			// set database linger
+	dfw_set_page_buffers,	// set database page buffers
 	dfw_clear_cache,		// clear user mapping cache
 	dfw_set_statistics,		// set statistics support
 	dfw_deps_to_disk,		// store saved deps to disk
@@ -658,6 +658,13 @@ static void explain_pp_bits(const UCHAR bits, Firebird::string& names)
 			names.append(", ");
 		names.append("reserved");
 	}
+
+	if (bits & ppg_dp_all_visible)
+	{
+		if (!names.empty())
+			names.append(", ");
+		names.append("all visible");
+	}
 }
 
 
@@ -1451,6 +1458,7 @@ static void print_rhd(USHORT length, const rhd* header)
 		fprintf(stdout, "%s ", (header->rhd_flags & rhd_large) ? "LRG" : "   ");
 		fprintf(stdout, "%s ", (header->rhd_flags & rhd_damaged) ? "DAM" : "   ");
 		fprintf(stdout, "%s ", (header->rhd_flags & rhd_not_packed) ? "NPK" : "   ");
+		fprintf(stdout, "%s ", (header->rhd_flags & rhd_block_packed) ? "BPK" : "   ");
 		fprintf(stdout, "\n");
 	}
 }
@@ -1486,7 +1494,18 @@ Validation::RTN Validation::walk_blob(jrd_rel* relation, const blh* header, USHO
 	switch (header->blh_level)
 	{
 	case 0:
-		// Level 0 blobs have no work to do.
+		// Level 0 blobs have no work to do, except of the block compressed
+		// data clump that must fit the page when unpacked.
+		if (header->blh_flags & rhd_block_packed)
+		{
+			const ULONG maxLength = vdr_tdbb->getDatabase()->dbb_page_size - DPG_SIZE;
+
+			if (length <= BLH_SIZE ||
+				BlockCompressor::getUnpackedLength(length - BLH_SIZE, (const UCHAR*) header->blh_page) > maxLength)
+			{
+				return corrupt(VAL_BLOB_CORRUPT, relation, number.getValue());
+			}
+		}
 		return rtn_ok;
 	case 1:
 	case 2:
@@ -2648,6 +2667,12 @@ Validation::RTN Validation::walk_pointer_page(jrd_rel* relation, ULONG sequence)
 			if (*pages)
 			{
 				UCHAR &pp_bits = PPG_DP_BITS_BYTE(bits, slot);
+
+				// "All visible" bit can't be evaluated using data page flags,
+				// it's valid only for the swept data page
+				if (new_pp_bits & ppg_dp_swept)
+					new_pp_bits |= (pp_bits & ppg_dp_all_visible);
+
 				if (pp_bits != new_pp_bits)
 				{
 					Firebird::string s_pp, s_dp;
@@ -2884,9 +2909,10 @@ Validation::RTN Validation::walk_record(jrd_rel* relation, const rhd* header, US
 		release_page(&window);
 	}
 
-	// Validate unpacked record length
+	// Validate unpacked record length. The fragments of the block compressed
+	// record contain the compressed image, its length isn't known in advance.
 
-	if (!delta_flag && remainingLength != 0)
+	if (!delta_flag && !(header->rhd_flags & rhd_block_packed) && remainingLength != 0)
 		return corrupt(VAL_REC_WRONG_LENGTH, relation, number.getValue());
 
 	return rtn_ok;
@@ -2926,6 +2952,8 @@ void restoreFlags(UCHAR* byte, UCHAR flags, bool empty)
 		*byte |= bit;
 	else
 		*byte &= ~bit;
+
+	*byte &= ~PPG_DP_BIT_MASK(slot, ppg_dp_all_visible);
 }
 
 void Validation::checkDPinPP(jrd_rel* relation, ULONG page_number)
@@ -99,6 +99,7 @@
 using namespace Jrd;
 using namespace Firebird;
 
+static void cache_version(thread_db*, record_param*, MemoryPool*, TraNumber);
 static void check_class(thread_db*, jrd_tra*, record_param*, record_param*, USHORT);
 static bool check_nullify_source(thread_db*, record_param*, record_param*, int, int = -1);
 static void check_owner(thread_db*, jrd_tra*, record_param*, record_param*, USHORT);
@@ -111,6 +112,9 @@ static void expunge(thread_db*, record_param*, const jrd_tra*, ULONG);
 static bool dfw_should_know(thread_db*, record_param* org_rpb, record_param* new_rpb,
 	USHORT irrelevant_field, bool void_update_is_relevant = false);
 static void garbage_collect(thread_db*, record_param*, ULONG, RecordStack&);
+static ULONG garbage_collect_pages(thread_db*, GarbageCollector*, USHORT, PageBitmap*, record_param&, jrd_tra*&);
+static CommitNumber get_cache_snapshot(thread_db*, const jrd_tra*, const record_param*, const MemoryPool*, bool);
+static bool get_cached_version(thread_db*, record_param*, MemoryPool*, CommitNumber);
 
 
 #ifdef VIO_DEBUG
@@ -601,6 +605,76 @@ namespace
 
 		return Compressor::unpack(rpb->rpb_length, rpb->rpb_address, outLength, output);
 	}
+
+	// Holds the block compressed image of a record while its fragments are read.
+	// prepare() redirects the output of unpack() into the image buffer,
+	// unpack() decompresses the image into the original output area.
+
+	class BlockPackedImage
+	{
+	public:
+		explicit BlockPackedImage(MemoryPool& pool)
+			: m_buffer(pool)
+		{}
+
+		BlockPackedImage(MemoryPool& pool, const record_param* rpb, UCHAR*& tail, const UCHAR*& tailEnd)
+			: m_buffer(pool)
+		{
+			prepare(rpb, tail, tailEnd);
+		}
+
+		void prepare(const record_param* rpb, UCHAR*& tail, const UCHAR*& tailEnd)
+		{
+			if (!(rpb->rpb_flags & rpb_block_packed))
+				return;
+
+			// The image is always shorter than the record itself
+
+			m_output = tail;
+			m_outputEnd = tailEnd;
+
+			const ULONG length = tailEnd - tail;
+			tail = m_buffer.getBuffer(length, false);
+			tailEnd = tail + length;
+		}
+
+		UCHAR* unpack(UCHAR* tail, const UCHAR* tailEnd)
+		{
+			if (!m_output)
+				return tail;
+
+			fb_assert(tailEnd == m_buffer.end());
+
+			return BlockCompressor::unpack(tail - m_buffer.begin(), m_buffer.begin(),
+				m_outputEnd - m_output, m_output);
+		}
+
+	private:
+		Firebird::UCharBuffer m_buffer;
+		UCHAR* m_output = nullptr;
+		const UCHAR* m_outputEnd = nullptr;
+	};
+
+	// Prevents sweep from marking data pages of the relation as "all visible"
+	// while record versions are already removed but their index keys are not yet.
+
+	class GarbageCollectGuard
+	{
+	public:
+		explicit GarbageCollectGuard(jrd_rel* relation)
+			: m_relation(getPermanent(relation))
+		{
+			++m_relation->rel_gc_active;
+		}
+
+		~GarbageCollectGuard()
+		{
+			--m_relation->rel_gc_active;
+		}
+
+	private:
+		RelationPermanent* const m_relation;
+	};
 };
 
 
@@ -1245,6 +1319,25 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 		return false;
 	}
 
+	// The statement level snapshot usually needs the latest committed version of
+	// the record being updated by another transaction. Take it from the version
+	// cache of the relation, if possible, instead of walking the back versions.
+
+	const CommitNumber cache_snapshot = (state == tra_active && !forceBack) ?
+		get_cache_snapshot(tdbb, transaction, rpb, pool, writelock) : CN_ACTIVE;
+
+	if (cache_snapshot != CN_ACTIVE && get_cached_version(tdbb, rpb, pool, cache_snapshot))
+		return true;
+
+	// The version found could be cached if all newer ones belong to the transaction
+	// of the primary version. The primary version is recognized by its location.
+
+	const ULONG primary_page = rpb->rpb_page;
+	const USHORT primary_line = rpb->rpb_line;
+	TraNumber head_transaction = rpb->rpb_transaction_nr;
+	TraNumber upper_transaction = head_transaction;
+	bool head_chain = true;
+
 	// First, save the record indentifying information to be restored on exit
 
 	while (true)
@@ -1258,6 +1351,19 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 			rpb->rpb_f_page, rpb->rpb_f_line);
 #endif
 
+		if (cache_snapshot != CN_ACTIVE)
+		{
+			if (rpb->rpb_page == primary_page && rpb->rpb_line == primary_line)
+			{
+				head_transaction = rpb->rpb_transaction_nr;
+				head_chain = true;
+			}
+			else if (upper_transaction != head_transaction)
+				head_chain = false;
+
+			upper_transaction = rpb->rpb_transaction_nr;
+		}
+
 		if (rpb->rpb_flags & rpb_damaged)
 		{
 			CCH_RELEASE(tdbb, &rpb->getWindow(tdbb));
@@ -1659,6 +1765,9 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 			// might interfere with the updater (prepare_update, update_in_place...).
 			// That might be the reason for the rpb_chained check.
 
+			const bool cacheVersion = (cache_snapshot != CN_ACTIVE) && head_chain &&
+				rpb->rpb_transaction_nr != head_transaction;
+
 			const bool cannotGC =
 				rpb->rpb_transaction_nr >= oldest_snapshot || rpb->rpb_b_page == 0 ||
 				(rpb->rpb_flags & rpb_chained) || (attachment->att_flags & ATT_no_cleanup);
@@ -1673,6 +1782,9 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 					notify_garbage_collector(tdbb, rpb);
 				}
 
+				if (cacheVersion)
+					cache_version(tdbb, rpb, pool, head_transaction);
+
 				return true;
 			}
 
@@ -1682,6 +1794,10 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 				!rpb->rpb_relation->isTemporary())
 			{
 				notify_garbage_collector(tdbb, rpb);
+
+				if (cacheVersion)
+					cache_version(tdbb, rpb, pool, head_transaction);
+
 				return true;
 			}
 
@@ -1689,7 +1805,12 @@ bool VIO_chase_record_version(thread_db* tdbb, record_param* rpb,
 				GCLock::Shared gcGuard(tdbb, getPermanent(rpb->rpb_relation));
 
 				if (!gcGuard.gcEnabled())
+				{
+					if (cacheVersion)
+						cache_version(tdbb, rpb, pool, head_transaction);
+
 					return true;
+				}
 
 				purge(tdbb, rpb);
 			}
@@ -1844,6 +1965,10 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 
 	rpb->rpb_prior = (rpb->rpb_b_page && (rpb->rpb_flags & rpb_delta)) ? record : NULL;
 
+	// Block compressed record is collected from its fragments first
+
+	BlockPackedImage packed(*tdbb->getDefaultPool(), rpb, tail, tail_end);
+
 	// Snarf data from record
 
 	tail = unpack(rpb, tail_end - tail, tail);
@@ -1874,6 +1999,8 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 
 	CCH_RELEASE(tdbb, &rpb->getWindow(tdbb));
 
+	tail = packed.unpack(tail, tail_end);
+
 	// If this is a delta version, apply changes
 	ULONG length;
 	if (prior)
@@ -2765,6 +2892,7 @@ void VIO_intermediate_gc(thread_db* tdbb, record_param* rpb, jrd_tra* transactio
 
 	// Read head version with write lock and check if it is still the same version
 	record_param temp_rpb = *rpb;
+	GarbageCollectGuard gcGuard(rpb->rpb_relation);
 
 	// If record no longer exists - return
 	if (!DPM_get(tdbb, &temp_rpb, LCK_write))
@@ -2955,12 +3083,12 @@ bool VIO_get(thread_db* tdbb, record_param* rpb, jrd_tra* transaction, MemoryPoo
 		rpb->rpb_f_page, rpb->rpb_f_line);
 #endif
 
-	if (rpb->rpb_runtime_flags & RPB_undo_data)
+	if (rpb->rpb_runtime_flags & RPB_DATA_FLAGS)
 		fb_assert(rpb->getWindow(tdbb).win_bdb == NULL);
 	else
 		fb_assert(rpb->getWindow(tdbb).win_bdb != NULL);
 
-	if (pool && !(rpb->rpb_runtime_flags & RPB_undo_data))
+	if (pool && !(rpb->rpb_runtime_flags & RPB_DATA_FLAGS))
 	{
 		if (rpb->rpb_stream_flags & RPB_s_no_data)
 		{
@@ -3941,12 +4069,12 @@ bool VIO_next_record(thread_db* tdbb,
 		}
 	} while (!VIO_chase_record_version(tdbb, rpb, transaction, pool, false, false));
 
-	if (rpb->rpb_runtime_flags & RPB_undo_data)
+	if (rpb->rpb_runtime_flags & RPB_DATA_FLAGS)
 		fb_assert(rpb->getWindow(tdbb).win_bdb == NULL);
 	else
 		fb_assert(rpb->getWindow(tdbb).win_bdb != NULL);
 
-	if (pool && !(rpb->rpb_runtime_flags & RPB_undo_data))
+	if (pool && !(rpb->rpb_runtime_flags & RPB_DATA_FLAGS))
 	{
 		if (rpb->rpb_stream_flags & RPB_s_no_data)
 		{
@@ -4055,7 +4183,7 @@ bool VIO_refetch_record(thread_db* tdbb, record_param* rpb, jrd_tra* transaction
 		ERR_post(Arg::Gds(isc_no_cur_rec));
 	}
 
-	if (!(rpb->rpb_runtime_flags & RPB_undo_data))
+	if (!(rpb->rpb_runtime_flags & RPB_DATA_FLAGS))
 	{
 		if (rpb->rpb_stream_flags & RPB_s_no_data)
 		{
@@ -4073,7 +4201,10 @@ bool VIO_refetch_record(thread_db* tdbb, record_param* rpb, jrd_tra* transaction
 	// make sure the record has not been updated.  Also, punt after
 	// VIO_data() call which will release the page.
 
-	if (!writelock &&
+	// Zero transaction number means the record was not read from the data page
+	// but restored from the index key by an index-only scan, see IndexTableScan
+
+	if (!writelock && tid_fetch &&
 		(transaction->tra_flags & TRA_read_committed) &&
 		(tid_fetch != rpb->rpb_transaction_nr) &&
 		// added to check that it was not current transaction,
@@ -4838,7 +4969,7 @@ bool VIO_sweep(thread_db* tdbb, jrd_tra* transaction, TraceSweepEvent* traceSwee
 	record_param rpb;
 	rpb.rpb_record = NULL;
 	rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
-	rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+	rpb.getWindow(tdbb).win_flags = WIN_large_scan | WIN_read_ahead;
 
 	GarbageCollector* gc = dbb->dbb_garbage_collector;
 	bool ret = true;
@@ -5161,6 +5292,39 @@ static void check_rel_field_class(thread_db* tdbb,
 	RelationPermanent::newVersion(tdbb, object_name);
 }
 
+static void cache_version(thread_db* tdbb, record_param* rpb, MemoryPool* pool, TraNumber head)
+{
+/**************************************
+ *
+ *	c a c h e _ v e r s i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Fetch the latest committed version of the record found by
+ *	VIO_chase_record_version and store it in the version cache
+ *	of the relation.  Newer versions belong to the head transaction.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+
+	VIO_data(tdbb, rpb, pool);
+	rpb->rpb_runtime_flags |= RPB_cached_data;
+
+	const CommitNumber commit = dbb->dbb_tip_cache->snapshotState(tdbb, rpb->rpb_transaction_nr);
+
+	if (commit < CN_PREHISTORIC || commit > CN_MAX_NUMBER)
+		return;
+
+	const Record* const record = rpb->rpb_record;
+
+	getPermanent(rpb->rpb_relation)->rel_version_cache.put(rpb->rpb_number.getValue(), head,
+		rpb->rpb_transaction_nr, commit, record->getFormat()->fmt_version,
+		record->getLength(), record->getData());
+}
+
+
 static void check_class(thread_db* tdbb,
 						jrd_tra* transaction,
 						record_param* org_rpb,
@@ -5360,6 +5524,7 @@ static void delete_record(thread_db* tdbb, record_param* rpb, ULONG prior_page,
 	const UCHAR* tail_end = nullptr;
 
 	Difference difference;
+	BlockPackedImage packed(*tdbb->getDefaultPool());
 
 	Record* record = nullptr;
 	const Record* prior = nullptr;
@@ -5383,6 +5548,7 @@ static void delete_record(thread_db* tdbb, record_param* rpb, ULONG prior_page,
 			tail_end = tail + record->getLength();
 		}
 
+		packed.prepare(rpb, tail, tail_end);
 		tail = unpack(rpb, tail_end - tail, tail);
 		rpb->rpb_prior = (rpb->rpb_flags & rpb_delta) ? record : nullptr;
 	}
@@ -5390,6 +5556,7 @@ static void delete_record(thread_db* tdbb, record_param* rpb, ULONG prior_page,
 	record_param temp_rpb = *rpb;
 	DPM_delete(tdbb, &temp_rpb, prior_page);
 	tail = delete_tail(tdbb, &temp_rpb, temp_rpb.rpb_page, tail, tail_end);
+	tail = packed.unpack(tail, tail_end);
 
 	if (pool && prior)
 	{
@@ -5563,6 +5730,7 @@ static void expunge(thread_db* tdbb, record_param* rpb, const jrd_tra* transacti
 		return;
 	}
 
+	GarbageCollectGuard gcGuard(rpb->rpb_relation);
 	delete_record(tdbb, rpb, prior_page, NULL);
 
 	// If there aren't any old versions, don't worry about garbage collection.
@@ -5648,6 +5816,10 @@ static void garbage_collect(thread_db* tdbb, record_param* rpb, ULONG prior_page
 	IDX_garbage_collect(tdbb, rpb, going, staying);
 	BLB_garbage_collect(tdbb, going, staying, prior_page, rpb->rpb_relation);
 
+	// Sweep could mark the page as "all visible" before the stale index keys were removed
+	if (going.hasData())
+		DPM_reset_all_visible(tdbb, rpb);
+
 	clearRecordStack(going);
 }
 
@@ -5696,6 +5868,376 @@ void VIO_garbage_collect_idx(thread_db* tdbb, jrd_tra* transaction,
 	clearRecordStack(staying);
 }
 
+static ULONG garbage_collect_pages(thread_db* tdbb, GarbageCollector* gc, USHORT relID,
+	PageBitmap* gc_bitmap, record_param& rpb, jrd_tra*& transaction)
+{
+/**************************************
+ *
+ *	g a r b a g e _ c o l l e c t _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Garbage collect the data pages of a relation
+ *	taken from the garbage collector. Return the
+ *	number of data pages processed.
+ *
+ **************************************/
+	Database* const dbb = tdbb->getDatabase();
+	Jrd::Attachment* const attachment = tdbb->getAttachment();
+
+	AutoPtr<PageBitmap> bitmap(gc_bitmap);
+	ULONG processed = 0;
+
+	Cleanup releasePages([&] {
+		gc->releasePages(relID, processed);
+	});
+
+	// Express interest in the relation to prevent it from being deleted
+	// out from under us while garbage collection is in-progress.
+
+	jrd_rel* const relation = MetadataCache::getVersioned<Cached::Relation>(tdbb, relID, CacheFlag::AUTOCREATE);
+	if (!relation || getPermanent(relation)->isDropped())
+	{
+		gc->removeRelation(relID);
+		return 0;
+	}
+
+	GCLock::Shared gcGuard(tdbb, getPermanent(relation));
+	if (!gcGuard.gcEnabled())
+		return 0;
+
+	rpb.rpb_relation = relation;
+
+	while (bitmap->getFirst())
+	{
+		const ULONG dp_sequence = bitmap->current();
+
+		if (!(dbb->dbb_flags & DBB_garbage_collector))
+			break;
+
+		bitmap->clear(dp_sequence);
+
+		if (!transaction)
+		{
+			// Start a "precommitted" transaction by using read-only,
+			// read committed. Of particular note is the absence of a
+			// transaction lock which means the transaction does not
+			// inhibit garbage collection by its very existence.
+
+			transaction = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
+			tdbb->setTransaction(transaction);
+		}
+
+		processed++;
+		rpb.rpb_number.setValue(((SINT64) dp_sequence * dbb->dbb_max_records) - 1);
+		const RecordNumber last(rpb.rpb_number.getValue() + dbb->dbb_max_records);
+
+		// Attempt to garbage collect all records on the data page.
+
+		bool rel_exit = false;
+
+		while (VIO_next_record(tdbb, &rpb, transaction, NULL, DPM_next_data_page))
+		{
+			CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
+
+			if (!(dbb->dbb_flags & DBB_garbage_collector))
+				break;
+
+			if (getPermanent(relation)->isDropped())
+			{
+				rel_exit = true;
+				break;
+			}
+
+			if (getPermanent(relation)->rel_gc_lock.checkDisabled())
+			{
+				rel_exit = true;
+				break;
+			}
+
+			JRD_reschedule(tdbb);
+
+			if (rpb.rpb_number >= last)
+				break;
+
+			// Refresh our notion of the oldest transactions for
+			// efficient garbage collection. This is very cheap.
+
+			transaction->tra_oldest = dbb->dbb_oldest_transaction;
+			transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
+		}
+
+		if (TipCache* cache = dbb->dbb_tip_cache)
+			cache->updateActiveSnapshots(tdbb, &attachment->att_active_snapshots);
+
+		if (rel_exit)
+			break;
+	}
+
+	return processed;
+}
+
+
+namespace Jrd
+{
+
+// Garbage collection by several workers. Every worker takes the most
+// urgent relation not handled by others and cleans up its pages. The
+// first worker uses the attachment of the garbage collector thread,
+// others use worker attachments marked as the garbage collector ones.
+
+class GCTask : public Task
+{
+public:
+	GCTask(thread_db* tdbb, MemoryPool& pool, GarbageCollector* gc, int workers)
+		: m_dbb(tdbb->getDatabase()),
+		  m_gc(gc),
+		  m_items(pool),
+		  m_processed(0),
+		  m_found(false),
+		  m_stop(false)
+	{
+		for (int i = 0; i < workers; i++)
+			m_items.add(FB_NEW_POOL(pool) Item(this));
+
+		m_items[0]->m_ownAttach = false;
+		m_items[0]->m_attStable = tdbb->getAttachment()->getStable();
+		m_items[0]->m_tra = tdbb->getTransaction();
+	}
+
+	~GCTask()
+	{
+		for (auto item : m_items)
+			delete item;
+	}
+
+	class Item : public Task::WorkItem
+	{
+	public:
+		explicit Item(GCTask* task)
+			: Task::WorkItem(task),
+			  m_inuse(false),
+			  m_ownAttach(true),
+			  m_tra(NULL),
+			  m_attFlags(0)
+		{}
+
+		~Item()
+		{
+			if (!m_ownAttach || !m_attStable)
+				return;
+
+			Attachment* att = NULL;
+			{
+				AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+				att = m_attStable->getHandle();
+				if (!att)
+					return;
+				fb_assert(att->att_use_count > 0);
+			}
+
+			FbLocalStatus status;
+			if (m_tra)
+			{
+				BackgroundContextHolder tdbb(att->att_database, att, &status, FB_FUNCTION);
+				TRA_commit(tdbb, m_tra, false);
+			}
+
+			// The worker attachment is going to be used by other tasks
+			att->att_flags &= ~(ATT_notify_gc | ATT_garbage_collector);
+			att->att_flags |= m_attFlags;
+
+			WorkerAttachment::releaseAttachment(&status, m_attStable);
+		}
+
+		GCTask* getTask() const
+		{
+			return static_cast<GCTask*>(m_task);
+		}
+
+		bool init(thread_db* tdbb)
+		{
+			FbStatusVector* const status = tdbb->tdbb_status_vector;
+
+			if (m_ownAttach && !m_attStable)
+			{
+				m_attStable = WorkerAttachment::getAttachment(status, getTask()->m_dbb);
+
+				if (m_attStable && m_attStable->getHandle())
+				{
+					Attachment* const att = m_attStable->getHandle();
+					m_attFlags = att->att_flags & (ATT_notify_gc | ATT_garbage_collector);
+					att->att_flags &= ~ATT_notify_gc;
+					att->att_flags |= ATT_garbage_collector;
+				}
+			}
+
+			Attachment* const att = m_attStable ? m_attStable->getHandle() : NULL;
+
+			if (!att)
+				return false;
+
+			tdbb->setDatabase(att->att_database);
+			tdbb->setAttachment(att);
+			tdbb->markAsSweeper();
+
+			if (m_ownAttach && !m_tra)
+			{
+				try
+				{
+					WorkerContextHolder holder(tdbb, FB_FUNCTION);
+					m_tra = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
+				}
+				catch (const Exception& ex)
+				{
+					ex.stuffException(tdbb->tdbb_status_vector);
+					return false;
+				}
+			}
+
+			tdbb->setTransaction(m_tra);
+			return true;
+		}
+
+		bool m_inuse;
+		bool m_ownAttach;
+		RefPtr<StableAttachmentPart> m_attStable;
+		jrd_tra* m_tra;
+		ULONG m_attFlags;
+	};
+
+	bool handler(WorkItem& _item) override;
+	bool getWorkItem(WorkItem** pItem) override;
+
+	bool getResult(IStatus* status) override
+	{
+		if (status)
+		{
+			status->init();
+			status->setErrors(m_status.getErrors());
+		}
+
+		return m_status.isSuccess();
+	}
+
+	int getMaxWorkers() override
+	{
+		return m_items.getCount();
+	}
+
+	bool isFound() const
+	{
+		return m_found;
+	}
+
+	FB_UINT64 getProcessed() const
+	{
+		return m_processed;
+	}
+
+private:
+	void setError(FbStatusVector* status)
+	{
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_status.isSuccess())
+			m_status.save(status);
+
+		m_stop = true;
+	}
+
+	Database* const m_dbb;
+	GarbageCollector* const m_gc;
+
+	Mutex m_mutex;
+	HalfStaticArray<Item*, 8> m_items;
+	StatusHolder m_status;
+	std::atomic<FB_UINT64> m_processed;
+	volatile bool m_found;
+	volatile bool m_stop;
+};
+
+
+bool GCTask::handler(WorkItem& _item)
+{
+	Item* const item = static_cast<Item*>(&_item);
+
+	ThreadContextHolder tdbb(NULL);
+
+	// Worker attachment could be unavailable, the work is done by others then
+	if (!item->init(tdbb))
+	{
+		if (!item->m_ownAttach)
+			setError(tdbb->tdbb_status_vector);
+
+		return false;
+	}
+
+	WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+	record_param rpb;
+	rpb.rpb_record = NULL;
+	rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
+	rpb.getWindow(tdbb).win_flags = WIN_garbage_collector;
+
+	try
+	{
+		USHORT relID;
+		PageBitmap* const gc_bitmap = m_gc->getPages(m_dbb->dbb_oldest_snapshot, relID);
+
+		if (!gc_bitmap)
+			return false;
+
+		m_found = true;
+		m_processed += garbage_collect_pages(tdbb, m_gc, relID, gc_bitmap, rpb, item->m_tra);
+
+		delete rpb.rpb_record;
+		return !m_stop && (m_dbb->dbb_flags & DBB_garbage_collector);
+	}
+	catch (const Exception& ex)
+	{
+		ex.stuffException(tdbb->tdbb_status_vector);
+		delete rpb.rpb_record;
+	}
+
+	setError(tdbb->tdbb_status_vector);
+	return false;
+}
+
+bool GCTask::getWorkItem(WorkItem** pItem)
+{
+	Item* item = static_cast<Item*>(*pItem);
+
+	MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+	if (m_stop || !(m_dbb->dbb_flags & DBB_garbage_collector))
+	{
+		if (item)
+			item->m_inuse = false;
+
+		return false;
+	}
+
+	if (!item)
+	{
+		for (auto iter : m_items)
+		{
+			if (!iter->m_inuse)
+			{
+				iter->m_inuse = true;
+				*pItem = item = iter;
+				break;
+			}
+		}
+	}
+
+	return (item != NULL);
+}
+
+} // namespace Jrd
+
+
 void Database::garbage_collector(Database* dbb)
 {
 /**************************************
@@ -5710,6 +6252,8 @@ void Database::garbage_collector(Database* dbb)
  *	hope is that offloading the computation
  *	and I/O burden of garbage collection will
  *	improve query response time and throughput.
+ *	If configured, relations are handled by
+ *	several parallel workers.
  *
  **************************************/
 	FbLocalStatus status_vector;
@@ -5730,13 +6274,16 @@ void Database::garbage_collector(Database* dbb)
 		Jrd::Attachment::UseCountHolder use(attachment);
 		tdbb->markAsSweeper();
 
-		jrd_rel* relation;
 		record_param rpb;
 		rpb.getWindow(tdbb).win_flags = WIN_garbage_collector;
 		rpb.rpb_stream_flags = RPB_s_no_data | RPB_s_sweeper;
 
 		jrd_tra* transaction = NULL;
 
+		// Worker threads are kept between the passes
+		const int workers = dbb->dbb_config->getGCParallelWorkers();
+		Coordinator coord(dbb->dbb_permanent);
+
 		AutoPtr<GarbageCollector> gc(FB_NEW_POOL(*attachment->att_pool) GarbageCollector(
 			*attachment->att_pool, dbb));
 
@@ -5780,116 +6327,54 @@ void Database::garbage_collector(Database* dbb)
 				}
 
 				// Scan relation garbage collection bitmaps for candidate data pages.
-				// Express interest in the relation to prevent it from being deleted
-				// out from under us while garbage collection is in-progress.
-
-				bool found = false, gc_exit = false;
+				// Relations with more garbage pending and met more often by readers
+				// are taken first. Several workers handle different relations at once.
 
-				USHORT relID;
-				PageBitmap* gc_bitmap = NULL;
+				bool found = false;
 
-				if ((dbb->dbb_flags & DBB_gc_pending) &&
-					(gc_bitmap = gc->getPages(dbb->dbb_oldest_snapshot, relID)))
+				if (dbb->dbb_flags & DBB_gc_pending)
 				{
-					relation = MetadataCache::getVersioned<Cached::Relation>(tdbb, relID, CacheFlag::AUTOCREATE);
-					if (!relation || getPermanent(relation)->isDropped())
+					if (workers > 1)
 					{
-						delete gc_bitmap;
-						gc_bitmap = NULL;
-						gc->removeRelation(relID);
-					}
-
-					if (gc_bitmap)
-					{
-						GCLock::Shared gcGuard(tdbb, getPermanent(relation));
-						if (!gcGuard.gcEnabled())
-							continue;
-
-						rpb.rpb_relation = relation;
-
-						while (gc_bitmap->getFirst())
+						if (!transaction)
 						{
-							const ULONG dp_sequence = gc_bitmap->current();
-
-							if (!(dbb->dbb_flags & DBB_garbage_collector))
-							{
-								gc_exit = true;
-								break;
-							}
-
-							if (gc_exit)
-								break;
-
-							gc_bitmap->clear(dp_sequence);
-
-							if (!transaction)
-							{
-								// Start a "precommitted" transaction by using read-only,
-								// read committed. Of particular note is the absence of a
-								// transaction lock which means the transaction does not
-								// inhibit garbage collection by its very existence.
-
-								transaction = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
-								tdbb->setTransaction(transaction);
-							}
-
-							found = flush = true;
-							rpb.rpb_number.setValue(((SINT64) dp_sequence * dbb->dbb_max_records) - 1);
-							const RecordNumber last(rpb.rpb_number.getValue() + dbb->dbb_max_records);
-
-							// Attempt to garbage collect all records on the data page.
-
-							bool rel_exit = false;
-
-							while (VIO_next_record(tdbb, &rpb, transaction, NULL, DPM_next_data_page))
-							{
-								CCH_RELEASE(tdbb, &rpb.getWindow(tdbb));
-
-								if (!(dbb->dbb_flags & DBB_garbage_collector))
-								{
-									gc_exit = true;
-									break;
-								}
-
-								if (getPermanent(relation)->isDropped())
-								{
-									rel_exit = true;
-									break;
-								}
-
-								if (getPermanent(relation)->rel_gc_lock.checkDisabled())
-								{
-									rel_exit = true;
-									break;
-								}
-
-								JRD_reschedule(tdbb);
+							// See garbage_collect_pages() for the transaction parameters
+							transaction = TRA_start(tdbb, sizeof(gc_tpb), gc_tpb);
+							tdbb->setTransaction(transaction);
+						}
 
-								if (rpb.rpb_number >= last)
-									break;
+						GCTask task(tdbb, *attachment->att_pool, gc, workers);
 
-								// Refresh our notion of the oldest transactions for
-								// efficient garbage collection. This is very cheap.
+						{	// scope
+							EngineCheckout cout(tdbb, FB_FUNCTION);
+							coord.runSync(&task);
+						}
 
-								transaction->tra_oldest = dbb->dbb_oldest_transaction;
-								transaction->tra_oldest_active = dbb->dbb_oldest_snapshot;
-							}
+						FbLocalStatus local_status;
+						if (!task.getResult(&local_status))
+							local_status.raise();
 
-							if (TipCache* cache = dbb->dbb_tip_cache)
-								cache->updateActiveSnapshots(tdbb, &attachment->att_active_snapshots);
+						found = task.isFound();
+						if (task.getProcessed())
+							flush = true;
+					}
+					else
+					{
+						USHORT relID;
+						PageBitmap* const gc_bitmap = gc->getPages(dbb->dbb_oldest_snapshot, relID);
 
-							if (gc_exit || rel_exit)
-								break;
+						if (gc_bitmap)
+						{
+							found = true;
+							if (garbage_collect_pages(tdbb, gc, relID, gc_bitmap, rpb, transaction))
+								flush = true;
 						}
-
-						if (gc_exit)
-							break;
-
-						delete gc_bitmap;
-						gc_bitmap = NULL;
 					}
 				}
 
+				if (!(dbb->dbb_flags & DBB_garbage_collector))
+					break;
+
 				// If there's more work to do voluntarily ask to be rescheduled.
 				// Otherwise, wait for event notification.
 
@@ -6057,6 +6542,102 @@ static void gbak_put_search_system_schema_flag(thread_db* tdbb, record_param* rp
 }
 
 
+static CommitNumber get_cache_snapshot(thread_db* tdbb, const jrd_tra* transaction,
+	const record_param* rpb, const MemoryPool* pool, bool writelock)
+{
+/**************************************
+ *
+ *	g e t _ c a c h e _ s n a p s h o t
+ *
+ **************************************
+ *
+ * Functional description
+ *	Return the statement level snapshot number if the version
+ *	cache could be used to read the record, CN_ACTIVE otherwise.
+ *	Only plain reads of the READ CONSISTENCY transactions use it.
+ *
+ **************************************/
+	if (!pool || writelock || (tdbb->tdbb_flags & TDBB_sweeper) ||
+		(rpb->rpb_stream_flags & (RPB_s_update | RPB_s_no_data | RPB_s_sweeper)) ||
+		(rpb->rpb_flags & rpb_damaged) || rpb->rpb_relation->isTemporary() ||
+		!tdbb->getDatabase()->dbb_tip_cache)
+	{
+		return CN_ACTIVE;
+	}
+
+	if ((transaction->tra_flags & (TRA_read_committed | TRA_read_consistency | TRA_system)) !=
+		(TRA_read_committed | TRA_read_consistency))
+	{
+		return CN_ACTIVE;
+	}
+
+	const Request* const request = tdbb->getRequest();
+	const Request* const snapshot_request = request ? request->req_snapshot.m_owner : nullptr;
+
+	if (!snapshot_request || (snapshot_request->req_flags & req_update_conflict))
+		return CN_ACTIVE;
+
+	return snapshot_request->req_snapshot.m_number;
+}
+
+
+static bool get_cached_version(thread_db* tdbb, record_param* rpb, MemoryPool* pool,
+	CommitNumber snapshot)
+{
+/**************************************
+ *
+ *	g e t _ c a c h e d _ v e r s i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	The primary version of the record is invisible for the statement
+ *	snapshot.  If the latest committed version is cached and is visible,
+ *	take it instead of walking the chain of back versions.  The data page
+ *	is released then, as for data restored from the undo log.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	HalfStaticArray<UCHAR, 1024> data;
+	USHORT format_number = 0;
+	TraNumber version = 0;
+
+	const auto copier = [&](USHORT format, TraNumber transaction, ULONG length, const UCHAR* buffer)
+	{
+		format_number = format;
+		version = transaction;
+		data.assign(buffer, length);
+	};
+
+	if (!getPermanent(rpb->rpb_relation)->rel_version_cache.get(rpb->rpb_number.getValue(),
+			rpb->rpb_transaction_nr, snapshot, copier))
+	{
+		return false;
+	}
+
+	const Format* const format = getPermanent(rpb->rpb_relation)->getFormat(tdbb, format_number);
+
+	if (!format || format->fmt_length != data.getCount())
+		return false;
+
+	CCH_RELEASE(tdbb, &rpb->getWindow(tdbb));
+
+	Record* const record = VIO_record(tdbb, rpb, format, pool);
+	record->copyDataFrom(data.begin());
+	record->setTransactionNumber(version);
+
+	rpb->rpb_runtime_flags |= RPB_cached_data;
+	rpb->rpb_flags &= ~rpb_deleted;
+	rpb->rpb_transaction_nr = version;
+	rpb->rpb_format_number = format_number;
+	rpb->rpb_address = record->getData();
+	rpb->rpb_length = record->getLength();
+
+	return true;
+}
+
+
 static UndoDataRet get_undo_data(thread_db* tdbb, jrd_tra* transaction,
 								 record_param* rpb, MemoryPool* pool)
 /**********************************************************
@@ -6201,8 +6782,8 @@ static void list_staying_fast(thread_db* tdbb, record_param* rpb, RecordStack& s
 	fb_assert(temp.rpb_b_page == rpb->rpb_b_page);
 	fb_assert(temp.rpb_b_line == rpb->rpb_b_line);
 
-	fb_assert((temp.rpb_flags & ~(rpb_incomplete | rpb_not_packed)) ==
-			  (rpb->rpb_flags & ~(rpb_incomplete | rpb_not_packed)));
+	fb_assert((temp.rpb_flags & ~(rpb_incomplete | rpb_not_packed | rpb_block_packed)) ==
+			  (rpb->rpb_flags & ~(rpb_incomplete | rpb_not_packed | rpb_block_packed)));
 
 	Record* backout_rec = NULL;
 	RuntimeStatistics::Accumulator backversions(tdbb, rpb->rpb_relation, RecordStatType::BACK_READS);
@@ -6507,6 +7088,9 @@ static void notify_garbage_collector(thread_db* tdbb, record_param* rpb, TraNumb
 	if (relation->isTemporary())
 		return;
 
+	// Record versions met by readers make the relation more urgent to clean up
+	const bool read = (tranid == MAX_TRA_NUMBER) && !(tdbb->tdbb_flags & TDBB_sweeper);
+
 	if (tranid == MAX_TRA_NUMBER)
 		tranid = rpb->rpb_transaction_nr;
 
@@ -6527,7 +7111,7 @@ static void notify_garbage_collector(thread_db* tdbb, record_param* rpb, TraNumb
 
 	const ULONG dp_sequence = rpb->rpb_number.getValue() / dbb->dbb_max_records;
 
-	const TraNumber minTranId = gc->addPage(relation->getId(), dp_sequence, tranid);
+	const TraNumber minTranId = gc->addPage(relation->getId(), dp_sequence, tranid, read);
 	if (tranid > minTranId)
 		tranid = minTranId;
 
@@ -7042,6 +7626,8 @@ static void purge(thread_db* tdbb, record_param* rpb)
 		return; // true;
 	}
 
+	GarbageCollectGuard gcGuard(relation);
+
 	rpb->rpb_b_page = 0;
 	rpb->rpb_b_line = 0;
 	rpb->rpb_flags &= ~(rpb_delta | rpb_gc_active);
@@ -7433,6 +8019,11 @@ void VIO_update_in_place(thread_db* tdbb,
 		stack->push(PageNumber(pageSpaceID, temp2.rpb_page));
 	}
 
+	// System transaction replaces the record version which index keys are collected below
+	std::optional<GarbageCollectGuard> gcGuard;
+	if (transaction->tra_flags & TRA_system)
+		gcGuard.emplace(relation);
+
 	if (!DPM_get(tdbb, org_rpb, LCK_write))
 		BUGCHECK(186);	// msg 186 record disappeared
 
@@ -7478,6 +8069,7 @@ void VIO_update_in_place(thread_db* tdbb,
 
 		IDX_garbage_collect(tdbb, org_rpb, going, staying);
 		BLB_garbage_collect(tdbb, going, staying, org_rpb->rpb_page, relation);
+		DPM_reset_all_visible(tdbb, org_rpb);
 
 		staying.pop();
 		clearRecordStack(staying);
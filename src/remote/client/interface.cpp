@@ -206,6 +206,8 @@ public:
 	int seek(CheckStatusWrapper* status, int mode, int offset) override;			// returns position
 	void deprecatedCancel(CheckStatusWrapper* status) override;
 	void deprecatedClose(CheckStatusWrapper* status) override;
+	int getData(CheckStatusWrapper* status, unsigned int bufferLength,
+		void* buffer, unsigned int* dataLength) override;
 
 public:
 	explicit Blob(Rbl* handle)
@@ -5797,6 +5799,100 @@ int Blob::getSegment(CheckStatusWrapper* status, unsigned int bufferLength, void
 }
 
 
+int Blob::getData(CheckStatusWrapper* status, unsigned int bufferLength, void* buffer,
+	unsigned int* dataLength)
+{
+/**************************************
+ *
+ *	B l o b : : g e t D a t a
+ *
+ **************************************
+ *
+ * Functional description
+ *	Fill the buffer with blob data regardless of segments.
+ *	Server sends the data without segment lengths, every
+ *	round trip transfers up to MAX_BLOB_DATA_LENGTH bytes.
+ *
+ **************************************/
+
+	try
+	{
+		reset(status);
+
+		UCHAR* const bufferPtr = static_cast<UCHAR*>(buffer);
+
+		CHECK_HANDLE(blob, isc_bad_segstr_handle);
+
+		Rdb* rdb = blob->rbl_rdb;
+		CHECK_HANDLE(rdb, isc_bad_db_handle);
+		rem_port* port = rdb->rdb_port;
+
+		ULONG length = 0;
+
+		if (port->port_protocol < PROTOCOL_BLOB_DATA || blob->isCached() ||
+			blob->rbl_length || blob->rbl_fragment_length || (blob->rbl_flags & Rbl::CREATE))
+		{
+			// Older server, or the data is already here: collect it segment by segment
+
+			while (length < bufferLength)
+			{
+				unsigned int segmentLength = 0;
+				const int cc = getSegment(status, bufferLength - length, bufferPtr + length,
+					&segmentLength);
+
+				if (cc == IStatus::RESULT_ERROR)
+					return cc;
+
+				length += segmentLength;
+
+				if (cc == IStatus::RESULT_NO_DATA)
+					break;
+			}
+		}
+		else
+		{
+			RefMutexGuard portGuard(*port->port_sync, FB_FUNCTION);
+
+			PACKET* packet = &rdb->rdb_packet;
+			P_BDATA* data = &packet->p_bdata;
+			P_RESP* response = &packet->p_resp;
+
+			while (length < bufferLength && !(blob->rbl_flags & Rbl::EOF_SET))
+			{
+				packet->p_operation = op_get_blob_data;
+				data->p_bdata_blob = blob->rbl_id;
+				data->p_bdata_length = bufferLength - length;
+				send_packet(port, packet);
+
+				// Data goes directly to the user buffer
+
+				UsePreallocatedBuffer temp(response->p_resp_data, bufferLength - length, bufferPtr + length);
+				receive_response(status, rdb, packet);
+
+				const ULONG received = response->p_resp_data.cstr_length;
+				length += received;
+
+				if (response->p_resp_object == 2 || !received)
+					blob->rbl_flags |= Rbl::EOF_SET;
+			}
+
+			blob->rbl_offset += length;
+		}
+
+		if (dataLength)
+			*dataLength = length;
+
+		return (length || !bufferLength) ? IStatus::RESULT_OK : IStatus::RESULT_NO_DATA;
+	}
+	catch (const Exception& ex)
+	{
+		ex.stuffException(status);
+	}
+
+	return IStatus::RESULT_ERROR;
+}
+
+
 int Attachment::getSlice(CheckStatusWrapper* status, ITransaction* apiTra, ISC_QUAD* array_id,
 						  unsigned int sdl_length, const unsigned char* sdl,
 						  unsigned int param_length, const unsigned char* param,
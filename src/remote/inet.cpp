@@ -718,7 +718,8 @@ rem_port* INET_analyze(ClntAuthBlock* cBlock,
 		REMOTE_PROTOCOL(PROTOCOL_VERSION17, ptype_lazy_send, 8),
 		REMOTE_PROTOCOL(PROTOCOL_VERSION18, ptype_lazy_send, 9),
 		REMOTE_PROTOCOL(PROTOCOL_VERSION19, ptype_lazy_send, 10),
-		REMOTE_PROTOCOL(PROTOCOL_VERSION20, ptype_lazy_send, 11)
+		REMOTE_PROTOCOL(PROTOCOL_VERSION20, ptype_lazy_send, 11),
+		REMOTE_PROTOCOL(PROTOCOL_VERSION21, ptype_lazy_send, 12)
 	};
 	static_assert(FB_NELEM(protocols_to_try) <= MAX_CNCT_VERSIONS);
 
@@ -494,6 +494,15 @@ bool_t xdr_protocol(RemoteXdr* xdrs, PACKET* p)
 		DEBUG_PRINTSIZE(xdrs, p->p_operation);
 		return P_TRUE(xdrs, p);
 
+	case op_get_blob_data:
+		{
+			P_BDATA* data = &p->p_bdata;
+			MAP(xdr_short, reinterpret_cast<SSHORT&>(data->p_bdata_blob));
+			MAP(xdr_u_long, data->p_bdata_length);
+			DEBUG_PRINTSIZE(xdrs, p->p_operation);
+			return P_TRUE(xdrs, p);
+		}
+
 	case op_reconnect:
 	case op_transaction:
 		transaction = &p->p_sttr;
@@ -119,6 +119,12 @@ inline constexpr USHORT PROTOCOL_INLINE_BLOB = PROTOCOL_VERSION19;
 inline constexpr USHORT PROTOCOL_VERSION20 = (FB_PROTOCOL_FLAG | 20);
 inline constexpr USHORT PROTOCOL_PREPARE_FLAG = PROTOCOL_VERSION20;
 
+// Protocol 21:
+//	- supports op_get_blob_data
+
+inline constexpr USHORT PROTOCOL_VERSION21 = (FB_PROTOCOL_FLAG | 21);
+inline constexpr USHORT PROTOCOL_BLOB_DATA = PROTOCOL_VERSION21;
+
 // Architecture types
 
 enum P_ARCH
@@ -337,6 +343,8 @@ enum P_OP
 
 	op_inline_blob			= 114,
 
+	op_get_blob_data		= 115,	// Get blob data regardless of segments
+
 	op_max
 };
 
@@ -387,8 +395,9 @@ typedef struct p_malloc
 
 // Connect Block (Client to server)
 
-// Servers before FB6 (PROTOCOL_VERSION20) uses only first 10 elements of p_cnct_versions
-inline constexpr size_t MAX_CNCT_VERSIONS = 11;
+// Servers before FB6 (PROTOCOL_VERSION20) uses only first 10 elements of p_cnct_versions,
+// servers before PROTOCOL_VERSION21 - only first 11 elements
+inline constexpr size_t MAX_CNCT_VERSIONS = 12;
 
 typedef struct p_cnct
 {
@@ -550,6 +559,12 @@ typedef struct p_seek
     SLONG	p_seek_offset;		// Offset of seek
 } P_SEEK;
 
+typedef struct p_bdata
+{
+    OBJCT	p_bdata_blob;		// Blob handle id
+    ULONG	p_bdata_length;		// Max length of data to return
+} P_BDATA;
+
 // Information request blocks
 
 typedef struct p_info
@@ -820,6 +835,7 @@ typedef struct packet
     P_SLC	p_slc;				// Slice operator
     P_SLR	p_slr;				// Slice response
     P_SEEK	p_seek;				// Blob seek
+    P_BDATA	p_bdata;			// Get blob data
     P_SQLST	p_sqlst;			// DSQL Prepare & Execute immediate
     P_SQLDATA	p_sqldata;		// DSQL Open Cursor, Execute, Fetch
     P_SQLCUR	p_sqlcur;		// DSQL Set cursor name
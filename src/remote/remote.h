@@ -90,6 +90,9 @@ DEFINE_TRACE_ROUTINE(remote_trace);
 
 inline constexpr int BLOB_LENGTH = 16384;
 
+// Max length of blob data sent by server in response to the single op_get_blob_data
+inline constexpr ULONG MAX_BLOB_DATA_LENGTH = 4 * 1024 * 1024;
+
 #include "../remote/protocol.h"
 #include "fb_blk.h"
 
@@ -1716,6 +1719,7 @@ public:
 	ISC_STATUS	execute_immediate(P_OP, P_SQLST*, PACKET*);
 	ISC_STATUS	execute_statement(P_OP, P_SQLDATA*, PACKET*);
 	ISC_STATUS	fetch(P_SQLDATA*, PACKET*, bool);
+	ISC_STATUS	get_blob_data(P_BDATA*, PACKET*);
 	ISC_STATUS	get_segment(P_SGMT*, PACKET*);
 	ISC_STATUS	get_slice(P_SLC*, PACKET*);
 	void		info(P_OP, P_INFO*, PACKET*);
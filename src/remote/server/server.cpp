@@ -2019,7 +2019,7 @@ static bool accept_connection(rem_port* port, P_CNCT* connect, PACKET* send)
 	{
 		if ((protocol->p_cnct_version == PROTOCOL_VERSION10 ||
 			 (protocol->p_cnct_version >= PROTOCOL_VERSION11 &&
-			  protocol->p_cnct_version <= PROTOCOL_VERSION20)) &&
+			  protocol->p_cnct_version <= PROTOCOL_VERSION21)) &&
 			 (protocol->p_cnct_architecture == arch_generic ||
 			  protocol->p_cnct_architecture == ARCHITECTURE) &&
 			protocol->p_cnct_weight >= weight)
@@ -4482,6 +4482,57 @@ static bool get_next_msg_no(Rrq* request, USHORT incarnation, USHORT * msg_numbe
 }
 
 
+ISC_STATUS rem_port::get_blob_data(P_BDATA* data, PACKET* sendL)
+{
+/**************************************
+ *
+ *	g e t _ b l o b _ d a t a
+ *
+ **************************************
+ *
+ * Functional description
+ *	Get a portion of blob data regardless of segments.
+ *	Data goes to the client as is, without segment
+ *	lengths, client asks for the rest if needed.
+ *
+ **************************************/
+	Rbl* blob;
+
+	getHandle(blob, data->p_bdata_blob);
+
+	const ULONG length = MIN(data->p_bdata_length, MAX_BLOB_DATA_LENGTH);
+
+	HalfStaticArray<UCHAR, BLOB_LENGTH> buffer;
+	UCHAR* const start = buffer.getBuffer(length);
+
+	LocalStatus ls;
+	CheckStatusWrapper status_vector(&ls);
+
+	UCHAR* p = start;
+	ULONG remaining = length;
+	int state = 0;
+
+	while (remaining)
+	{
+		unsigned dataLength = 0;
+		const int cc = blob->rbl_iface->getData(&status_vector, remaining, p, &dataLength);
+
+		if (cc == IStatus::RESULT_NO_DATA)
+			state = 2;
+
+		if (cc != IStatus::RESULT_OK || !dataLength)
+			break;
+
+		p += dataLength;
+		remaining -= dataLength;
+	}
+
+	sendL->p_resp.p_resp_data.cstr_address = start;
+
+	return this->send_response(sendL, (OBJCT) state, (ULONG) (p - start), &status_vector, false);
+}
+
+
 ISC_STATUS rem_port::get_segment(P_SGMT* segment, PACKET* sendL)
 {
 /**************************************
@@ -5210,6 +5261,10 @@ static bool process_packet(rem_port* port, PACKET* sendL, PACKET* receive, rem_p
 			port->get_segment(&receive->p_sgmt, sendL);
 			break;
 
+		case op_get_blob_data:
+			port->get_blob_data(&receive->p_bdata, sendL);
+			break;
+
 		case op_seek_blob:
 			port->seek_blob(&receive->p_seek, sendL);
 			break;
@@ -4232,6 +4232,22 @@ int YBlob::getSegment(CheckStatusWrapper* status, unsigned int bufferLength,
 	return IStatus::RESULT_ERROR;
 }
 
+int YBlob::getData(CheckStatusWrapper* status, unsigned int bufferLength,
+	void* buffer, unsigned int* dataLength)
+{
+	try
+	{
+		YEntry<YBlob> entry(status, this);
+		return entry.next()->getData(status, bufferLength, buffer, dataLength);
+	}
+	catch (const Exception& e)
+	{
+		e.stuffException(status);
+	}
+
+	return IStatus::RESULT_ERROR;
+}
+
 void YBlob::putSegment(CheckStatusWrapper* status, unsigned int length, const void* buffer)
 {
 	try